@@ -0,0 +1,95 @@
+// allocations.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "allocations.h"
+#include <QTextStream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<long long> counter(0);
+}
+
+#ifdef __GLIBC__
+extern "C"
+{
+void *__libc_calloc(size_t number, size_t size);
+void *__libc_malloc(size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *calloc(size_t number, size_t size)
+{
+    counter++;
+    return __libc_calloc(number, size);
+}
+
+void *malloc(size_t size)
+{
+    counter++;
+    return __libc_malloc(size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    counter++;
+    return __libc_realloc(pointer, size);
+}
+}
+#endif
+
+void *operator new(std::size_t size)
+{
+#ifdef __GLIBC__
+    void *pointer = __libc_malloc(size ? size : 1);
+#else
+    void *pointer = std::malloc(size ? size : 1);
+#endif
+    counter++;
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+long long allocations()
+{
+    return counter;
+}
+
+long long measure(const QString &name, int objects, const std::function<void ()> &function)
+{
+    function();
+    long long start = counter;
+    function();
+    long long count = counter - start;
+
+    QTextStream(stdout) << name << ": " << count << " allocations, "
+                        << objects << " objects\n";
+    return count;
+}
@@ -0,0 +1,17 @@
+// allocations.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <QString>
+#include <functional>
+
+// Heap allocations are counted by global operator new and, with glibc,
+// by malloc, calloc and realloc used by Qt strings and containers
+long long allocations();
+// Allocations of second call of function are printed,
+// first call fills caches. Result: number of allocations.
+long long measure(const QString &name, int objects, const std::function<void ()> &function);
+
+#endif  // ALLOCATIONS_H
@@ -0,0 +1,7 @@
+# allocations.pri
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/allocations.cpp
+
+HEADERS += $$PWD/allocations.h
@@ -0,0 +1,6 @@
+# benchmark.pro
+
+TEMPLATE = subdirs
+
+SUBDIRS = pcballocations \
+    schematicallocations
@@ -0,0 +1,54 @@
+// main.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "allocations.h"
+#include "board.h"
+#include "exceptiondata.h"
+#include <QApplication>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+
+// Allocations of redraw, save and net update of board file
+int main(int argc, char *argv[])
+{
+    constexpr int fontSize = 10;
+    constexpr double scale = 1.;
+
+    QApplication application(argc, argv);
+
+    if (argc < 2) {
+        QTextStream(stderr) << "Usage: pcballocations file.pcb\n";
+        return 1;
+    }
+
+    QFile file(argv[1]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    Board board;
+    try {
+        board.fromJson(file.readAll());
+    }
+    catch (ExceptionData &e) {
+        QTextStream(stderr) << e.show() << "\n";
+        return 1;
+    }
+
+    int objects = board.elements.size() + board.topSegments.size() +
+                  board.bottomSegments.size() + board.vias.size();
+    QImage image(1200, 900, QImage::Format_RGB32);
+    QPainter painter(&image);
+
+    measure("draw", objects, [&]() {
+        painter.resetTransform();
+        board.draw(painter, fontSize, scale);
+    });
+    measure("toJsonData", objects, [&]() { board.toJsonData(); });
+    measure("segmentNets", objects, [&]() { board.segmentNets(); });
+
+    return 0;
+}
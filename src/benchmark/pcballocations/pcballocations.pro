@@ -0,0 +1,76 @@
+# pcballocations.pro
+
+QT += core gui svg
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = pcballocations
+TEMPLATE = app
+
+CONFIG += c++17
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+EDITOR = ../../pcbeditor
+
+include(../../common/common.pri)
+include(../allocations.pri)
+
+INCLUDEPATH += $$EDITOR
+
+SOURCES += main.cpp \
+    $$EDITOR/board.cpp \
+    $$EDITOR/boardjob.cpp \
+    $$EDITOR/boardsnapshot.cpp \
+    $$EDITOR/cluster.cpp \
+    $$EDITOR/copperbalance.cpp \
+    $$EDITOR/element.cpp \
+    $$EDITOR/function.cpp \
+    $$EDITOR/gerber.cpp \
+    $$EDITOR/globaloptions.cpp \
+    $$EDITOR/jumperselector.cpp \
+    $$EDITOR/layers.cpp \
+    $$EDITOR/localoptions.cpp \
+    $$EDITOR/netindex.cpp \
+    $$EDITOR/packageeditor.cpp \
+    $$EDITOR/pcbeditor.cpp \
+    $$EDITOR/pcbtypes.cpp \
+    $$EDITOR/pour.cpp \
+    $$EDITOR/ratsnest.cpp \
+    $$EDITOR/router.cpp \
+    $$EDITOR/routestrategy.cpp \
+    $$EDITOR/shaperouter.cpp \
+    $$EDITOR/text.cpp \
+    $$EDITOR/track.cpp
+
+HEADERS += $$EDITOR/board.h \
+    $$EDITOR/boardjob.h \
+    $$EDITOR/boardsnapshot.h \
+    $$EDITOR/chunkedvector.h \
+    $$EDITOR/cluster.h \
+    $$EDITOR/copperbalance.h \
+    $$EDITOR/element.h \
+    $$EDITOR/function.h \
+    $$EDITOR/gerber.h \
+    $$EDITOR/globaloptions.h \
+    $$EDITOR/jumperselector.h \
+    $$EDITOR/layers.h \
+    $$EDITOR/localoptions.h \
+    $$EDITOR/netindex.h \
+    $$EDITOR/packageeditor.h \
+    $$EDITOR/pcbeditor.h \
+    $$EDITOR/pcbtypes.h \
+    $$EDITOR/pour.h \
+    $$EDITOR/ratsnest.h \
+    $$EDITOR/router.h \
+    $$EDITOR/routestrategy.h \
+    $$EDITOR/shaperouter.h \
+    $$EDITOR/text.h \
+    $$EDITOR/track.h
+
+FORMS += $$EDITOR/globaloptions.ui \
+    $$EDITOR/copperbalance.ui \
+    $$EDITOR/jumperselector.ui \
+    $$EDITOR/localoptions.ui \
+    $$EDITOR/packageeditor.ui \
+    $$EDITOR/pcbeditor.ui
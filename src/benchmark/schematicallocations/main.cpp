@@ -0,0 +1,52 @@
+// main.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "allocations.h"
+#include "exceptiondata.h"
+#include "schematic.h"
+#include <QApplication>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+
+// Allocations of redraw, save and net update of schematic file
+int main(int argc, char *argv[])
+{
+    QApplication application(argc, argv);
+
+    if (argc < 2) {
+        QTextStream(stderr) << "Usage: schematicallocations file.sch\n";
+        return 1;
+    }
+
+    QFile file(argv[1]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    Schematic schematic;
+    try {
+        schematic.fromJson(file.readAll());
+    }
+    catch (ExceptionData &e) {
+        QTextStream(stderr) << e.show() << "\n";
+        return 1;
+    }
+
+    int objects = schematic.arrays.size() + schematic.circuitSymbols.size() +
+                  schematic.devices.size() + schematic.elements.size() +
+                  schematic.junctions.size() + schematic.wires.size();
+    QImage image(windowSizeX, windowSizeY, QImage::Format_RGB32);
+    QPainter painter(&image);
+
+    measure("draw", objects, [&]() {
+        painter.resetTransform();
+        schematic.draw(painter);
+    });
+    measure("toJsonData", objects, [&]() { schematic.toJsonData(); });
+    measure("updateNets", objects, [&]() { schematic.updateNets(); });
+
+    return 0;
+}
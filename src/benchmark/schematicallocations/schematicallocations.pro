@@ -0,0 +1,68 @@
+# schematicallocations.pro
+
+QT += core gui svg
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = schematicallocations
+TEMPLATE = app
+
+CONFIG += c++17
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+EDITOR = ../../schematiceditor
+
+include(../../common/common.pri)
+include(../allocations.pri)
+
+INCLUDEPATH += $$EDITOR
+
+SOURCES += main.cpp \
+    $$EDITOR/array.cpp \
+    $$EDITOR/arrayselector.cpp \
+    $$EDITOR/circuitsymbol.cpp \
+    $$EDITOR/device.cpp \
+    $$EDITOR/deviceselector.cpp \
+    $$EDITOR/diodeselector.cpp \
+    $$EDITOR/element.cpp \
+    $$EDITOR/function.cpp \
+    $$EDITOR/glyphcache.cpp \
+    $$EDITOR/hierarchy.cpp \
+    $$EDITOR/packageselector.cpp \
+    $$EDITOR/schematic.cpp \
+    $$EDITOR/schematiceditor.cpp \
+    $$EDITOR/schematicindex.cpp \
+    $$EDITOR/symboleditor.cpp \
+    $$EDITOR/text.cpp \
+    $$EDITOR/unit.cpp
+
+HEADERS += $$EDITOR/array.h \
+    $$EDITOR/arrayimage.h \
+    $$EDITOR/arrayselector.h \
+    $$EDITOR/circuitsymbol.h \
+    $$EDITOR/circuitsymbolimage.h \
+    $$EDITOR/device.h \
+    $$EDITOR/deviceselector.h \
+    $$EDITOR/diodeselector.h \
+    $$EDITOR/element.h \
+    $$EDITOR/elementimage.h \
+    $$EDITOR/function.h \
+    $$EDITOR/glyphcache.h \
+    $$EDITOR/hierarchy.h \
+    $$EDITOR/objectstore.h \
+    $$EDITOR/packageselector.h \
+    $$EDITOR/schematic.h \
+    $$EDITOR/schematiceditor.h \
+    $$EDITOR/schematicindex.h \
+    $$EDITOR/symboleditor.h \
+    $$EDITOR/text.h \
+    $$EDITOR/unit.h \
+    $$EDITOR/unitimage.h
+
+FORMS += $$EDITOR/arrayselector.ui \
+    $$EDITOR/deviceselector.ui \
+    $$EDITOR/diodeselector.ui \
+    $$EDITOR/packageselector.ui \
+    $$EDITOR/schematiceditor.ui \
+    $$EDITOR/symboleditor.ui
@@ -1,9 +1,22 @@
 # common.pri
 
-INCLUDEPATH += ../common
+INCLUDEPATH += $$PWD
 
-SOURCES += ../common/package.cpp \
-    ../common/types.cpp
+SOURCES += $$PWD/editlog.cpp \
+    $$PWD/journal.cpp \
+    $$PWD/jsoncache.cpp \
+    $$PWD/library.cpp \
+    $$PWD/package.cpp \
+    $$PWD/svgwriter.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/types.cpp
 
-HEADERS += ../common/package.h \
-    ../common/types.h
+HEADERS += $$PWD/editlog.h \
+    $$PWD/exceptiondata.h \
+    $$PWD/journal.h \
+    $$PWD/jsoncache.h \
+    $$PWD/library.h \
+    $$PWD/package.h \
+    $$PWD/svgwriter.h \
+    $$PWD/threadpool.h \
+    $$PWD/types.h
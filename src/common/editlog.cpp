@@ -0,0 +1,279 @@
+// editlog.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "editlog.h"
+#include "exceptiondata.h"
+#include "threadpool.h"
+#include <chrono>
+#include <QCborValue>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace
+{
+// Record of change: undo flag, object, key, before, after.
+// Integers are 32 bit little endian, key is low and high 32 bits,
+// object is size and CBOR data, empty object has size 0.
+void appendInt(QByteArray &data, quint32 value)
+{
+    char bytes[4];
+
+    for (int i = 0; i < 4; i++)
+        bytes[i] = (value >> (8 * i)) & 0xff;
+    data.append(bytes, 4);
+}
+
+void appendObject(QByteArray &data, const QJsonObject &object)
+{
+    if (object.isEmpty()) {
+        appendInt(data, 0);
+        return;
+    }
+
+    QByteArray cbor = QCborValue::fromJsonValue(object).toCbor();
+    appendInt(data, cbor.size());
+    data.append(cbor);
+}
+
+bool readInt(const QByteArray &data, int &position, quint32 &value)
+{
+    if (position + 4 > data.size())
+        return false;
+
+    value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= quint32(uchar(data[position+i])) << (8 * i);
+    position += 4;
+
+    return true;
+}
+
+bool readObject(const QByteArray &data, int &position, QJsonObject &object)
+{
+    quint32 size;
+
+    if (!readInt(data, position, size) || size > quint32(data.size() - position))
+        return false;
+
+    object = QJsonObject();
+    if (size)
+        object = QCborValue::fromCbor(data.mid(position, size)).toJsonValue().toObject();
+    position += size;
+
+    return true;
+}
+}
+
+// Generation of new session differs from generations of left files
+EditLog::EditLog(const QString &basename):
+    hasSnapshot(false), generation(QRandomGenerator::global()->generate()), logSize(0),
+    pendingSnapshot(false), pendingGeneration(0)
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(directory);
+
+    for (int i = 0; i < maxSlots; i++) {
+        QString name = directory + "/" + basename + "-" + QString::number(i);
+        auto lock = std::make_unique<QLockFile>(name + ".lock");
+        if (!lock->tryLock(0))
+            continue;
+        lockFile = std::move(lock);
+        logName = name + ".log";
+        snapshotName = name + ".snapshot";
+        return;
+    }
+}
+
+// Session is finished, autosave files are not needed
+EditLog::~EditLog()
+{
+    wait();
+    logFile.close();
+    if (!lockFile)
+        return;
+    QFile::remove(logName);
+    QFile::remove(snapshotName);
+}
+
+void EditLog::append(const JournalChange &change, bool undo)
+{
+    // Design is replaced: log starts from next snapshot
+    if (change.object == Journal::allObjects) {
+        hasSnapshot = false;
+        changes.clear();
+        return;
+    }
+
+    if (!hasSnapshot)
+        return;
+
+    appendInt(changes, undo);
+    appendInt(changes, change.object);
+    appendInt(changes, quint64(change.key) & 0xffffffff);
+    appendInt(changes, quint64(change.key) >> 32);
+    appendObject(changes, change.before);
+    appendObject(changes, change.after);
+}
+
+void EditLog::attach(Journal &journal, const StateFunction &state)
+{
+    this->state = state;
+    journal.addListener([this](const JournalChange &change, bool undo) {
+        append(change, undo);
+    });
+    journal.addCommandListener([this]() { flush(); });
+}
+
+// Changes of command are passed to background thread
+void EditLog::flush()
+{
+    if (!lockFile)
+        return;
+    if (!hasSnapshot || logSize > compactSize) {
+        snapshot();
+        return;
+    }
+
+    if (changes.isEmpty())
+        return;
+
+    logSize += changes.size();
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingChanges.append(changes);
+    }
+    changes.clear();
+    write();
+}
+
+// Last record may be incomplete after crash, it is skipped.
+// Log of other generation belongs to older snapshot, it is skipped.
+void EditLog::recover(const LoadFunction &load, const Journal::Function &apply) const
+{
+    QFile file(snapshotName);
+    if (!file.open(QIODevice::ReadOnly))
+        throw ExceptionData(snapshotName + " open error");
+    QByteArray snapshotData = file.readAll();
+    file.close();
+
+    int position = 0;
+    quint32 snapshotGeneration;
+    if (!readInt(snapshotData, position, snapshotGeneration))
+        throw ExceptionData(snapshotName + " read error");
+    load(snapshotData.mid(position));
+
+    QFile log(logName);
+    if (!log.open(QIODevice::ReadOnly))
+        return;
+    QByteArray data = log.readAll();
+    log.close();
+
+    position = 0;
+    quint32 logGeneration;
+    if (!readInt(data, position, logGeneration) || logGeneration != snapshotGeneration)
+        return;
+
+    while (position < data.size()) {
+        quint32 undo;
+        quint32 object;
+        quint32 key;
+        quint32 keyHigh;
+        JournalChange change;
+        if (!readInt(data, position, undo) || !readInt(data, position, object) ||
+            !readInt(data, position, key) || !readInt(data, position, keyHigh) ||
+            !readObject(data, position, change.before) ||
+            !readObject(data, position, change.after))
+            break;
+        change.key = qint64(quint64(keyHigh) << 32 | key);
+        change.object = int(object);
+        apply(change, undo);
+    }
+}
+
+// State is read by calling thread, it is written by background thread
+void EditLog::snapshot()
+{
+    if (!state || !lockFile)
+        return;
+
+    QByteArray data = state();
+
+    changes.clear();
+    generation++;
+    hasSnapshot = true;
+    logSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingChanges.clear();
+        pendingGeneration = generation;
+        pendingSnapshot = true;
+        pendingState = data;
+    }
+    write();
+}
+
+void EditLog::wait()
+{
+    for (auto &t : tasks)
+        t.wait();
+    tasks.clear();
+}
+
+void EditLog::write()
+{
+    for (auto i = tasks.begin(); i != tasks.end();) {
+        if (i->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            i = tasks.erase(i);
+        else
+            ++i;
+    }
+
+    tasks.push_back(ThreadPool::global().submit([this]() { writeFiles(); }));
+}
+
+// Every task writes all pending data, so order of tasks does not matter.
+// Snapshot is replaced before log is truncated: after interrupted
+// compaction new snapshot is recovered and log of old generation is
+// skipped. Write errors are ignored.
+void EditLog::writeFiles()
+{
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    bool snapshot;
+    quint32 snapshotGeneration;
+    QByteArray data;
+    QByteArray snapshotData;
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        snapshot = pendingSnapshot;
+        snapshotGeneration = pendingGeneration;
+        data = pendingChanges;
+        snapshotData = pendingState;
+        pendingSnapshot = false;
+        pendingChanges.clear();
+        pendingState.clear();
+    }
+
+    if (snapshot) {
+        QByteArray header;
+        appendInt(header, snapshotGeneration);
+        logFile.close();
+        QSaveFile file(snapshotName);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        file.write(header);
+        file.write(snapshotData);
+        if (!file.commit())
+            return;
+        logFile.setFileName(logName);
+        if (logFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            logFile.write(header);
+    }
+
+    if (!data.isEmpty() && logFile.isOpen()) {
+        logFile.write(data);
+        logFile.flush();
+    }
+}
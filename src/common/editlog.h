@@ -0,0 +1,72 @@
+// editlog.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef EDITLOG_H
+#define EDITLOG_H
+
+#include "journal.h"
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QString>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Autosave: snapshot of design and append-only binary log of journal changes.
+// Changes of command are written by background thread, log is compacted
+// to new snapshot when it is big. Files of unfinished session are kept
+// for recovery, they are removed when log is destroyed. Files are in
+// application data directory, each running editor locks its own slot.
+class EditLog
+{
+public:
+    static constexpr qint64 compactSize = 4 * 1024 * 1024;
+    static constexpr int maxSlots = 16;
+
+    typedef std::function<void (const QByteArray &snapshot)> LoadFunction;
+    typedef std::function<QByteArray ()> StateFunction;
+
+    // Files: basename-slot.snapshot, basename-slot.log, basename-slot.lock.
+    // Unlocked slot of crashed editor is taken first.
+    explicit EditLog(const QString &basename);
+    ~EditLog();
+    // Journal changes are logged, state is JSON data of snapshot
+    void attach(Journal &journal, const StateFunction &state);
+    bool canRecover() const { return QFile::exists(snapshotName); }
+    // Snapshot is loaded, then logged changes are applied
+    void recover(const LoadFunction &load, const Journal::Function &apply) const;
+    // Full state is written with next generation, then log is truncated
+    void snapshot();
+    void wait();
+
+private:
+    void append(const JournalChange &change, bool undo);
+    void flush();
+    void write();
+    void writeFiles();
+
+    bool hasSnapshot;       // log changes apply to written snapshot
+    quint32 generation;     // generation of last snapshot, it is first int of log
+    qint64 logSize;
+    QByteArray changes;     // encoded changes of current command
+    QString logName;
+    QString snapshotName;
+    StateFunction state;
+
+    std::mutex fileMutex;
+    QFile logFile;
+    std::unique_ptr<QLockFile> lockFile;
+
+    std::mutex pendingMutex;    // data for background thread
+    bool pendingSnapshot;
+    quint32 pendingGeneration;
+    QByteArray pendingChanges;
+    QByteArray pendingState;
+    std::vector<std::future<void>> tasks;
+};
+
+#endif  // EDITLOG_H
@@ -0,0 +1,144 @@
+// journal.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "journal.h"
+#include <QJsonDocument>
+
+namespace
+{
+qint64 objectMemory(const QJsonObject &object)
+{
+    if (object.isEmpty())
+        return 0;
+    return QJsonDocument(object).toJson(QJsonDocument::Compact).size();
+}
+}
+
+void Journal::begin(const QString &name)
+{
+    if (!depth++) {
+        command.memory = 0;
+        command.name = name;
+        command.changes.clear();
+    }
+}
+
+void Journal::clear()
+{
+    depth = 0;
+    position = 0;
+    usedMemory = 0;
+    command.changes.clear();
+    commands.clear();
+    JournalChange change{0, allObjects, QJsonObject(), QJsonObject()};
+    notify(change, false);
+}
+
+void Journal::end()
+{
+    if (!depth || --depth)
+        return;
+    if (command.changes.empty())
+        return;
+    while (commands.size() > position) {
+        usedMemory -= commands.back().memory;
+        commands.pop_back();
+    }
+    usedMemory += command.memory;
+    commands.push_back(std::move(command));
+    position = commands.size();
+    command.changes.clear();
+    trim();
+    notifyCommand();
+}
+
+void Journal::notify(const JournalChange &change, bool undo)
+{
+    for (const auto &listener : listeners)
+        listener(change, undo);
+}
+
+void Journal::notifyCommand()
+{
+    for (const auto &listener : commandListeners)
+        listener();
+}
+
+void Journal::record(int object, qint64 key, const QJsonObject &before, const QJsonObject &after)
+{
+    if (before == after)
+        return;
+    bool single = !depth;
+    if (single)
+        begin(QString());
+
+    JournalChange change{key, object, after, before};
+    notify(change, false);
+
+    // Repeated change of same object is joined to last change
+    if (!command.changes.empty()) {
+        JournalChange &last = command.changes.back();
+        if (last.object == object && last.key == key &&
+            !last.after.isEmpty() && !before.isEmpty()) {
+            command.memory -= objectMemory(last.after);
+            last.after = after;
+            command.memory += objectMemory(after);
+            if (last.before == last.after) {
+                command.memory -= objectMemory(last.before) + objectMemory(last.after) +
+                                  sizeof(JournalChange);
+                command.changes.pop_back();
+            }
+            if (single)
+                end();
+            return;
+        }
+    }
+
+    command.changes.push_back(change);
+    command.memory += objectMemory(before) + objectMemory(after) + sizeof(JournalChange);
+    if (single)
+        end();
+}
+
+bool Journal::redo(const Function &apply)
+{
+    if (depth || !canRedo())
+        return false;
+    const JournalCommand &done = commands[position++];
+    for (const auto &change : done.changes) {
+        apply(change, false);
+        notify(change, false);
+    }
+    notifyCommand();
+    return true;
+}
+
+void Journal::setMemoryLimit(qint64 limit)
+{
+    memoryLimit = limit;
+    trim();
+}
+
+// Oldest commands are dropped, last command is kept
+void Journal::trim()
+{
+    while (usedMemory > memoryLimit && commands.size() > 1) {
+        usedMemory -= commands.front().memory;
+        commands.pop_front();
+        if (position)
+            position--;
+    }
+}
+
+bool Journal::undo(const Function &apply)
+{
+    if (depth || !canUndo())
+        return false;
+    const JournalCommand &done = commands[--position];
+    for (auto i = done.changes.rbegin(); i != done.changes.rend(); ++i) {
+        apply(*i, true);
+        notify(*i, true);
+    }
+    notifyCommand();
+    return true;
+}
@@ -0,0 +1,125 @@
+// journal.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QJsonObject>
+#include <QString>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <vector>
+
+// Change of one object of editor. Empty object: object does not exist,
+// so change inserts, erases or replaces object at key.
+class JournalChange
+{
+public:
+    qint64 key;             // index in container or map key
+    int object;             // object kind of editor, allObjects: all changed
+    QJsonObject after;
+    QJsonObject before;
+};
+
+// Changes of one user action
+class JournalCommand
+{
+public:
+    qint64 memory;
+    QString name;
+    std::vector<JournalChange> changes;
+};
+
+// Undo and redo by changes of commands, oldest commands are dropped
+// when memory limit is exceeded. Listeners get every applied change,
+// command listeners are called when command is done, undone or redone.
+class Journal
+{
+public:
+    static constexpr int allObjects = -1;
+    static constexpr qint64 defaultMemoryLimit = 16 * 1024 * 1024;
+
+    typedef std::function<void ()> CommandFunction;
+    typedef std::function<void (const JournalChange &change, bool undo)> Function;
+
+    Journal(): depth(0), memoryLimit(defaultMemoryLimit), position(0), usedMemory(0) {}
+    void addCommandListener(const CommandFunction &listener)
+        { commandListeners.push_back(listener); }
+    void addListener(const Function &listener) { listeners.push_back(listener); }
+    // Changes are one command until matching end
+    void begin(const QString &name);
+    bool canRedo() const { return position < commands.size(); }
+    bool canUndo() const { return position > 0; }
+    // Commands are dropped, listeners get allObjects change
+    void clear();
+    void end();
+    qint64 memory() const { return usedMemory; }
+    void record(int object, qint64 key, const QJsonObject &before, const QJsonObject &after);
+    bool redo(const Function &apply);
+    void setMemoryLimit(qint64 limit);
+    bool undo(const Function &apply);
+
+private:
+    void notify(const JournalChange &change, bool undo);
+    void notifyCommand();
+    void trim();
+
+    int depth;
+    qint64 memoryLimit;
+    size_t position;                        // commands before position are done
+    qint64 usedMemory;
+    JournalCommand command;                 // command being recorded
+    std::deque<JournalCommand> commands;
+    std::vector<CommandFunction> commandListeners;
+    std::vector<Function> listeners;
+};
+
+// Iterator of key in list is found from nearer end of list,
+// so objects appended at end are found at once
+template <typename T>
+typename std::list<T>::iterator listPosition(std::list<T> &list, qint64 key)
+{
+    qint64 size = list.size();
+
+    if (key <= size / 2)
+        return std::next(list.begin(), key);
+    return std::prev(list.end(), size - key);
+}
+
+// Changed middle part of list is recorded:
+// equal objects at begin and end are skipped
+template <typename T>
+void recordList(Journal &journal, const QString &name, int object, const std::list<T> &before,
+                const std::list<T> &list, bool (*same)(const T&, const T&))
+{
+    auto first = before.begin();
+    auto last = before.end();
+    auto first2 = list.begin();
+    auto last2 = list.end();
+    int key = 0;
+
+    while (first != last && first2 != last2 && same(*first, *first2)) {
+        ++first;
+        ++first2;
+        key++;
+    }
+    while (first != last && first2 != last2 &&
+           same(*std::prev(last), *std::prev(last2))) {
+        --last;
+        --last2;
+    }
+
+    journal.begin(name);
+    for (; first != last && first2 != last2; ++first, ++first2, key++)
+        if (!same(*first, *first2))
+            journal.record(object, key, (*first).toJson(), (*first2).toJson());
+    for (; first != last; ++first)
+        journal.record(object, key, (*first).toJson(), QJsonObject());
+    for (; first2 != last2; ++first2, key++)
+        journal.record(object, key, QJsonObject(), (*first2).toJson());
+    journal.end();
+}
+
+#endif  // JOURNAL_H
@@ -0,0 +1,102 @@
+// jsoncache.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "jsoncache.h"
+#include "threadpool.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// Value at first level of indented document
+QByteArray indentedValue(const QJsonValue &value)
+{
+    QByteArray data;
+
+    if (value.isArray())
+        data = QJsonDocument(value.toArray()).toJson(QJsonDocument::Indented);
+    else if (value.isObject())
+        data = QJsonDocument(value.toObject()).toJson(QJsonDocument::Indented);
+    else {
+        data = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+        return data.mid(1, data.size() - 2);
+    }
+
+    data.chop(1);
+    data.replace("\n", "\n    ");
+
+    return data;
+}
+}
+
+JsonCache::JsonCache(const std::vector<QString> &keys)
+{
+    // Keys are names without escaped characters
+    for (auto &k : keys)
+        sections.push_back(Section{true, QByteArray(), "\"" + k.toUtf8() + "\""});
+}
+
+void JsonCache::attach(Journal &journal)
+{
+    journal.addListener([this](const JournalChange &change, bool) {
+        if (change.object == Journal::allObjects)
+            setAllDirty();
+        else
+            setDirty(change.object);
+    });
+}
+
+// Keys of header and sections must differ
+QByteArray JsonCache::document(const QJsonObject &header, const Function &function)
+{
+    std::vector<int> dirty;
+    for (uint i = 0; i < sections.size(); i++)
+        if (sections[i].dirty)
+            dirty.push_back(i);
+
+    ThreadPool::global().parallelFor(0, dirty.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            Section &section = sections[dirty[i]];
+            section.data = indentedValue(function(dirty[i]));
+            section.dirty = false;
+        }
+    }, 1);
+
+    std::vector<std::pair<QByteArray, const QByteArray*>> values;
+    std::vector<QByteArray> headerValues;
+    headerValues.reserve(header.size());
+    for (const QString &k : header.keys()) {
+        headerValues.push_back(indentedValue(header.value(k)));
+        values.push_back(std::make_pair("\"" + k.toUtf8() + "\"", &headerValues.back()));
+    }
+    for (auto &s : sections)
+        values.push_back(std::make_pair(s.key, &s.data));
+    std::sort(values.begin(), values.end());
+
+    QByteArray data("{\n");
+    for (auto &v : values) {
+        if (data.size() > 2)
+            data.append(",\n");
+        data.append("    ");
+        data.append(v.first);
+        data.append(": ");
+        data.append(*v.second);
+    }
+    data.append("\n}\n");
+
+    return data;
+}
+
+void JsonCache::setAllDirty()
+{
+    for (auto &s : sections)
+        s.dirty = true;
+}
+
+void JsonCache::setDirty(int section)
+{
+    if (section >= 0 && section < int(sections.size()))
+        sections[section].dirty = true;
+}
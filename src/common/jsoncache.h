@@ -0,0 +1,44 @@
+// jsoncache.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef JSONCACHE_H
+#define JSONCACHE_H
+
+#include "journal.h"
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <functional>
+#include <vector>
+
+// JSON document of sections, section number is journal object kind.
+// Serialized section is kept until journal changes its object,
+// dirty sections are serialized again in parallel.
+class JsonCache
+{
+public:
+    typedef std::function<QJsonValue (int section)> Function;
+
+    // Section keys are in order of section numbers
+    explicit JsonCache(const std::vector<QString> &keys);
+    void attach(Journal &journal);
+    // Indented JSON object of header values and sections, keys are sorted
+    // as in QJsonDocument, so file is same as before cache
+    QByteArray document(const QJsonObject &header, const Function &function);
+    void setAllDirty();
+    void setDirty(int section);
+
+private:
+    class Section
+    {
+    public:
+        bool dirty;
+        QByteArray data;
+        QByteArray key;
+    };
+
+    std::vector<Section> sections;
+};
+
+#endif  // JSONCACHE_H
@@ -0,0 +1,659 @@
+// library.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "exceptiondata.h"
+#include "library.h"
+#include "threadpool.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+namespace {
+
+// Finds byte ranges of objects without building JSON values
+class JsonScanner
+{
+public:
+    JsonScanner(const QByteArray &data, const QString &filename):
+        begin(data.constData()), end(data.constData() + data.size()),
+        p(data.constData()), filename(filename) {}
+    int count();
+    void expect(char c);
+    void next() { p++; }
+    LibraryObject object(const QString &nameKey, const QString &countKey);
+    char peek();
+    void skipValue();
+    QString string();
+
+private:
+    void error() const;
+    void skipString();
+
+    const char *begin;
+    const char *end;
+    const char *p;
+    QString filename;
+};
+
+int JsonScanner::count()
+{
+    int n = 0;
+
+    expect('[');
+    if (peek() == ']') {
+        next();
+        return n;
+    }
+    for (;;) {
+        skipValue();
+        n++;
+        if (peek() != ',')
+            break;
+        next();
+    }
+    expect(']');
+
+    return n;
+}
+
+void JsonScanner::error() const
+{
+    throw ExceptionData(filename + " read error, offset: " + QString::number(p - begin));
+}
+
+void JsonScanner::expect(char c)
+{
+    if (peek() != c)
+        error();
+    next();
+}
+
+LibraryObject JsonScanner::object(const QString &nameKey, const QString &countKey)
+{
+    LibraryObject object;
+
+    peek();
+    const char *start = p;
+    expect('{');
+    if (peek() != '}')
+        for (;;) {
+            QString key = string();
+            expect(':');
+            if (key == nameKey && peek() == '"')
+                object.name = string();
+            else if (key == countKey && peek() == '[')
+                object.count = count();
+            else
+                skipValue();
+            if (peek() != ',')
+                break;
+            next();
+        }
+    expect('}');
+    object.text = QByteArray::fromRawData(start, p - start);
+
+    return object;
+}
+
+char JsonScanner::peek()
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        p++;
+
+    return p < end ? *p : 0;
+}
+
+void JsonScanner::skipString()
+{
+    expect('"');
+    while (p < end && *p != '"') {
+        if (*p == '\\')
+            p++;
+        p++;
+    }
+    expect('"');
+}
+
+void JsonScanner::skipValue()
+{
+    char c = peek();
+
+    if (c == '{' || c == '[') {
+        char close = c == '{' ? '}' : ']';
+        next();
+        if (peek() == close) {
+            next();
+            return;
+        }
+        for (;;) {
+            if (c == '{') {
+                skipString();
+                expect(':');
+            }
+            skipValue();
+            if (peek() != ',')
+                break;
+            next();
+        }
+        expect(close);
+        return;
+    }
+
+    if (c == '"') {
+        skipString();
+        return;
+    }
+
+    const char *start = p;
+    while (p < end && !std::strchr(",:]} \n\r\t", *p))
+        p++;
+    if (p == start)
+        error();
+}
+
+QString JsonScanner::string()
+{
+    peek();
+    const char *start = p;
+    skipString();
+    QByteArray text = QByteArray::fromRawData(start, p - start);
+
+    // Escaped characters are decoded by JSON parser
+    if (text.contains('\\'))
+        return QJsonDocument::fromJson("[" + text + "]").array().at(0).toString();
+
+    return QString::fromUtf8(start + 1, p - start - 2);
+}
+
+void read(QDataStream &in, Border &b)
+{
+    in >> b.leftX >> b.topY >> b.rightX >> b.bottomY;
+}
+
+void read(QDataStream &in, Ellipse &e)
+{
+    in >> e.x >> e.y >> e.w >> e.h;
+}
+
+void read(QDataStream &in, Line &l)
+{
+    in >> l.x1 >> l.y1 >> l.x2 >> l.y2;
+}
+
+void read(QDataStream &in, Pad &p)
+{
+    in >> p.diameter >> p.height >> p.innerDiameter >> p.net >> p.number
+       >> p.orientation >> p.typeNumber >> p.width >> p.x >> p.y;
+}
+
+void read(QDataStream &in, PadTypeParams &p)
+{
+    in >> p.diameter >> p.height >> p.innerDiameter >> p.width;
+}
+
+template <class T>
+void read(QDataStream &in, std::vector<T> &v)
+{
+    quint32 n;
+    in >> n;
+    if (in.status() != QDataStream::Ok)
+        return;
+    v.resize(n);
+    for (auto &t : v)
+        read(in, t);
+}
+
+void readPackage(QDataStream &in, Package &p)
+{
+    in >> p.centerX >> p.centerY >> p.outerBorderCenterX >> p.outerBorderCenterY;
+    read(in, p.border);
+    read(in, p.outerBorder);
+    in >> p.name >> p.type;
+    read(in, p.ellipses);
+    read(in, p.lines);
+    read(in, p.pads);
+    read(in, p.padTypesParams);
+}
+
+void write(QDataStream &out, const Border &b)
+{
+    out << b.leftX << b.topY << b.rightX << b.bottomY;
+}
+
+void write(QDataStream &out, const Ellipse &e)
+{
+    out << e.x << e.y << e.w << e.h;
+}
+
+void write(QDataStream &out, const Line &l)
+{
+    out << l.x1 << l.y1 << l.x2 << l.y2;
+}
+
+void write(QDataStream &out, const Pad &p)
+{
+    out << p.diameter << p.height << p.innerDiameter << p.net << p.number
+        << p.orientation << p.typeNumber << p.width << p.x << p.y;
+}
+
+void write(QDataStream &out, const PadTypeParams &p)
+{
+    out << p.diameter << p.height << p.innerDiameter << p.width;
+}
+
+template <class T>
+void write(QDataStream &out, const std::vector<T> &v)
+{
+    out << quint32(v.size());
+    for (auto &t : v)
+        write(out, t);
+}
+
+void writePackage(QDataStream &out, const Package &p)
+{
+    out << p.centerX << p.centerY << p.outerBorderCenterX << p.outerBorderCenterY;
+    write(out, p.border);
+    write(out, p.outerBorder);
+    out << p.name << p.type;
+    write(out, p.ellipses);
+    write(out, p.lines);
+    write(out, p.pads);
+    write(out, p.padTypesParams);
+}
+
+}
+
+QSet<QString> Library::names;
+std::mutex Library::namesMutex;
+
+QJsonObject LibraryObject::parse() const
+{
+    QJsonParseError error;
+    QJsonDocument document(QJsonDocument::fromJson(text, &error));
+
+    if (!document.isObject())
+        throw ExceptionData(name + " read error: " + error.errorString());
+
+    return document.object();
+}
+
+QString Library::cacheFilename()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           "/board-builder/packages.cache";
+}
+
+QStringList Library::filenames(const QString &libraryname, const QString &objectName)
+{
+    QByteArray byteArray = readFile(libraryname);
+    QJsonDocument document(QJsonDocument::fromJson(byteArray));
+    if (document.isNull())
+        throw ExceptionData("Library file read error: " + libraryname);
+
+    QJsonObject object = document.object();
+
+    if (object["object"].toString() != objectName)
+        throw ExceptionData(libraryname + " is not a " + objectName + " file");
+
+    QStringList names;
+    for (auto f : object["filenames"].toArray())
+        names.append(f.toString());
+
+    return names;
+}
+
+// FNV-1a
+quint64 Library::hash(const QByteArray &byteArray, quint64 h)
+{
+    for (char c : byteArray)
+        h = (h ^ uchar(c)) * 1099511628211ull;
+
+    return h;
+}
+
+QString Library::intern(const QString &name)
+{
+    std::lock_guard<std::mutex> lock(namesMutex);
+
+    auto i = names.constFind(name);
+    if (i != names.constEnd())
+        return *i;
+    names.insert(name);
+
+    return name;
+}
+
+PackageLibrary &Library::packages()
+{
+    static PackageLibrary library;
+    return library;
+}
+
+// The only parser of packages files
+std::vector<Package> Library::parsePackages(const QByteArray &byteArray,
+                                            const QString &filename)
+{
+    QJsonParseError error;
+    std::vector<Package> packages;
+
+    QJsonDocument document(QJsonDocument::fromJson(byteArray, &error));
+    if (document.isNull())
+        throw ExceptionData(filename + " read error: " + error.errorString() +
+                            ", offset: " + QString::number(error.offset));
+
+    QJsonObject object = document.object();
+
+    if (object["object"].toString() != "packages")
+        throw ExceptionData(filename + " is not a packages file");
+
+    QJsonArray packageArray(object["packages"].toArray());
+    packages.reserve(packageArray.size());
+    for (auto p : packageArray) {
+        packages.push_back(Package(p));
+        packages.back().name = intern(packages.back().name);
+        packages.back().type = intern(packages.back().type);
+    }
+
+    return packages;
+}
+
+QByteArray Library::readFile(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        throw ExceptionData(filename + " open error");
+    QByteArray byteArray = file.readAll();
+    file.close();
+
+    return byteArray;
+}
+
+std::vector<LibraryFile> Library::readFiles(const QString &directory,
+                                            const QStringList &filenames)
+{
+    std::vector<LibraryFile> files(filenames.size());
+
+    ThreadPool::global().parallelFor(0, files.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            LibraryFile &f = files[i];
+            f.name = filenames[i];
+            f.file = std::make_shared<QFile>(directory + "/" + filenames[i]);
+            if (!f.file->open(QIODevice::ReadOnly))
+                throw ExceptionData(filenames[i] + " open error");
+            qint64 size = f.file->size();
+            uchar *data = size > 0 ? f.file->map(0, size) : nullptr;
+            if (data)
+                f.data = QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+            else
+                f.data = f.file->readAll();
+        }
+    }, 1);
+
+    return files;
+}
+
+// Objects of root array, objectType is value of root "object" key.
+// Returns false if there is no array in file.
+bool Library::scan(const LibraryFile &file, const QString &arrayName,
+                   const QString &nameKey, const QString &countKey,
+                   QString &objectType, std::vector<LibraryObject> &objects)
+{
+    bool hasArray = false;
+    JsonScanner scanner(file.data, file.name);
+
+    scanner.expect('{');
+    if (scanner.peek() != '}')
+        for (;;) {
+            QString key = scanner.string();
+            scanner.expect(':');
+            if (key == "object" && scanner.peek() == '"')
+                objectType = scanner.string();
+            else if (key == arrayName && scanner.peek() == '[') {
+                hasArray = true;
+                scanner.next();
+                if (scanner.peek() != ']')
+                    for (;;) {
+                        objects.push_back(scanner.object(nameKey, countKey));
+                        objects.back().file = file.file;
+                        if (scanner.peek() != ',')
+                            break;
+                        scanner.next();
+                    }
+                scanner.expect(']');
+            }
+            else
+                scanner.skipValue();
+            if (scanner.peek() != ',')
+                break;
+            scanner.next();
+        }
+    scanner.expect('}');
+
+    return hasArray;
+}
+
+void PackageLibrary::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    cacheFile.reset();
+    entries.clear();
+    index.clear();
+    lru.clear();
+    usedMemory = 0;
+}
+
+qint64 PackageLibrary::estimateMemory(const Package &package)
+{
+    return sizeof(Package) + 2 * (package.name.size() + package.type.size()) +
+           package.ellipses.size() * sizeof(Ellipse) +
+           package.lines.size() * sizeof(Line) +
+           package.pads.size() * sizeof(Pad) +
+           package.padTypesParams.size() * sizeof(PadTypeParams);
+}
+
+// Least recently used packages, that are not used outside, are unloaded
+void PackageLibrary::evict()
+{
+    auto i = lru.end();
+
+    while (usedMemory > memoryLimit && i != lru.begin()) {
+        --i;
+        Entry &e = entries[*i];
+        if (e.package.use_count() > 1)
+            continue;
+        usedMemory -= e.memory;
+        e.package.reset();
+        i = lru.erase(i);
+    }
+}
+
+int PackageLibrary::find(const QString &name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.value(name, -1);
+}
+
+std::shared_ptr<const Package> PackageLibrary::package(int index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (index < 0 || index >= int(entries.size()))
+        return nullptr;
+
+    Entry &e = entries[index];
+
+    if (e.package) {
+        lru.splice(lru.begin(), lru, e.lruPosition);
+        return e.package;
+    }
+
+    auto package = std::make_shared<Package>();
+    if (!e.blob.isEmpty()) {
+        QDataStream in(e.blob);
+        in.setVersion(QDataStream::Qt_6_0);
+        readPackage(in, *package);
+        if (in.status() != QDataStream::Ok)
+            throw ExceptionData("Package cache read error: " + e.name);
+    }
+    else
+        *package = Package(e.object.parse());
+    package->name = e.name;
+    package->type = Library::intern(package->type);
+
+    e.package = package;
+    e.memory = estimateMemory(*package);
+    usedMemory += e.memory;
+    lru.push_front(index);
+    e.lruPosition = lru.begin();
+    evict();
+
+    return package;
+}
+
+std::shared_ptr<const Package> PackageLibrary::package(const QString &name)
+{
+    return package(find(name));
+}
+
+// Package files are scanned only if cache is not valid,
+// then cache is written in background
+void PackageLibrary::read(const QString &libraryname, const QString &directory)
+{
+    QStringList names = Library::filenames(libraryname, "packageLibrary");
+    std::vector<LibraryFile> files = Library::readFiles(directory, names);
+    std::vector<quint64> fileHashes(files.size());
+    std::vector<std::vector<LibraryObject>> fileObjects(files.size());
+
+    clear();
+
+    ThreadPool::global().parallelFor(0, files.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++)
+            fileHashes[i] = Library::hash(files[i].data, Library::hash(names[i].toUtf8()));
+    });
+
+    quint64 h = Library::hashOffset;
+    for (quint64 f : fileHashes)
+        h = (h ^ f) * 1099511628211ull;
+
+    if (readCache(h))
+        return;
+
+    ThreadPool::global().parallelFor(0, files.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            QString objectType;
+            Library::scan(files[i], "packages", "name", "pads", objectType, fileObjects[i]);
+            if (objectType != "packages")
+                throw ExceptionData(names[i] + " is not a packages file");
+        }
+    }, 1);
+
+    std::vector<LibraryObject> objects;
+    for (auto &f : fileObjects)
+        for (auto &o : f) {
+            Entry e;
+            e.padsNumber = o.count;
+            e.memory = 0;
+            e.name = Library::intern(o.name);
+            e.object = o;
+            index.insert(e.name, entries.size());
+            entries.push_back(e);
+            objects.push_back(o);
+        }
+
+    ThreadPool::global().submit([h, objects]() { writeCache(h, objects); });
+}
+
+// Cache file stays mapped, packages are read from it on demand
+bool PackageLibrary::readCache(quint64 filesHash)
+{
+    auto file = std::make_shared<QFile>(Library::cacheFilename());
+    if (!file->open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = file->size();
+    const char *data = reinterpret_cast<const char*>(file->map(0, size));
+    if (!data)
+        return false;
+
+    QByteArray byteArray = QByteArray::fromRawData(data, size);
+    QDataStream in(byteArray);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version, n;
+    quint64 h;
+    in >> magic >> version >> h >> n;
+    if (in.status() != QDataStream::Ok || magic != cacheMagic ||
+        version != cacheVersion || h != filesHash)
+        return false;
+
+    entries.resize(n);
+    std::vector<quint32> lengths(n);
+    for (quint32 i = 0; i < n; i++) {
+        in >> entries[i].name >> entries[i].padsNumber >> lengths[i];
+        entries[i].memory = 0;
+        entries[i].name = Library::intern(entries[i].name);
+    }
+
+    qint64 offset = in.device()->pos();
+    for (quint32 i = 0; i < n; i++) {
+        if (in.status() != QDataStream::Ok || offset + lengths[i] > size) {
+            clear();
+            return false;
+        }
+        entries[i].blob = QByteArray::fromRawData(data + offset, lengths[i]);
+        offset += lengths[i];
+        index.insert(entries[i].name, i);
+    }
+
+    cacheFile = file;
+
+    return true;
+}
+
+void PackageLibrary::setMemoryLimit(qint64 limit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryLimit = limit;
+    evict();
+}
+
+// Cache is optional, write errors are ignored
+void PackageLibrary::writeCache(quint64 filesHash, const std::vector<LibraryObject> &objects)
+{
+    std::vector<QByteArray> blobs(objects.size());
+
+    ThreadPool::global().parallelFor(0, objects.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            QDataStream out(&blobs[i], QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            writePackage(out, Package(objects[i].parse()));
+        }
+    });
+
+    QString filename = Library::cacheFilename();
+    if (!QDir().mkpath(QFileInfo(filename).absolutePath()))
+        return;
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << cacheMagic << cacheVersion << filesHash << quint32(objects.size());
+    for (uint i = 0; i < objects.size(); i++)
+        out << objects[i].name << qint32(objects[i].count) << quint32(blobs[i].size());
+    for (auto &b : blobs)
+        out.writeRawData(b.constData(), b.size());
+
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+    else
+        file.cancelWriting();
+}
@@ -0,0 +1,124 @@
+// library.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "package.h"
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class PackageLibrary;
+
+// Library file mapped to memory
+class LibraryFile
+{
+public:
+    QByteArray data;                // raw data of mapped file
+    QString name;
+    std::shared_ptr<QFile> file;    // keeps data mapped
+};
+
+// JSON object of library file, parsed on demand
+class LibraryObject
+{
+public:
+    LibraryObject(): count(0) {}
+    QJsonObject parse() const;
+
+    int count;                      // elements of counted array
+    QString name;                   // value of name key
+    QByteArray text;                // object text in mapped file
+    std::shared_ptr<QFile> file;
+};
+
+// Library service shared by board, schematic, package and symbol editors.
+// Library files are read in parallel and scanned for object names
+// and byte ranges, objects are parsed when they are used.
+class Library
+{
+public:
+    static constexpr quint64 hashOffset = 14695981039346656037ull;
+
+    static QString cacheFilename();
+    static QStringList filenames(const QString &libraryname, const QString &objectName);
+    static quint64 hash(const QByteArray &byteArray, quint64 h = hashOffset);
+    // Equal names share one string buffer
+    static QString intern(const QString &name);
+    static PackageLibrary &packages();
+    static std::vector<Package> parsePackages(const QByteArray &byteArray,
+                                              const QString &filename);
+    static QByteArray readFile(const QString &filename);
+    static std::vector<LibraryFile> readFiles(const QString &directory,
+                                              const QStringList &filenames);
+    static bool scan(const LibraryFile &file, const QString &arrayName,
+                     const QString &nameKey, const QString &countKey,
+                     QString &objectType, std::vector<LibraryObject> &objects);
+
+private:
+    static QSet<QString> names;
+    static std::mutex namesMutex;
+};
+
+// Packages by name, loaded on first use and evicted when unused
+// packages take more memory than limit. Package files are indexed
+// by binary cache shared by editors, cache is valid while hash of
+// package files is not changed.
+class PackageLibrary
+{
+public:
+    static constexpr quint32 cacheMagic = 0x504b4743;   // PKGC
+    static constexpr quint32 cacheVersion = 2;
+    static constexpr qint64 defaultMemoryLimit = 64 * 1024 * 1024;
+
+    PackageLibrary(): memoryLimit(defaultMemoryLimit), usedMemory(0) {}
+    void clear();
+    int find(const QString &name) const;
+    qint64 memory() const { return usedMemory; }
+    const QString &name(int index) const { return entries[index].name; }
+    std::shared_ptr<const Package> package(int index);
+    std::shared_ptr<const Package> package(const QString &name);
+    int padsNumber(int index) const { return entries[index].padsNumber; }
+    void read(const QString &libraryname, const QString &directory);
+    void setMemoryLimit(qint64 limit);
+    int size() const { return entries.size(); }
+
+private:
+    class Entry
+    {
+    public:
+        int padsNumber;
+        qint64 memory;                      // estimated size of package
+        QByteArray blob;                    // package in mapped cache
+        QString name;
+        LibraryObject object;               // package in mapped file
+        std::list<int>::iterator lruPosition;
+        std::shared_ptr<const Package> package;
+    };
+
+    static qint64 estimateMemory(const Package &package);
+    // Called with locked mutex
+    void evict();
+    bool readCache(quint64 filesHash);
+    static void writeCache(quint64 filesHash, const std::vector<LibraryObject> &objects);
+
+    qint64 memoryLimit;
+    qint64 usedMemory;
+    mutable std::mutex mutex;               // packages are loaded by GUI and worker threads
+    std::shared_ptr<QFile> cacheFile;       // keeps blobs mapped
+    std::list<int> lru;                     // loaded entries, last used first
+    std::vector<Entry> entries;
+    QHash<QString, int> index;              // package name, entry
+};
+
+#endif  // LIBRARY_H
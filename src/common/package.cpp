@@ -6,7 +6,7 @@
 #include <cmath>
 #include <QJsonArray>
 
-bool Pad::exist(int x_, int y_)
+bool Pad::exist(int x_, int y_) const
 {
     int dx = width / 2;
     int dy = height / 2;
@@ -25,7 +25,7 @@ bool Pad::exist(int x_, int y_)
     return false;
 }
 
-QJsonObject Pad::toJson()
+QJsonObject Pad::toJson() const
 {
     QJsonObject object
     {
@@ -38,7 +38,7 @@ QJsonObject Pad::toJson()
     return object;
 }
 
-QJsonObject PadTypeParams::toJson()
+QJsonObject PadTypeParams::toJson() const
 {
     QJsonObject object
     {
@@ -132,14 +132,14 @@ void Package::findOuterBorder()
     int minY = 0;
     int maxY = 0;
 
-    for (auto e : ellipses) {
+    for (const auto &e : ellipses) {
         if (minX > e.x - e.w / 2) minX = e.x - e.w / 2;
         if (maxX < e.x + e.w / 2) maxX = e.x + e.w / 2;
         if (minY > e.y - e.h / 2) minY = e.y - e.h / 2;
         if (maxY < e.y + e.h / 2) maxY = e.y + e.h / 2;
     }
 
-    for (auto l : lines) {
+    for (const auto &l : lines) {
         if (minX > l.x1) minX = l.x1;
         if (minX > l.x2) minX = l.x2;
         if (maxX < l.x1) maxX = l.x1;
@@ -150,7 +150,7 @@ void Package::findOuterBorder()
         if (maxY < l.y2) maxY = l.y2;
     }
 
-    for (auto p : pads) {
+    for (const auto &p : pads) {
         int w = p.width;
         int h = p.height;
         if (w == 0 || h == 0) {
@@ -172,22 +172,22 @@ void Package::findOuterBorder()
     outerBorderCenterY = (minY + maxY) / 2;
 }
 
-QJsonObject Package::toJson()
+QJsonObject Package::toJson() const
 {
     QJsonArray ellipsesArray;
-    for (auto e : ellipses)
+    for (const auto &e : ellipses)
         ellipsesArray.append(e.toJson());
 
     QJsonArray linesArray;
-    for (auto l : lines)
+    for (const auto &l : lines)
         linesArray.append(l.toJson());
 
     QJsonArray padsArray;
-    for (auto p : pads)
+    for (const auto &p : pads)
         padsArray.append(p.toJson());
 
     QJsonArray padTypesParamsArray;
-    for (auto p : padTypesParams)
+    for (const auto &p : padTypesParams)
         padTypesParamsArray.append(p.toJson());
 
     QJsonObject object
@@ -11,8 +11,8 @@
 class Pad
 {
 public:
-    bool exist(int x_, int y_);
-    QJsonObject toJson();
+    bool exist(int x_, int y_) const;
+    QJsonObject toJson() const;
 
     int diameter;
     int height;
@@ -29,7 +29,7 @@ public:
 class PadTypeParams
 {
 public:
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int diameter;
     int height;
@@ -44,7 +44,7 @@ public:
     Package(const QJsonValue &value);
     void clear();
     void findOuterBorder();
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int centerX;        // border center
     int centerY;
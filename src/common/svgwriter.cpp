@@ -0,0 +1,222 @@
+// svgwriter.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "exceptiondata.h"
+#include "svgwriter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Integer or 2 decimals without trailing zeros
+QByteArray number(double value)
+{
+    value = std::round(100 * value) / 100;
+    if (value == std::floor(value))
+        return QByteArray::number(qint64(value));
+
+    QByteArray text = QByteArray::number(value, 'f', 2);
+    if (text.endsWith('0'))
+        text.chop(1);
+
+    return text;
+}
+
+}
+
+void SvgPath::add(char command, double x, double y)
+{
+    data += command;
+    data += number(x);
+    data += " ";
+    data += number(y);
+    include(x, y);
+    this->x = x;
+    this->y = y;
+    hasPoint = true;
+}
+
+// Curves are added by control points
+void SvgPath::addPath(const QPainterPath &path)
+{
+    for (int i = 0; i < path.elementCount(); i++) {
+        QPainterPath::Element e = path.elementAt(i);
+        switch (e.type) {
+        case QPainterPath::MoveToElement:
+            add('M', e.x, e.y);
+            break;
+        case QPainterPath::LineToElement:
+            add('L', e.x, e.y);
+            break;
+        case QPainterPath::CurveToElement:
+            add('C', e.x, e.y);
+            break;
+        case QPainterPath::CurveToDataElement:
+            data += " ";
+            data += number(e.x);
+            data += " ";
+            data += number(e.y);
+            include(e.x, e.y);
+            x = e.x;
+            y = e.y;
+            break;
+        }
+    }
+}
+
+// Arc bounds are bounds of ellipse
+void SvgPath::arc(double centerX, double centerY, double rx, double ry,
+                  double startAngle, double spanAngle)
+{
+    const double pi = acos(-1);
+
+    if (fabs(spanAngle) >= 360) {
+        ellipse(centerX, centerY, rx, ry);
+        return;
+    }
+
+    double a1 = startAngle * pi / 180;
+    double a2 = (startAngle + spanAngle) * pi / 180;
+    double x2 = centerX + rx * cos(a2);
+    double y2 = centerY - ry * sin(a2);
+
+    moveTo(centerX + rx * cos(a1), centerY - ry * sin(a1));
+    data += "A" + number(rx) + " " + number(ry) + " 0 " +
+            (fabs(spanAngle) > 180 ? "1" : "0") + " " + (spanAngle < 0 ? "1" : "0") +
+            " " + number(x2) + " " + number(y2);
+    include(centerX - rx, centerY - ry);
+    include(centerX + rx, centerY + ry);
+    x = x2;
+    y = y2;
+}
+
+void SvgPath::ellipse(double centerX, double centerY, double rx, double ry)
+{
+    QByteArray r = "A" + number(rx) + " " + number(ry) + " 0 1 0 ";
+
+    moveTo(centerX + rx, centerY);
+    data += r + number(centerX - rx) + " " + number(centerY);
+    data += r + number(centerX + rx) + " " + number(centerY);
+    include(centerX - rx, centerY - ry);
+    include(centerX + rx, centerY + ry);
+    x = centerX + rx;
+    y = centerY;
+}
+
+void SvgPath::include(double x, double y)
+{
+    if (!hasBounds) {
+        bounds = Border(floor(x), floor(y), ceil(x), ceil(y));
+        hasBounds = true;
+        return;
+    }
+
+    bounds.leftX = std::min(bounds.leftX, int(floor(x)));
+    bounds.topY = std::min(bounds.topY, int(floor(y)));
+    bounds.rightX = std::max(bounds.rightX, int(ceil(x)));
+    bounds.bottomY = std::max(bounds.bottomY, int(ceil(y)));
+}
+
+void SvgPath::line(double x1, double y1, double x2, double y2)
+{
+    moveTo(x1, y1);
+    add('L', x2, y2);
+}
+
+void SvgPath::moveTo(double x, double y)
+{
+    if (!hasPoint || x != this->x || y != this->y)
+        add('M', x, y);
+}
+
+void SvgPath::unite(Border &border, bool &hasBorder) const
+{
+    if (isEmpty())
+        return;
+
+    if (!hasBorder) {
+        border = bounds;
+        hasBorder = true;
+        return;
+    }
+
+    border.leftX = std::min(border.leftX, bounds.leftX);
+    border.topY = std::min(border.topY, bounds.topY);
+    border.rightX = std::max(border.rightX, bounds.rightX);
+    border.bottomY = std::max(border.bottomY, bounds.bottomY);
+}
+
+SvgWriter::SvgWriter(const QString &filename): file(filename)
+{
+    if (!file.open(QIODevice::WriteOnly))
+        throw ExceptionData(filename + " open error");
+}
+
+void SvgWriter::begin(const Border &viewBox, double millimeters)
+{
+    int w = viewBox.rightX - viewBox.leftX;
+    int h = viewBox.bottomY - viewBox.topY;
+
+    write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+          "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+          "xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"" +
+          number(w * millimeters) + "mm\" height=\"" + number(h * millimeters) +
+          "mm\" viewBox=\"" + number(viewBox.leftX) + " " + number(viewBox.topY) + " " +
+          number(w) + " " + number(h) + "\">\n");
+}
+
+void SvgWriter::beginGroup(const QString &attributes)
+{
+    write("<g " + attributes.toUtf8() + ">\n");
+}
+
+void SvgWriter::circle(int x, int y, int r, const QString &attributes)
+{
+    write("<circle " + attributes.toUtf8() + " cx=\"" + number(x) + "\" cy=\"" +
+          number(y) + "\" r=\"" + number(r) + "\"/>\n");
+}
+
+void SvgWriter::end()
+{
+    write("</svg>\n");
+    file.close();
+}
+
+void SvgWriter::path(const SvgPath &path, const QString &attributes)
+{
+    if (path.isEmpty())
+        return;
+
+    write("<path " + attributes.toUtf8() + " d=\"");
+    write(path.data);
+    write("\"/>\n");
+}
+
+void SvgWriter::rect(int x, int y, int w, int h, int r, const QString &attributes)
+{
+    QByteArray radius;
+    if (r > 0)
+        radius = " rx=\"" + number(r) + "\"";
+
+    write("<rect " + attributes.toUtf8() + " x=\"" + number(x) + "\" y=\"" +
+          number(y) + "\" width=\"" + number(w) + "\" height=\"" + number(h) +
+          "\"" + radius + "/>\n");
+}
+
+void SvgWriter::text(int x, int y, const QString &text, const QString &attributes)
+{
+    write("<text " + attributes.toUtf8() + " x=\"" + number(x) + "\" y=\"" +
+          number(y) + "\">" + text.toHtmlEscaped().toUtf8() + "</text>\n");
+}
+
+void SvgWriter::use(const QString &id, int x, int y)
+{
+    write("<use xlink:href=\"#" + id.toUtf8() + "\" x=\"" + number(x) +
+          "\" y=\"" + number(y) + "\"/>\n");
+}
+
+void SvgWriter::write(const QByteArray &data)
+{
+    if (file.write(data) != data.size())
+        throw ExceptionData(file.fileName() + " write error");
+}
@@ -0,0 +1,68 @@
+// svgwriter.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef SVGWRITER_H
+#define SVGWRITER_H
+
+#include "types.h"
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QPainterPath>
+#include <QString>
+
+// Path data of many shapes, bounds of points are kept
+class SvgPath
+{
+public:
+    SvgPath(): hasBounds(false), hasPoint(false), x(0), y(0) {}
+    void addPath(const QPainterPath &path);
+    // Angle unit: 1 degree, angle > 0: counter-clockwise direction, as QPainter
+    void arc(double centerX, double centerY, double rx, double ry,
+             double startAngle, double spanAngle);
+    void ellipse(double centerX, double centerY, double rx, double ry);
+    bool isEmpty() const { return data.isEmpty(); }
+    void line(double x1, double y1, double x2, double y2);
+    void unite(Border &border, bool &hasBorder) const;
+
+    Border bounds;
+    QByteArray data;
+
+private:
+    void add(char command, double x, double y);
+    void include(double x, double y);
+    void moveTo(double x, double y);
+
+    bool hasBounds;
+    bool hasPoint;
+    double x;               // current point
+    double y;
+};
+
+// SVG file in true coordinates, repeated shapes are defined once
+// and used by reference
+class SvgWriter
+{
+public:
+    explicit SvgWriter(const QString &filename);
+    // View box in coordinate units, millimeters per coordinate unit
+    void begin(const Border &viewBox, double millimeters);
+    void beginDefs() { write("<defs>\n"); }
+    void beginGroup(const QString &attributes);
+    void circle(int x, int y, int r, const QString &attributes);
+    static QString color(const QColor &color) { return color.name(); }
+    void end();
+    void endDefs() { write("</defs>\n"); }
+    void endGroup() { write("</g>\n"); }
+    void path(const SvgPath &path, const QString &attributes);
+    void rect(int x, int y, int w, int h, int r, const QString &attributes);
+    void text(int x, int y, const QString &text, const QString &attributes);
+    void use(const QString &id, int x, int y);
+
+private:
+    void write(const QByteArray &data);
+
+    QFile file;
+};
+
+#endif  // SVGWRITER_H
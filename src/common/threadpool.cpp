@@ -0,0 +1,136 @@
+// threadpool.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "threadpool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads): stop(false)
+{
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    condition.notify_all();
+    for (auto &w : workers)
+        w.join();
+}
+
+ThreadPool &ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(int begin, int end,
+                             const std::function<void (int, int)> &function,
+                             int chunkSize)
+{
+    class State
+    {
+    public:
+        int begin;
+        int chunkSize;
+        int chunks;
+        int end;
+        std::atomic<int> done {0};
+        std::atomic<int> next {0};
+        std::condition_variable finished;
+        std::exception_ptr exception;
+        std::function<void (int, int)> function;
+        std::mutex mutex;
+    };
+
+    if (end <= begin)
+        return;
+
+    int length = end - begin;
+    if (chunkSize <= 0)
+        chunkSize = std::max(1, length / (4 * (size() + 1)));
+
+    auto state = std::make_shared<State>();
+    state->begin = begin;
+    state->chunkSize = chunkSize;
+    state->chunks = (length + chunkSize - 1) / chunkSize;
+    state->end = end;
+    state->function = function;
+
+    auto work = [state]() {
+        int n;
+        while ((n = state->next++) < state->chunks) {
+            int first = state->begin + n * state->chunkSize;
+            int last = std::min(first + state->chunkSize, state->end);
+            try {
+                state->function(first, last);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->exception)
+                    state->exception = std::current_exception();
+            }
+            if (++state->done == state->chunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(size(), state->chunks - 1);
+    if (helpers > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < helpers; i++)
+            tasks.push(work);
+    }
+    condition.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->done == state->chunks; });
+    if (state->exception)
+        std::rethrow_exception(state->exception);
+}
+
+void ThreadPool::run()
+{
+    std::function<void ()> task;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stop || !tasks.empty(); });
+            if (stop && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+std::future<void> ThreadPool::submit(const std::function<void ()> &task)
+{
+    auto packagedTask = std::make_shared<std::packaged_task<void ()>>(task);
+    std::future<void> future = packagedTask->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push([packagedTask]() { (*packagedTask)(); });
+    }
+    condition.notify_one();
+
+    return future;
+}
@@ -0,0 +1,42 @@
+// threadpool.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the editors
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads = 0);   // 0: hardware concurrency
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    static ThreadPool &global();
+    // Call function(first, last) for chunks of [begin, end), wait for all.
+    // The calling thread takes chunks too, so nested calls do not deadlock.
+    void parallelFor(int begin, int end,
+                     const std::function<void (int, int)> &function,
+                     int chunkSize = 0);
+    std::future<void> submit(const std::function<void ()> &task);
+    int size() const { return workers.size(); }
+
+private:
+    void run();
+
+    bool stop;
+    std::condition_variable condition;
+    std::mutex mutex;
+    std::queue<std::function<void ()>> tasks;
+    std::vector<std::thread> workers;
+};
+
+#endif  // THREADPOOL_H
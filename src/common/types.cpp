@@ -39,7 +39,7 @@ void Arc::fromJson(const QJsonValue &value)
     spanAngle = object["spanAngle"].toInt();
 }
 
-QJsonObject Arc::toJson()
+QJsonObject Arc::toJson() const
 {
     QJsonObject object
     {
@@ -82,7 +82,7 @@ void Border::fromJson(const QJsonValue &value)
     bottomY = object["bottomY"].toInt();
 }
 
-QJsonObject Border::toJson()
+QJsonObject Border::toJson() const
 {
     QJsonObject object
     {
@@ -123,7 +123,7 @@ void Ellipse::fromJson(const QJsonValue &value)
     h = object["h"].toInt();
 }
 
-QJsonObject Ellipse::toJson()
+QJsonObject Ellipse::toJson() const
 {
     QJsonObject object
     {
@@ -336,7 +336,7 @@ int Line::length() const
     return lround(l);
 }
 
-QJsonObject Line::toJson()
+QJsonObject Line::toJson() const
 {
     QJsonObject object
     {
@@ -371,7 +371,7 @@ void Point::fromJson(const QJsonValue &value)
     y = object["y"].toInt();
 }
 
-QJsonObject Point::toJson()
+QJsonObject Point::toJson() const
 {
     QJsonObject object
     {
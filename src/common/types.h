@@ -24,7 +24,7 @@ public:
     Arc(const QJsonValue &value);
     void clear();
     void fromJson(const QJsonValue &value);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int x;
     int y;
@@ -43,7 +43,7 @@ public:
     Border(const QJsonValue &value);
     void clear();
     void fromJson(const QJsonValue &value);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int leftX;
     int topY;
@@ -60,7 +60,7 @@ public:
     Ellipse(const QJsonValue &value);
     void clear();
     void fromJson(const QJsonValue &value);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int x;
     int y;
@@ -85,7 +85,7 @@ public:
     bool isVertical() const;
     bool join(const Line &line);
     int length() const;
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int x1;
     int y1;
@@ -101,7 +101,11 @@ public:
     Point(const QJsonValue &value);
     void clear();
     void fromJson(const QJsonValue &value);
-    QJsonObject toJson();
+    // Point packed to key of hash containers: x in high 32 bits, y in low 32 bits
+    static qint64 key(int x, int y) { return qint64(quint64(quint32(x)) << 32 | quint32(y)); }
+    static int keyX(qint64 key) { return int(quint32(quint64(key) >> 32)); }
+    static int keyY(qint64 key) { return int(quint32(key)); }
+    QJsonObject toJson() const;
     bool operator ==(const Point &point) const;
     bool operator <(const Point &point) const;
 
@@ -5,8 +5,12 @@
 #include "exceptiondata.h"
 #include "function.h"
 #include "pcbtypes.h"
+#include "pour.h"
+#include "svgwriter.h"
+#include "threadpool.h"
 #include <algorithm>
 #include <cmath>
+#include <map>
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
@@ -17,10 +21,65 @@
 #include <QMessageBox>
 #include <QPainterPath>
 #include <QTextStream>
-#include <set>
+#include <tuple>
 
-Board::Board()
+namespace
 {
+// Border polygon without points does not exist
+QJsonObject borderJson(Polygon &border)
+{
+    if (border.points.empty())
+        return QJsonObject();
+    return border.toJson();
+}
+
+// Insert, erase or replace object of list at key
+template <typename T>
+void applyListChange(std::list<T> &list, int key, const QJsonObject &from,
+                     const QJsonObject &to)
+{
+    auto i = listPosition(list, key);
+
+    if (from.isEmpty())
+        list.insert(i, T(to));
+    else if (to.isEmpty())
+        list.erase(i);
+    else
+        *i = T(to);
+}
+
+// Inserted or erased object moves objects after it
+template <typename T>
+void setChunkDirty(ChunkedVector<T> &vector, const JournalChange &change)
+{
+    if (change.before.isEmpty() || change.after.isEmpty())
+        vector.setDirtyFrom(change.key);
+    else
+        vector.setDirty(change.key);
+}
+
+bool sameSegment(const Segment &s, const Segment &s2)
+{
+    if (s.type != s2.type || s.net != s2.net || s.width != s2.width)
+        return false;
+    if (s.type == Segment::ARC)
+        return s.x0 == s2.x0 && s.y0 == s2.y0 && s.radius == s2.radius &&
+               s.startAngle == s2.startAngle && s.spanAngle == s2.spanAngle;
+    return s.x1 == s2.x1 && s.y1 == s2.y1 && s.x2 == s2.x2 && s.y2 == s2.y2;
+}
+
+bool sameVia(const Via &v, const Via &v2)
+{
+    return v.x == v2.x && v.y == v2.y && v.net == v2.net && v.diameter == v2.diameter &&
+           v.innerDiameter == v2.innerDiameter;
+}
+}
+
+Board::Board():
+    jsonCache({"borderPolygon", "bottomPolygons", "bottomSegments", "elements",
+               "topPolygons", "topSegments", "vias"})
+{
+    attachJournal();
     QDir::setCurrent(QCoreApplication::applicationDirPath());
 
     try {
@@ -42,6 +101,8 @@ void Board::addJumper(const QString &packageName, int x, int y)
     for (auto &p : element.pads)
         p.net = -1;
     elements.push_back(element);
+    journal.record(ELEMENT_OBJECT, elements.size() - 1, QJsonObject(),
+                   elements.back().toJson());
 }
 
 void Board::addPolygon()
@@ -69,6 +130,8 @@ void Board::addPolygon()
         polygon.points.resize(points2.size());
         std::copy(points2.begin(), points2.end(), polygon.points.begin());
         topPolygons.push_back(polygon);
+        journal.record(TOP_POLYGON_OBJECT, topPolygons.size() - 1, QJsonObject(),
+                       polygon.toJson());
     }
     if (layers.edit == BOTTOM_LAYER) {
         polygon.fill = false;
@@ -76,12 +139,16 @@ void Board::addPolygon()
         polygon.points.resize(points2.size());
         std::copy(points2.begin(), points2.end(), polygon.points.begin());
         bottomPolygons.push_back(polygon);
+        journal.record(BOTTOM_POLYGON_OBJECT, bottomPolygons.size() - 1, QJsonObject(),
+                       polygon.toJson());
     }
     if (layers.edit == BORDER_LAYER) {
+        QJsonObject before = borderJson(border);
         border.fill = false;
         border.net = -1;
         border.points.resize(points2.size());
         std::copy(points2.begin(), points2.end(), border.points.begin());
+        journal.record(BORDER_OBJECT, 0, before, border.toJson());
     }
 
     points.clear();
@@ -116,12 +183,20 @@ void Board::addSegmentPoint(int x, int y, int width)
 void Board::addTrack()
 {
     reduceSegments(track);
+    journal.begin("Add track");
     if (layers.edit == TOP_LAYER)
-        for (auto &t : track)
+        for (auto &t : track) {
             topSegments.push_back(t);
+            journal.record(TOP_SEGMENT_OBJECT, topSegments.size() - 1,
+                           QJsonObject(), t.toJson());
+        }
     if (layers.edit == BOTTOM_LAYER)
-        for (auto &t : track)
+        for (auto &t : track) {
             bottomSegments.push_back(t);
+            journal.record(BOTTOM_SEGMENT_OBJECT, bottomSegments.size() - 1,
+                           QJsonObject(), t.toJson());
+        }
+    journal.end();
     track.clear();
     pointNumber = 0;
 }
@@ -136,6 +211,72 @@ void Board::addVia(int x, int y, int diameter, int innerDiameter)
     v.diameter = diameter;
     v.innerDiameter = innerDiameter;
     vias.push_back(v);
+    journal.record(VIA_OBJECT, vias.size() - 1, QJsonObject(), v.toJson());
+}
+
+// Change is applied to board, nets and ratsnest are updated
+void Board::applyChange(const JournalChange &change, bool undo)
+{
+    const QJsonObject &from = undo ? change.after : change.before;
+    const QJsonObject &to = undo ? change.before : change.after;
+    int key = int(change.key);
+
+    switch (change.object) {
+    case BORDER_OBJECT:
+        border.points.clear();
+        if (!to.isEmpty())
+            border.fromJson(to);
+        break;
+    case BOTTOM_POLYGON_OBJECT:
+        applyListChange(bottomPolygons, key, from, to);
+        break;
+    case BOTTOM_SEGMENT_OBJECT:
+        applyListChange(bottomSegments, key, from, to);
+        break;
+    case ELEMENT_OBJECT:
+        if (from.isEmpty()) {
+            elements.insert(elements.begin() + key, Element(to));
+            nets.insertElement(key, elements[key]);
+            ratsnest.setAllDirty();
+        }
+        else if (to.isEmpty()) {
+            nets.removeElement(key, elements[key]);
+            elements.erase(elements.begin() + key);
+            ratsnest.setAllDirty();
+        }
+        else {
+            Element element(to);
+            Element &e = elements[key];
+            element.group = e.group;
+            ratsnest.setElementDirty(e);
+            for (uint i = 0; i < std::max(e.pads.size(), element.pads.size()); i++) {
+                int oldNet = i < e.pads.size() ? e.pads[i].net : -1;
+                int newNet = i < element.pads.size() ? element.pads[i].net : -1;
+                nets.setPadNet(key, i, oldNet, newNet);
+            }
+            e = element;
+            ratsnest.setElementDirty(e);
+        }
+        break;
+    case TOP_POLYGON_OBJECT:
+        applyListChange(topPolygons, key, from, to);
+        break;
+    case TOP_SEGMENT_OBJECT:
+        applyListChange(topSegments, key, from, to);
+        break;
+    case VIA_OBJECT:
+        applyListChange(vias, key, from, to);
+    }
+}
+
+void Board::attachJournal()
+{
+    pourDirty = true;
+    snapshotNetsDirty = true;
+    jsonCache.attach(journal);
+    journal.addListener([this](const JournalChange &change, bool) {
+        setSnapshotDirty(change);
+    });
 }
 
 void Board::clear()
@@ -147,8 +288,49 @@ void Board::clear()
     bottomSegments.clear();
     vias.clear();
     elements.clear();
+    netClasses.clear();
     nets.clear();
     points.clear();
+    ratsnest.clear();
+    journal.clear();
+}
+
+// Operations on copy change elements, segments, vias and router data
+void Board::commit(const Board &copy, const QString &name)
+{
+    journal.begin(name);
+    for (uint i = 0; i < elements.size() && i < copy.elements.size(); i++) {
+        QJsonObject before(elements[i].toJson());
+        if (copy.elements[i].toJson() == before)
+            continue;
+        ratsnest.setElementDirty(elements[i]);
+        elements[i] = copy.elements[i];
+        ratsnest.setElementDirty(elements[i]);
+        recordElement(i, before);
+    }
+    std::list<Segment> before(topSegments);
+    topSegments = copy.topSegments;
+    recordSegments(TOP_SEGMENT_OBJECT, before);
+    before = bottomSegments;
+    bottomSegments = copy.bottomSegments;
+    recordSegments(BOTTOM_SEGMENT_OBJECT, before);
+    std::list<Via> beforeVias(vias);
+    vias = copy.vias;
+    recordVias(beforeVias);
+    journal.end();
+
+    // Not journaled
+    groups = copy.groups;
+    message = copy.message;
+    pointX = copy.pointX;
+    pointY = copy.pointY;
+    routeStats = copy.routeStats;
+    showMessage = copy.showMessage;
+    track = copy.track;
+    trackLines = copy.trackLines;
+    std::copy_n(copy.table[0], rows * columns, table[0]);
+    std::copy_n(copy.trackLine, maxNet, trackLine);
+    std::copy_n(copy.tracks[0][0], 4 * maxNet * maxLine, tracks[0][0]);
 }
 
 void Board::connectJumper(int x, int y)
@@ -157,11 +339,11 @@ void Board::connectJumper(int x, int y)
 
     if (!selectedPad) {
         n = -1;
-        for (auto e : elements) {
+        for (const auto &e : elements) {
             n++;
             if (!e.isJumper)
                 continue;
-            for (auto p : e.pads)
+            for (const auto &p : e.pads)
                 if (p.exist(x, y)) {
                     selectedPad = true;
                     return;
@@ -171,17 +353,22 @@ void Board::connectJumper(int x, int y)
 
     if (selectedPad) {
         int n2 = -1;
-        for (auto e : elements) {
+        for (const auto &e : elements) {
             n2++;
             if (n == n2)
                 continue;
-            for (auto p : e.pads)
+            for (const auto &p : e.pads)
                 if (p.exist(x, y))
                     if (p.net >= 0) {
-                        for (auto &p2 : elements[n].pads)
-                            p2.net = p.net;
+                        QJsonObject before = elements[n].toJson();
+                        for (uint i = 0; i < elements[n].pads.size(); i++) {
+                            nets.setPadNet(n, i, elements[n].pads[i].net, p.net);
+                            ratsnest.setNetDirty(elements[n].pads[i].net);
+                            elements[n].pads[i].net = p.net;
+                        }
+                        ratsnest.setNetDirty(p.net);
+                        recordElement(n, before);
                         selectedPad = false;
-                        getNets();
                         return;
                     }
         }
@@ -229,8 +416,8 @@ void Board::connectPad(int x_, int y_, int width)
         return;
 
     // Find pads
-    for (auto e : elements)
-        for (auto p : e.pads)
+    for (const auto &e : elements)
+        for (const auto &p : e.pads)
             for (int i = 0; i < 2; i++)
                 if (!pointType[i])
                     if (p.exist(x[i], y[i])) {
@@ -306,14 +493,28 @@ void Board::connectPad(int x_, int y_, int width)
         addTrack();
 }
 
+std::unique_ptr<Board> Board::copy() const
+{
+    std::unique_ptr<Board> board(new Board(*this));
+    board->journal = Journal();
+    board->attachJournal();
+    board->progress = nullptr;
+
+    return board;
+}
+
 void Board::deleteJumper(int x, int y)
 {
     for (auto i = elements.begin(); i != elements.end(); ++i) {
         if (!(*i).isJumper)
             continue;
         if ((*i).exist(x, y)) {
+            int number = i - elements.begin();
+            QJsonObject before = (*i).toJson();
+            nets.removeElement(number, *i);
             elements.erase(i);
-            getNets();
+            ratsnest.setAllDirty();
+            journal.record(ELEMENT_OBJECT, number, before, QJsonObject());
             break;
         }
     }
@@ -322,48 +523,67 @@ void Board::deleteJumper(int x, int y)
 void Board::deleteNetSegments(int x, int y)
 {
     int netNumber = -1;
+    int number = 0;
+    int object;
     std::list<Segment> *s = nullptr;
 
-    if (layers.edit == TOP_LAYER)
+    if (layers.edit == TOP_LAYER) {
         s = &topSegments;
+        object = TOP_SEGMENT_OBJECT;
+    }
 
-    if (layers.edit == BOTTOM_LAYER)
+    if (layers.edit == BOTTOM_LAYER) {
         s = &bottomSegments;
+        object = BOTTOM_SEGMENT_OBJECT;
+    }
 
     if (!s)
         return;
 
-    netNumber = deleteSegment(x, y, (*s));
+    journal.begin("Delete net segments");
+    netNumber = deleteSegment(x, y, (*s), object);
     if (netNumber >= 0)
         for (auto i = (*s).begin(); i != (*s).end();) {
-            if ((*i).net == netNumber)
+            if ((*i).net == netNumber) {
+                QJsonObject before = (*i).toJson();
                 i = (*s).erase(i);
-            else
+                journal.record(object, number, before, QJsonObject());
+            }
+            else {
                 ++i;
+                number++;
+            }
         }
+    journal.end();
 }
 
 void Board::deletePolygon(int x, int y)
 {
     if (layers.edit == TOP_LAYER)
-        deletePolygon(x, y, topPolygons);
+        deletePolygon(x, y, topPolygons, TOP_POLYGON_OBJECT);
 
     if (layers.edit == BOTTOM_LAYER)
-        deletePolygon(x, y, bottomPolygons);
+        deletePolygon(x, y, bottomPolygons, BOTTOM_POLYGON_OBJECT);
 
     if (layers.edit == BORDER_LAYER)
-        if (border.hasInnerPoint(x, y))
+        if (border.hasInnerPoint(x, y)) {
+            QJsonObject before = borderJson(border);
             border.points.clear();
+            journal.record(BORDER_OBJECT, 0, before, QJsonObject());
+        }
 }
 
-int Board::deletePolygon(int x, int y, std::list<Polygon> &polygons)
+int Board::deletePolygon(int x, int y, std::list<Polygon> &polygons, int object)
 {
     int netNumber = -1;
+    int number = 0;
 
-    for (auto i = polygons.begin(); i != polygons.end(); ++i)
+    for (auto i = polygons.begin(); i != polygons.end(); ++i, number++)
         if ((*i).hasInnerPoint(x, y)) {
             netNumber = (*i).net;
+            QJsonObject before = (*i).toJson();
             polygons.erase(i);
+            journal.record(object, number, before, QJsonObject());
             return netNumber;
         }
 
@@ -373,18 +593,22 @@ int Board::deletePolygon(int x, int y, std::list<Polygon> &polygons)
 void Board::deleteSegment(int x, int y)
 {
     if (layers.edit == TOP_LAYER)
-        deleteSegment(x, y, topSegments);
+        deleteSegment(x, y, topSegments, TOP_SEGMENT_OBJECT);
 
     if (layers.edit == BOTTOM_LAYER)
-        deleteSegment(x, y, bottomSegments);
+        deleteSegment(x, y, bottomSegments, BOTTOM_SEGMENT_OBJECT);
 }
 
-int Board::deleteSegment(int x, int y, std::list<Segment> &segments)
+int Board::deleteSegment(int x, int y, std::list<Segment> &segments, int object)
 {
-    for (auto i = segments.begin(); i != segments.end(); ++i)
+    int number = 0;
+
+    for (auto i = segments.begin(); i != segments.end(); ++i, number++)
         if ((*i).crossPoint(x, y)) {
             int netNumber = (*i).net;
+            QJsonObject before = (*i).toJson();
             segments.erase(i);
+            journal.record(object, number, before, QJsonObject());
             return netNumber;
         }
 
@@ -393,9 +617,13 @@ int Board::deleteSegment(int x, int y, std::list<Segment> &segments)
 
 void Board::deleteVia(int x, int y)
 {
-    for (auto i = vias.begin(); i != vias.end(); ++i)
+    int number = 0;
+
+    for (auto i = vias.begin(); i != vias.end(); ++i, number++)
         if ((*i).exist(x, y)) {
+            QJsonObject before = (*i).toJson();
             vias.erase(i);
+            journal.record(VIA_OBJECT, number, before, QJsonObject());
             return;
         }
 }
@@ -404,17 +632,22 @@ void Board::disconnectJumper(int x, int y)
 {
     bool isPadExist = false;
 
-    for (auto &e : elements) {
+    for (uint i = 0; i < elements.size(); i++) {
+        Element &e = elements[i];
         if (!e.isJumper)
             continue;
-        for (auto p : e.pads)
+        for (const auto &p : e.pads)
             if (p.exist(x, y))
                 isPadExist = true;
         if (!isPadExist)
             continue;
-        for (auto &p : e.pads)
-            p.net = -1;
-        getNets();
+        QJsonObject before = e.toJson();
+        for (uint j = 0; j < e.pads.size(); j++) {
+            nets.setPadNet(i, j, e.pads[j].net, -1);
+            ratsnest.setNetDirty(e.pads[j].net);
+            e.pads[j].net = -1;
+        }
+        recordElement(i, before);
         break;
     }
 }
@@ -591,10 +824,6 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
         QColor(200, 200, 0), QColor(0, 200, 200), QColor(200, 0, 200),
         QColor(150, 150, 50), QColor(50, 150, 150)
     };
-    bool fill;
-    int n1, n2;
-    int space = polygonSpace;
-    int x1, y1, x2, y2;
     int width = defaultLineWidth;
     QFont serifFont("Times", scale * fontScale * fontSize, QFont::Normal);
     painter.setFont(serifFont);
@@ -605,7 +834,8 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     QPen topPen(topBrush, width * scale, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
     QPen bottomPen(bottomBrush, width * scale, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
     QPen borderPen(borderBrush, 500 * scale, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
-    QPen whitePen(whiteBrush, width * scale, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+
+    pourPolygons();
 
     // Draw border
     if (layers.draw & (1 << BORDER_LAYER)) {
@@ -614,26 +844,10 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     }
 
     // Draw bottom polygons
-    fill = false;
     if (layers.draw & (1 << BOTTOM_POLYGON_LAYER)) {
         painter.setPen(layers.color[BOTTOM_LAYER]);
-        for (auto b : bottomPolygons) {
+        for (auto &b : bottomPolygons)
             b.draw(painter, scale, bottomBrush);
-            if (b.fill)
-                fill = true;
-        }
-    }
-
-    if (fill) {
-        if (layers.draw & (1 << BOTTOM_LAYER)) {
-            drawSegments(bottomSegments, painter, whitePen, width, scale, space);
-            if (layers.edit == BOTTOM_LAYER)
-                drawSegments(track, painter, whitePen, width, scale, space);
-        }
-        if (!(layers.draw & (1 << TOP_VIA_LAYER)) &&
-             (layers.draw & (1 << BOTTOM_VIA_LAYER)))
-                for (auto v : vias)
-                    v.draw(painter, BOTTOM_VIA_LAYER, scale, space);
     }
 
     // Draw bottom solder mask
@@ -649,18 +863,14 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
 
     // Draw vias
     if (!(layers.draw & (1 << TOP_VIA_LAYER)) && (layers.draw & (1 << BOTTOM_VIA_LAYER)))
-        for (auto v : vias)
+        for (const auto &v : vias)
             v.draw(painter, BOTTOM_VIA_LAYER, scale);
 
     // Draw front polygons
-    fill = false;
     if (layers.draw & (1 << TOP_POLYGON_LAYER)) {
         painter.setPen(layers.color[TOP_LAYER]);
-        for (auto t : topPolygons) {
+        for (auto &t : topPolygons)
             t.draw(painter, scale, topBrush);
-            if (t.fill)
-                fill = true;
-        }
     }
 
     ElementDrawingOptions options;
@@ -669,20 +879,6 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     options.fontSize = scale * fontScale * fontSize;
     options.space = 0;
 
-    if (fill) {
-        if (layers.draw & (1 << TOP_LAYER)) {
-            drawSegments(topSegments, painter, whitePen, width, scale, space);
-            if (layers.edit == TOP_LAYER)
-                drawSegments(track, painter, whitePen, width, scale, space);
-        }
-        options.space = space;
-        for (auto e : elements)
-            e.draw(painter, layers, options);
-        if (layers.draw & (1 << TOP_VIA_LAYER))
-            for (auto v : vias)
-                v.draw(painter, TOP_VIA_LAYER, scale, space);
-    }
-
     // Draw top solder mask
     if (layers.draw & (1 << TOP_MASK_LAYER))
         drawSolderMask(painter, TOP_MASK_LAYER, scale);
@@ -695,13 +891,12 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     }
 
     // Draw elements
-    options.space = 0;
-    for (auto e : elements)
+    for (const auto &e : elements)
         e.draw(painter, layers, options);
 
     // Draw vias
     if (layers.draw & (1 << TOP_VIA_LAYER))
-        for (auto v : vias)
+        for (const auto &v : vias)
             v.draw(painter, TOP_VIA_LAYER, scale);
 
     // Draw group
@@ -712,22 +907,13 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
 
     // Draw nets
     if (showNets) {
-        for (auto n : nets) {
-            if (n.number < 0)
-                continue;
-            if (!n.number && !showGroundNets)
+        ratsnest.update(elements, nets, topSegments, bottomSegments, vias);
+        for (auto &r : ratsnest.lines) {
+            if (!r.first && !showGroundNets)
                 continue;
-            painter.setPen(colors[n.number%8]);
-            for (uint i = 0; i < n.pads.size(); i++) {
-                n1 = n.pads[i].x;
-                n2 = n.pads[i].y;
-                x2 = scale * elements[n1].pads[n2].x;
-                y2 = scale * elements[n1].pads[n2].y;
-                if (i)
-                    painter.drawLine(x1, y1, x2, y2);
-                x1 = x2;
-                y1 = y2;
-            }
+            painter.setPen(colors[r.first%8]);
+            for (auto &l : r.second)
+                painter.drawLine(scale * l.x1, scale * l.y1, scale * l.x2, scale * l.y2);
         }
     }
 
@@ -751,7 +937,7 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     //for (uint i = 0; i < pointX.size(); i++)
     //    painter.drawPoint(pointX[i], pointY[i]);
     painter.setPen(QColor(0, 250, 0));
-    for (auto t : track)
+    for (const auto &t : track)
         painter.drawLine(t.x1, t.y1, t.x2, t.y2);
 
     // Draw tracks
@@ -762,13 +948,14 @@ void Board::draw(QPainter &painter, int fontSize, double scale)
     //}
 }
 
+// Copper of layer as manufactured: polygon fills, segments, vias, pads
 void Board::drawSegments(const std::list<Segment> &segments, QPainter &painter,
                          QPen &pen, int width, double scale, int space)
 {
     pen.setWidth(width * scale);
     painter.setPen(pen);
 
-    for (auto s : segments) {
+    for (const auto &s : segments) {
         if (s.width + 2 * space != width) {
             pen.setWidth((s.width + 2 * space) * scale);
             painter.setPen(pen);
@@ -802,10 +989,10 @@ void Board::drawSolderMask(QPainter &painter, int layer, double scale)
     else
         return;
 
-    for (auto e : elements) {
+    for (const auto &e : elements) {
         if (e.onTop != isTopMask)
             continue;
-        for (auto p : e.pads) {
+        for (const auto &p : e.pads) {
             d = scale * p.diameter;
             h = scale * p.height;
             s = scale * solderMaskSwell;
@@ -833,7 +1020,7 @@ void Board::drawSolderMask(QPainter &painter, int layer, double scale)
     }
 
     if (openMaskOnVia)
-        for (auto v : vias) {
+        for (const auto &v : vias) {
             d = scale * v.diameter;
             s = scale * solderMaskSwell;
             d += 2 * s;
@@ -853,47 +1040,34 @@ void Board::errorCheck(QString &text)
 void Board::fillPolygon(int x, int y)
 {
     if (layers.edit == TOP_LAYER)
-        fillPolygon(x, y, topPolygons);
+        fillPolygon(x, y, topPolygons, TOP_POLYGON_OBJECT);
 
     if (layers.edit == BOTTOM_LAYER)
-        fillPolygon(x, y, bottomPolygons);
+        fillPolygon(x, y, bottomPolygons, BOTTOM_POLYGON_OBJECT);
 }
 
-void Board::fillPolygon(int x, int y, std::list<Polygon> &polygons)
+void Board::fillPolygon(int x, int y, std::list<Polygon> &polygons, int object)
 {
-    for (auto i = polygons.begin(); i != polygons.end(); ++i)
+    int number = 0;
+
+    journal.begin("Fill polygon");
+    for (auto i = polygons.begin(); i != polygons.end(); ++i, number++)
         if ((*i).hasInnerPoint(x, y)) {
+            QJsonObject before = (*i).toJson();
             (*i).fill ^= 1;
             if ((*i).fill)
                 (*i).net = 0;
             else
                 (*i).net = -1;
+            journal.record(object, number, before, (*i).toJson());
         }
+    journal.end();
 }
 
 void Board::getNets()
 {
-    std::set<int> netNumbers;
-
-    for (auto e : elements)
-        for (auto p : e.pads)
-            if (p.net >= 0)
-                netNumbers.insert(p.net);
-
-    int size = netNumbers.size();
-    nets.resize(size);
-
-    int num = 0;
-    for (auto n : netNumbers)
-        nets[num++].number = n;
-
-    for (auto &n : nets) {
-        n.pads.clear();
-        for (uint i = 0; i < elements.size(); i++)
-            for (uint j = 0; j < elements[i].pads.size(); j++)
-                if (n.number == elements[i].pads[j].net)
-                    n.pads.push_back(Point(i, j));
-    }
+    nets.build(elements);
+    ratsnest.setAllDirty();
 }
 
 void Board::init()
@@ -920,6 +1094,17 @@ void Board::init()
     polygonSpace = defaultPolygonSpace;
     solderMaskSwell = defaultSolderMaskSwell;
 
+    placer.maxGroupElements = defaultMaxGroupElements;
+    placer.maxNetElements = defaultMaxNetElements;
+
+    router.clearance = defaultClearance;
+    router.groundWidth = defaultPowerWidth;
+    router.maxClearance = defaultPolygonSpace;
+    router.minWidth = defaultMinWidth;
+    router.powerClearance = defaultClearance;
+    router.powerWidth = defaultPowerWidth;
+    router.width = defaultLineWidth;
+
     layers.edit = -1;
 }
 
@@ -1046,7 +1231,10 @@ void Board::moveElement(int x, int y)
         for (uint i = 0; i < element.pads.size(); i++)
             element.pads[i].net = elements[number].pads[i].net;
         element.group = elements[number].group;
+        QJsonObject before = elements[number].toJson();
         elements[number] = element;
+        ratsnest.setElementDirty(element);
+        recordElement(number, before);
         selectedElement = false;
         return;
     }
@@ -1079,7 +1267,10 @@ void Board::moveElement(int number, int x, int y)
     for (uint i = 0; i < element.pads.size(); i++)
         element.pads[i].net = elements[number].pads[i].net;
     element.group = elements[number].group;
+    QJsonObject before = elements[number].toJson();
     elements[number] = element;
+    ratsnest.setElementDirty(element);
+    recordElement(number, before);
 }
 
 void Board::moveGroup()
@@ -1101,6 +1292,7 @@ void Board::moveGroup()
         return;
 
     // Move elements
+    journal.begin("Move group");
     for (auto &e : elements) {
         if (e.onTop != isTop)
             continue;
@@ -1117,9 +1309,13 @@ void Board::moveGroup()
             element.isJumper = isJumper;
             for (uint i = 0; i < element.pads.size(); i++)
                 element.pads[i].net = e.pads[i].net;
+            QJsonObject before = e.toJson();
             e = element;
+            ratsnest.setElementDirty(e);
+            recordElement(&e - elements.data(), before);
         }
     }
+    journal.end();
 }
 
 void Board::moveGroup(int x, int y, double scale)
@@ -1149,6 +1345,62 @@ void Board::noRoundTurn(int x, int y)
 
 }
 
+// Fill polygons whose copper changed, one polygon per task
+// Polygons are hashed and poured only after change of copper
+void Board::pourPolygons()
+{
+    if (!pourDirty)
+        return;
+    pourDirty = false;
+
+    std::vector<std::pair<Polygon*, const Pour*>> dirty;
+    Pour topPour(elements, topSegments, vias, true, polygonSpace);
+    Pour bottomPour(elements, bottomSegments, vias, false, polygonSpace);
+
+    // Fill is not recorded by journal, chunk of changed fill is dirty
+    auto check = [&dirty](std::list<Polygon> &polygons, ChunkedVector<Polygon> &chunks,
+                          const Pour *pour) {
+        int number = 0;
+        for (auto i = polygons.begin(); i != polygons.end(); ++i, number++) {
+            Polygon &p = *i;
+            if (!p.fill) {
+                if (p.fillHash || !p.fillPath.isEmpty())
+                    chunks.setDirty(number);
+                p.fillHash = 0;
+                p.fillPath = QPainterPath();
+                continue;
+            }
+            unsigned long long hash = pour->hash(p);
+            if (hash != p.fillHash) {
+                p.fillHash = hash;
+                chunks.setDirty(number);
+                dirty.push_back(std::make_pair(&p, pour));
+            }
+        }
+    };
+
+    check(topPolygons, snapshotData.topPolygons, &topPour);
+    check(bottomPolygons, snapshotData.bottomPolygons, &bottomPour);
+
+    ThreadPool::global().parallelFor(0, dirty.size(), [&dirty](int first, int last) {
+        for (int i = first; i < last; i++)
+            dirty[i].first->fillPath = dirty[i].second->fill(*dirty[i].first);
+    }, 1);
+}
+
+bool Board::proceed(int done, int total) const
+{
+    return !progress || progress(done, total);
+}
+
+// Sum of minimum spanning tree lengths of nets
+double Board::ratsnestLength()
+{
+    ratsnest.update(elements, nets, topSegments, bottomSegments, vias);
+
+    return ratsnest.length();
+}
+
 void Board::readFile(const QString &filename, QString &text)
 {
     QFile file(filename);
@@ -1159,47 +1411,73 @@ void Board::readFile(const QString &filename, QString &text)
     file.close();
 }
 
-void Board::readJsonFile(const QString &filename, QByteArray &byteArray)
+void Board::readPackageLibrary(const QString &libraryname)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly))
-        throw ExceptionData(filename + " open error");
-    byteArray = file.readAll();
-    file.close();
+    Library::packages().read(libraryname, packagesDirectory);
 }
 
-void Board::readPackageLibrary(const QString &libraryname)
+void Board::recordElement(int number, const QJsonObject &before)
 {
-    QByteArray byteArray;
-    readJsonFile(libraryname, byteArray);
+    journal.record(ELEMENT_OBJECT, number, before, elements[number].toJson());
+}
 
-    QJsonDocument document(QJsonDocument::fromJson(byteArray));
-    if (document.isNull())
-        throw ExceptionData("Package library file read error");
+// Segments with changed nets are recorded
+void Board::recordNets(int object, const std::vector<int> &oldNets)
+{
+    auto &segments = object == TOP_SEGMENT_OBJECT ? topSegments : bottomSegments;
+    int number = 0;
 
-    QJsonObject object = document.object();
+    for (const auto &s : segments) {
+        if (s.net != oldNets[number]) {
+            Segment before(s);
+            before.net = oldNets[number];
+            journal.record(object, number, before.toJson(), s.toJson());
+        }
+        number++;
+    }
+}
 
-    if (object["object"].toString() != "packageLibrary")
-        throw ExceptionData("File is not a package library file");
+void Board::recordSegments(int object, const std::list<Segment> &before)
+{
+    recordList(journal, "Edit segments", object, before,
+               object == TOP_SEGMENT_OBJECT ? topSegments : bottomSegments, sameSegment);
+}
 
-    QJsonArray filenames(object["filenames"].toArray());
+void Board::recordVias(const std::list<Via> &before)
+{
+    recordList(journal, "Edit vias", VIA_OBJECT, before, vias, sameVia);
+}
 
-    for (auto f : filenames) {
-        readJsonFile(packagesDirectory + "/" + f.toString(), byteArray);
-        readPackages(byteArray);
-    }
+bool Board::redo()
+{
+    return journal.redo([this](const JournalChange &change, bool undo) {
+        applyChange(change, undo);
+    });
 }
 
 // Reduce number of wires
-void Board::reduceSegments(std::list<Segment> &segments)
+void Board::reduceSegments(std::list<Segment> &segments, int object)
 {
-    for (auto i = segments.begin(); i != segments.end(); ++i)
+    int number = 0;                     // key of i
+
+    for (auto i = segments.begin(); i != segments.end(); ++i, number++) {
+        int number2 = 0;                // key of j
         for (auto j = segments.begin(); j != i;) {
-            if (joinSegments(*i, *j))
+            Segment before(*i);
+            if (joinSegments(*i, *j)) {
+                if (object >= 0) {
+                    journal.record(object, number, before.toJson(), (*i).toJson());
+                    journal.record(object, number2, (*j).toJson(), QJsonObject());
+                }
                 j = segments.erase(j);
-            else
+                number--;
+            }
+            else {
                 ++j;
+                number2++;
+            }
         }
+    }
 }
 
 bool Board::round45DegreesTurn(std::list<Segment>::iterator it[], int tx, int ty,
@@ -1241,11 +1519,9 @@ bool Board::round45DegreesTurn(std::list<Segment>::iterator it[], int tx, int ty
     else
         ps = &bottomSegments;
 
-    for (int i = 0; i < 2; i++) {
+    // Lines of zero length are erased by roundTurn
+    for (int i = 0; i < 2; i++)
         (*it[i]).reduceLength(tx, ty, minLength);
-        if ((*it[i]).length() == 0)
-            (*ps).erase(it[i]);
-    }
 
     (*ps).push_back(arcSegment);
 
@@ -1281,11 +1557,9 @@ bool Board::round90DegreesTurn(std::list<Segment>::iterator it[], int tx, int ty
     else
         ps = &bottomSegments;
 
-    for (int i = 0; i < 2; i++) {
+    // Lines of zero length are erased by roundTurn
+    for (int i = 0; i < 2; i++)
         (*it[i]).reduceLength(tx, ty, minLength);
-        if ((*it[i]).length() == 0)
-            (*ps).erase(it[i]);
-    }
 
     (*ps).push_back(arcSegment);
 
@@ -1462,27 +1736,36 @@ bool Board::roundJoin(std::list<Segment>::iterator it[])
     return true;
 }
 
+// Joined lines and lines shortened to zero length are erased,
+// arcs are appended. Only changed lines and arcs are recorded.
 void Board::roundTurn(int x, int y, int turningRadius)
 {
     if (layers.edit != TOP_LAYER && layers.edit != BOTTOM_LAYER)
         return;
 
     int lineSize = 0;
+    int number = 0;
+    int numbers[4];                     // keys of lines
     bool isEmpty[4] = {false};
+    bool joined[4] = {false};
     std::list<Segment> *ps = nullptr;
     std::list<Segment>::iterator it[4];
+    std::list<Segment>::iterator lines[4];
+    Segment oldLines[4];
 
     if (layers.edit == TOP_LAYER)
         ps = &topSegments;
     else
         ps = &bottomSegments;
 
-     for (auto i = (*ps).begin(); i != (*ps).end(); ++i) {
+     for (auto i = (*ps).begin(); i != (*ps).end(); ++i, number++) {
         if ((*i).type != Segment::LINE)
             continue;
         if ((*i).crossPoint(x,y)) {
-            if (lineSize < 4)
+            if (lineSize < 4) {
+                numbers[lineSize] = number;
                 it[lineSize++] = i;
+            }
             else
                 return;
         }
@@ -1491,6 +1774,13 @@ void Board::roundTurn(int x, int y, int turningRadius)
     if (lineSize < 2)
         return;
 
+    bool reduced = true;
+    int size = (*ps).size();
+    for (int i = 0; i < lineSize; i++) {
+        lines[i] = it[i];
+        oldLines[i] = *it[i];
+    }
+
     // Reduce lineSize to 2
     if (lineSize > 2) {
         int lineSize2 = lineSize;
@@ -1500,16 +1790,15 @@ void Board::roundTurn(int x, int y, int turningRadius)
                 if (i == j || isEmpty[i] || isEmpty[j])
                     continue;
                 if (joinSegments(*it[i], *it[j])) {
-                    (*ps).erase(it[j]);
+                    joined[j] = true;
                     isEmpty[j] = true;
                     lineSize2--;
                 }
             }
 
-        if (lineSize2 != 2)
-            return;
+        reduced = lineSize2 == 2;
 
-        for (int i = 0; i < lineSize2; i++) {
+        for (int i = 0; reduced && i < lineSize2; i++) {
             if (!isEmpty[i])
                 continue;
             for (int j = i + 1; j < lineSize; j++) {
@@ -1522,13 +1811,27 @@ void Board::roundTurn(int x, int y, int turningRadius)
         }
     }
 
-    if (roundTurn2(it, turningRadius))
-        return;
+    if (reduced && !roundTurn2(it, turningRadius) && !roundJoin(it))
+        roundCrossing(it);
 
-    if (roundJoin(it))
-        return;
+    int erased = 0;
+    int object = ps == &topSegments ? TOP_SEGMENT_OBJECT : BOTTOM_SEGMENT_OBJECT;
 
-    roundCrossing(it);
+    journal.begin("Round turn");
+    for (int i = 0; i < lineSize; i++) {
+        int key = numbers[i] - erased;
+        if (joined[i] || (*lines[i]).length() == 0) {
+            (*ps).erase(lines[i]);
+            journal.record(object, key, oldLines[i].toJson(), QJsonObject());
+            erased++;
+        }
+        else
+            journal.record(object, key, oldLines[i].toJson(), (*lines[i]).toJson());
+    }
+    int key = size - erased;
+    for (auto i = std::prev((*ps).end(), (*ps).size() - key); i != (*ps).end(); ++i, key++)
+        journal.record(object, key, QJsonObject(), (*i).toJson());
+    journal.end();
 }
 
 bool Board::roundTurn2(std::list<Segment>::iterator it[], int turningRadius)
@@ -1580,13 +1883,18 @@ bool Board::segmentNets()
     int x, y;
     int xMin, xMax, xMin2, xMax2;
     int yMin, yMax, yMin2, yMax2;
+    std::vector<int> oldNets;
 
-    reduceSegments(topSegments);
-    reduceSegments(bottomSegments);
+    journal.begin("Segment nets");
+    reduceSegments(topSegments, TOP_SEGMENT_OBJECT);
+    reduceSegments(bottomSegments, BOTTOM_SEGMENT_OBJECT);
+    for (const auto &t : topSegments)
+        oldNets.push_back(t.net);
 
     // Set net number for segment connected to pad
-    for (auto n : nets)
-        for (auto np : n.pads) {
+    for (int n = 0; n < nets.size(); n++)
+        for (auto p = nets.begin(n); p != nets.end(n); ++p) {
+            const Point &np = *p;
             x = elements[np.x].pads[np.y].x;
             y = elements[np.x].pads[np.y].y;
             w = elements[np.x].pads[np.y].width;
@@ -1599,17 +1907,17 @@ bool Board::segmentNets()
                 if (!dx)
                     if (abs(x - t.x1) < w &&
                         ((y + w > t.y1 && y - w < t.y2) || (y + w > t.y2 && y - w < t.y1)))
-                        t.net = n.number;
+                        t.net = nets.number(n);
                 if (!dy)
                     if (abs(y - t.y1) < w &&
                         ((x + w > t.x1 && x - w < t.x2) || (x + w > t.x2 && x - w < t.x1)))
-                        t.net = n.number;
+                        t.net = nets.number(n);
                 if (dx && abs(dx) - abs(dy) < 0.1) {
                     a = double(dy) / (dx);
                     b = t.y1 - a * t.x1;
                     if (((x + w > t.x1 && x - w < t.x2) || (x + w > t.x2 && x - w < t.x1)) &&
                         fabs(y - a * x + b) < w)
-                        t.net = n.number;
+                        t.net = nets.number(n);
                 }
             }
         }
@@ -1617,7 +1925,13 @@ bool Board::segmentNets()
     // Set net number for segment connected to segment
     do {
         newSegments = 0;
-        for (auto i = topSegments.begin(); i != topSegments.end(); ++i) {
+        int number = 0;
+        for (auto i = topSegments.begin(); i != topSegments.end(); ++i, number++) {
+            if (!proceed(number, topSegments.size())) {
+                recordNets(TOP_SEGMENT_OBJECT, oldNets);
+                journal.end();
+                return false;
+            }
             if ((*i).net == -1)
                 continue;
             xMin = (*i).x1;
@@ -1650,6 +1964,8 @@ bool Board::segmentNets()
                     if ((*j).net != -1 && (*j).net != (*i).net) {
                         message = "Segment nets error\n";
                         showMessage = true;
+                        recordNets(TOP_SEGMENT_OBJECT, oldNets);
+                        journal.end();
                         return false;
                     }
                     if ((*j).net == -1) {
@@ -1668,8 +1984,11 @@ bool Board::segmentNets()
         }
     } while (newSegments);
 
+    recordNets(TOP_SEGMENT_OBJECT, oldNets);
+    journal.end();
+
     unconnected = 0;
-    for (auto t : topSegments)
+    for (const auto &t : topSegments)
         if (t.net == -1)
             unconnected++;
 
@@ -1679,6 +1998,77 @@ bool Board::segmentNets()
     return true;
 }
 
+void Board::setSnapshotDirty()
+{
+    pourDirty = true;
+    snapshotNetsDirty = true;
+    snapshotData.bottomPolygons.setAllDirty();
+    snapshotData.bottomSegments.setAllDirty();
+    snapshotData.elements.setAllDirty();
+    snapshotData.topPolygons.setAllDirty();
+    snapshotData.topSegments.setAllDirty();
+    snapshotData.vias.setAllDirty();
+}
+
+void Board::setSnapshotDirty(const JournalChange &change)
+{
+    if (change.object != BORDER_OBJECT)
+        pourDirty = true;
+
+    switch (change.object) {
+    case Journal::allObjects:
+        setSnapshotDirty();
+        break;
+    case BOTTOM_POLYGON_OBJECT:
+        setChunkDirty(snapshotData.bottomPolygons, change);
+        break;
+    case BOTTOM_SEGMENT_OBJECT:
+        setChunkDirty(snapshotData.bottomSegments, change);
+        break;
+    case ELEMENT_OBJECT:
+        setChunkDirty(snapshotData.elements, change);
+        // Pads of element object have numbers and nets only
+        if (change.before.isEmpty() || change.after.isEmpty() ||
+            change.before["pads"] != change.after["pads"])
+            snapshotNetsDirty = true;
+        break;
+    case TOP_POLYGON_OBJECT:
+        setChunkDirty(snapshotData.topPolygons, change);
+        break;
+    case TOP_SEGMENT_OBJECT:
+        setChunkDirty(snapshotData.topSegments, change);
+        break;
+    case VIA_OBJECT:
+        setChunkDirty(snapshotData.vias, change);
+        break;
+    }
+}
+
+// Snapshot of unchanged board shares all chunks. Dirty chunks are
+// copied, see ChunkedVector::update, nets are copied when elements
+// are inserted or erased or nets of pads are changed.
+BoardSnapshot Board::snapshot()
+{
+    BoardSnapshot &s = snapshotData;
+
+    s.openMaskOnVia = openMaskOnVia;
+    s.polygonSpace = polygonSpace;
+    s.solderMaskSwell = solderMaskSwell;
+    s.border = border;
+    s.bottomPolygons.update(bottomPolygons);
+    s.bottomSegments.update(bottomSegments);
+    s.elements.update(elements);
+    s.topPolygons.update(topPolygons);
+    s.topSegments.update(topSegments);
+    s.vias.update(vias);
+    if (snapshotNetsDirty || !s.nets) {
+        s.nets = std::make_shared<const NetIndex>(nets);
+        snapshotNetsDirty = false;
+    }
+
+    return s;
+}
+
 void Board::turnElement(int x, int y, int direction)
 {
     enum ElementOrientation {UP, RIGHT, DOWN, LEFT};
@@ -1691,6 +2081,7 @@ void Board::turnElement(int x, int y, int direction)
     QString packageName;
     QString reference;
 
+    journal.begin("Turn element");
     for (auto &e : elements)
         if (e.exist(x, y)) {
             refX = e.refX;
@@ -1716,8 +2107,12 @@ void Board::turnElement(int x, int y, int direction)
             element.isJumper = isJumper;
             for (uint i = 0; i < element.pads.size(); i++)
                 element.pads[i].net = e.pads[i].net;
+            QJsonObject before = e.toJson();
             e = element;
+            ratsnest.setElementDirty(e);
+            recordElement(&e - elements.data(), before);
         }
+    journal.end();
 }
 
 int Board::turnNumber(int x0, int y0, int x, int y)
@@ -1742,6 +2137,241 @@ int Board::turnNumber(int x0, int y0, int x, int y)
     return turn45Degrees[dx+1][dy+1];
 }
 
+bool Board::undo()
+{
+    return journal.undo([this](const JournalChange &change, bool undo) {
+        applyChange(change, undo);
+    });
+}
+
+// Comma separated values, one net per line
+void Board::writeRouteStats(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        throw ExceptionData(filename + " open error");
+
+    QTextStream out(&file);
+    out << "net,pads,connected,length,bends,vias,time\n";
+    for (auto &s : routeStats)
+        out << s.net << "," << s.pads << "," << int(s.connected) << "," << s.length << ","
+            << s.bends << "," << s.vias << "," << QString::number(s.time, 'f', 3) << "\n";
+    file.close();
+}
+
+// Coordinates are in micrometers. Pad and via shapes are defined once,
+// segments of same width are one path of layer.
+void Board::writeSVG(const QString &filename, int fontSize)
+{
+    constexpr int borderLineWidth = 100;
+    constexpr int margin = 1000;
+    constexpr int packageLineWidth = 150;
+    const int textSize = fontScale * fontSize;
+    bool hasViewBox = false;
+    Border viewBox(0, 0, 0, 0);
+    SvgPath borderPath;
+    SvgPath holePath;
+    SvgPath padBounds;
+    SvgPath textBounds;
+    SvgPath packagePaths[2];                    // bottom, top
+    SvgPath polygonPaths[2];
+    std::map<int, SvgPath> segmentPaths[2];     // width, path
+    std::map<std::tuple<int, int, int>, QString> shapes;   // width, height, radius; id
+
+    pourPolygons();
+
+    auto shape = [&shapes, &padBounds](int x, int y, int w, int h, int r) {
+        padBounds.line(x - w / 2, y - h / 2, x + w / 2, y + h / 2);
+        auto key = std::make_tuple(w, h, std::min(r, std::min(w, h) / 2));
+        auto i = shapes.find(key);
+        if (i == shapes.end())
+            i = shapes.emplace(key, "p" + QString::number(shapes.size())).first;
+        return i->second;
+    };
+
+    // Swell of solder mask is added to each side
+    auto padShape = [&shape](const Pad &p, int swell) {
+        int d = p.diameter;
+        int h = p.height;
+        int w = p.width;
+        if (p.orientation == Element::RIGHT)
+            std::swap(w, h);
+        if (h == 0 || w == 0) {
+            h = d;
+            w = d;
+        }
+        return shape(p.x, p.y, w + 2 * swell, h + 2 * swell, d > 0 ? d / 2 + swell : 0);
+    };
+
+    for (uint i = 0; i < border.points.size(); i++) {
+        const Point &p1 = border.points[i];
+        const Point &p2 = border.points[(i + 1) % border.points.size()];
+        borderPath.line(p1.x, p1.y, p2.x, p2.y);
+    }
+
+    for (int top = 0; top < 2; top++) {
+        for (auto &p : top ? topPolygons : bottomPolygons)
+            if (p.fill)
+                polygonPaths[top].addPath(p.fillPath);
+        for (auto &s : top ? topSegments : bottomSegments) {
+            SvgPath &path = segmentPaths[top][s.width];
+            if (s.type == Segment::ARC)
+                path.arc(s.x0, s.y0, s.radius, s.radius, s.startAngle, s.spanAngle);
+            else
+                path.line(s.x1, s.y1, s.x2, s.y2);
+        }
+    }
+
+    for (auto &e : elements) {
+        for (auto &l : e.lines)
+            packagePaths[e.onTop].line(l.x1, l.y1, l.x2, l.y2);
+        for (auto &el : e.ellipses)
+            packagePaths[e.onTop].ellipse(el.x, el.y, el.w / 2., el.h / 2.);
+        for (auto &p : e.pads) {
+            padShape(p, 0);
+            if (p.innerDiameter > 0)
+                holePath.ellipse(p.x, p.y, p.innerDiameter / 2., p.innerDiameter / 2.);
+        }
+        textBounds.line(e.centerX, e.border.topY - 2 * textSize,
+                        e.centerX, e.border.bottomY + 2 * textSize);
+    }
+
+    for (auto &v : vias) {
+        shape(v.x, v.y, v.diameter, v.diameter, v.diameter / 2);
+        if (v.innerDiameter > 0)
+            holePath.ellipse(v.x, v.y, v.innerDiameter / 2., v.innerDiameter / 2.);
+    }
+
+    borderPath.unite(viewBox, hasViewBox);
+    padBounds.unite(viewBox, hasViewBox);
+    textBounds.unite(viewBox, hasViewBox);
+    for (int top = 0; top < 2; top++) {
+        packagePaths[top].unite(viewBox, hasViewBox);
+        polygonPaths[top].unite(viewBox, hasViewBox);
+        for (auto &s : segmentPaths[top])
+            s.second.unite(viewBox, hasViewBox);
+    }
+    viewBox = Border(viewBox.leftX - margin, viewBox.topY - margin,
+                     viewBox.rightX + margin, viewBox.bottomY + margin);
+
+    // Shapes of mask are defined before defs are written
+    for (auto &e : elements)
+        for (auto &p : e.pads)
+            padShape(p, solderMaskSwell);
+    for (auto &v : vias) {
+        int d = v.diameter + 2 * solderMaskSwell;
+        shape(v.x, v.y, d, d, d / 2);
+    }
+
+    SvgWriter svg(filename);
+    svg.begin(viewBox, 0.001);
+
+    svg.beginDefs();
+    for (auto &s : shapes) {
+        int w = std::get<0>(s.first);
+        int h = std::get<1>(s.first);
+        svg.rect(-w / 2, -h / 2, w, h, std::get<2>(s.first), "id=\"" + s.second + "\"");
+    }
+    svg.endDefs();
+
+    auto beginLayer = [this, &svg](int layer, const QString &attributes) {
+        QString color = SvgWriter::color(layers.color[layer]);
+        svg.beginGroup("id=\"" + layerNameString[layer] + "\" fill=\"" + color +
+                       "\" stroke=\"" + color + "\"" + attributes);
+    };
+
+    for (int top = 0; top < 2; top++) {
+        int layer = top ? TOP_LAYER : BOTTOM_LAYER;
+        int maskLayer = top ? TOP_MASK_LAYER : BOTTOM_MASK_LAYER;
+        int polygonLayer = top ? TOP_POLYGON_LAYER : BOTTOM_POLYGON_LAYER;
+
+        // Mask is below copper, as drawn by editor
+        if (layers.draw & (1 << maskLayer)) {
+            beginLayer(maskLayer, " stroke=\"none\"");
+            for (auto &e : elements)
+                for (auto &p : e.pads)
+                    if (p.innerDiameter > 0 || e.onTop == top)
+                        svg.use(padShape(p, solderMaskSwell), p.x, p.y);
+            if (openMaskOnVia)
+                for (auto &v : vias) {
+                    int d = v.diameter + 2 * solderMaskSwell;
+                    svg.use(shape(v.x, v.y, d, d, d / 2), v.x, v.y);
+                }
+            svg.endGroup();
+        }
+
+        if (!(layers.draw & (1 << layer)))
+            continue;
+        beginLayer(layer, "");
+        if (layers.draw & (1 << polygonLayer))
+            svg.path(polygonPaths[top], "stroke=\"none\" fill-rule=\"evenodd\"");
+        for (auto &s : segmentPaths[top])
+            svg.path(s.second, "fill=\"none\" stroke-width=\"" + QString::number(s.first) +
+                     "\" stroke-linecap=\"round\" stroke-linejoin=\"round\"");
+        for (auto &v : vias)
+            svg.use(shape(v.x, v.y, v.diameter, v.diameter, v.diameter / 2), v.x, v.y);
+        for (auto &e : elements)
+            for (auto &p : e.pads)
+                if (p.innerDiameter > 0 || e.onTop == top)
+                    svg.use(padShape(p, 0), p.x, p.y);
+        svg.endGroup();
+    }
+
+    svg.path(holePath, "fill=\"#ffffff\" stroke=\"none\"");
+
+    for (int top = 0; top < 2; top++) {
+        int nameLayer = top ? TOP_NAME_LAYER : BOTTOM_NAME_LAYER;
+        int packageLayer = top ? TOP_PACKAGE_LAYER : BOTTOM_PACKAGE_LAYER;
+        int pasteLayer = top ? TOP_PASTE_LAYER : BOTTOM_PASTE_LAYER;
+        int referenceLayer = top ? TOP_REFERENCE_LAYER : BOTTOM_REFERENCE_LAYER;
+        int silkLayer = top ? TOP_SILK_LAYER : BOTTOM_SILK_LAYER;
+        QString textAttributes = " stroke=\"none\" font-family=\"Times\" font-size=\"" +
+                                 QString::number(textSize) +
+                                 "\" text-anchor=\"middle\" dominant-baseline=\"middle\"";
+
+        // Paste is on pads of surface mounted elements
+        if (layers.draw & (1 << pasteLayer)) {
+            beginLayer(pasteLayer, " stroke=\"none\"");
+            for (auto &e : elements)
+                if (e.onTop == top)
+                    for (auto &p : e.pads)
+                        if (p.innerDiameter == 0)
+                            svg.use(padShape(p, 0), p.x, p.y);
+            svg.endGroup();
+        }
+
+        // Silk has lines of package, as gerber files
+        for (int l : {silkLayer, packageLayer})
+            if (layers.draw & (1 << l))
+                svg.path(packagePaths[top], "id=\"" + layerNameString[l] +
+                         "\" fill=\"none\" stroke=\"" + SvgWriter::color(layers.color[l]) +
+                         "\" stroke-width=\"" + QString::number(packageLineWidth) + "\"");
+
+        // Name is below element, reference is above
+        if (layers.draw & (1 << nameLayer)) {
+            beginLayer(nameLayer, textAttributes);
+            for (auto &e : elements)
+                if (e.onTop == top)
+                    svg.text(e.centerX, e.border.bottomY + 7 * textSize / 10, e.name, "");
+            svg.endGroup();
+        }
+        if (layers.draw & (1 << referenceLayer)) {
+            beginLayer(referenceLayer, textAttributes);
+            for (auto &e : elements)
+                if (e.onTop == top)
+                    svg.text(e.centerX, e.border.topY - 7 * textSize / 10, e.reference, "");
+            svg.endGroup();
+        }
+    }
+
+    if (layers.draw & (1 << BORDER_LAYER))
+        svg.path(borderPath, "fill=\"none\" stroke=\"" +
+                 SvgWriter::color(layers.color[BORDER_LAYER]) + "\" stroke-width=\"" +
+                 QString::number(borderLineWidth) + "\"");
+
+    svg.end();
+}
+
 /*
 void Board::addDevice(int nameID, int x, int y)
 {
@@ -5,13 +5,20 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "boardsnapshot.h"
 #include "element.h"
+#include "journal.h"
+#include "jsoncache.h"
 #include "layers.h"
+#include "netindex.h"
 #include "pcbtypes.h"
+#include "ratsnest.h"
 #include "router.h"
+#include "routestrategy.h"
 #include "text.h"
 #include "track.h"
 #include <functional>
+#include <memory>
 #include <QByteArray>
 
 const QString packagesDirectory = "../../../library/packages";
@@ -22,6 +29,9 @@ typedef std::list<Segment> Track;
 class Board
 {
 public:
+    // Long operation reports done of total steps, false: operation is cancelled
+    typedef std::function<bool (int done, int total)> ProgressFunction;
+
     static constexpr int fontScale = 100;
     static constexpr int rows = 24;
     static constexpr int columns = 24;
@@ -32,10 +42,22 @@ public:
     static constexpr int maxData = 8 * maxLine * maxNet;
     static constexpr int maxStep = 2 * (rows + columns);
     static constexpr int maxTurn = maxStep;
+    static constexpr int defaultClearance = 300;
     static constexpr int defaultLineWidth = 700;
+    static constexpr int defaultMaxGroupElements = 12;
+    static constexpr int defaultMaxNetElements = 16;
+    static constexpr int defaultMinWidth = 200;
     static constexpr int defaultPolygonSpace = 1000;
+    static constexpr int defaultPowerWidth = 1000;
     static constexpr int defaultSolderMaskSwell = 50;
 
+    // Journal objects, key: index in container
+    enum JournalObject
+    {
+        BORDER_OBJECT, BOTTOM_POLYGON_OBJECT, BOTTOM_SEGMENT_OBJECT, ELEMENT_OBJECT,
+        TOP_POLYGON_OBJECT, TOP_SEGMENT_OBJECT, VIA_OBJECT
+    };
+
     Board();
     void addJumper(const QString &packageName, int x, int y);
     void addLineToTrack(double track[][4], int &trackLength,
@@ -46,26 +68,34 @@ public:
     void addToGroup(Group &group, int n1, int n2, int &groupNumber);
     void addTrack();
     void addVia(int x, int y, int diameter, int innerDiameter);
+    void applyChange(const JournalChange &change, bool undo);
     void clear();
+    // Changes of copy of unchanged board are one command
+    void commit(const Board &copy, const QString &name);
     int compareLine(int greater, int *lineIndex, int lines,
                     int coordinate, double value);
+    // Each strategy routes copy of board, message shows statistics.
+    // Result: number of strategy connecting most nets in least time.
+    int compareRouteStrategies(const Via &via, int turningRadius);
     void connectJumper(int x, int y);
     void connectPadCenter(double track[][4], int &trackLength);
     void connectPad(int x_, int y_, int width);
+    // Board data for operation on other thread, journal of copy is empty
+    std::unique_ptr<Board> copy() const;
     void createGroups();
     void deleteJumper(int x, int y);
     void deleteNetSegments(int x, int y);
     void deletePolygon(int x, int y);
-    int deletePolygon(int x, int y, std::list<Polygon> &polygons);
+    int deletePolygon(int x, int y, std::list<Polygon> &polygons, int object);
     void deleteSegment(int x, int y);
-    int deleteSegment(int x, int y, std::list<Segment> &segments);
+    int deleteSegment(int x, int y, std::list<Segment> &segments, int object);
     void deleteVia(int x, int y);
     void disconnectJumper(int x, int y);
     void draw(QPainter &painter, int fontSize, double scale);
     void errorCheck(QString &text);
     void extendSpace(int netNumber);
     void fillPolygon(int x, int y);
-    void fillPolygon(int x, int y, std::list<Polygon> &polygons);
+    void fillPolygon(int x, int y, std::list<Polygon> &polygons, int object);
     void findTableBorder();
     void fromNetlist(const QByteArray &array);
     void fromJson(const QByteArray &array);
@@ -97,21 +127,26 @@ public:
                                double &y1, double &x2, double x);
     bool nearestVerticalLine(int side, int index, double &x1,
                              double &y1, double &y2, double y);
-    int netLength(const Element &element1, const Element &element2);
+    int netLength(const Element &element1, const Element &element2,
+                  int offsetX = 0, int offsetY = 0) const;
     bool nextCellPoint(int row, int col, int direction);
     void noRoundTurn(int x, int y);
     void orderTrackLines(double track[][4], int &trackLength);
-    int packageSpace(const Element &element1, const Element &element2);
-    int padSpace(const Element &element1, const Element &element2);
+    int packageSpace(const Element &element1, const Element &element2,
+                     int offsetX = 0, int offsetY = 0) const;
+    int padSpace(const Element &element1, const Element &element2,
+                 int offsetX = 0, int offsetY = 0) const;
     void place();
     void placeElements();
     void placeGroup(const Group &group, int refX, int refY);
     void placePadsToTable();
+    void pourPolygons();
+    double ratsnestLength();
+    bool redo();
     void readFile(const QString &filename, QString &text);
-    void readJsonFile(const QString &filename, QByteArray &byteArray);
     void readPackageLibrary(const QString &libraryname);
-    void readPackages(const QByteArray &byteArray);
-    void reduceSegments(std::list<Segment> &segments);
+    // object >= 0: segments of board are recorded as object
+    void reduceSegments(std::list<Segment> &segments, int object = -1);
     void reduceTrack(double track[][4], int &trackLength);
     void removeUnconnectedLines(double track[][4], int &trackLength,
                                 int *netPadsRow, int *netPadsCol, int netPadsLength);
@@ -123,16 +158,31 @@ public:
     void setPadSteps(int padSteps[][maxPad], int netPad, int netPadsLength,
                      int *netPadsRow, int *netPadsCol);
     void setRouteBorder();
+    // Data not recorded by journal is changed
+    void setSnapshotDirty();
     void setTrack(double track[][4], int &trackLength,
                   int netPadsLength, int *netPadsRow, int *netPadsCol);
     void setTurnSteps(int padSteps[][maxPad], int padTurns[][maxPad], int netPad,
                       int netPadsLength, int *netPadsRow, int *netPadsCol);
+    // Nets without segments are routed on edit layer or on both layers
+    // with vias if via diameter > 0. Result: number of connected nets.
+    int shapeRoute(const Via &via, int turningRadius,
+                   const RouteStrategy &strategy = RouteStrategy());
+    // Changed chunks are copied, other chunks are shared with last snapshot
+    BoardSnapshot snapshot();
     void sortLineIndex();
     bool step(int row, int col, int direction);
     int tableRoute();
-    QJsonObject toJson();
+    QJsonObject toJson() const;
+    // File data, sections not changed since last call are not serialized again
+    QByteArray toJsonData();
     void turnElement(int x, int y, int direction);
+    bool undo();
     int waveRoute();
+    // Statistics of nets of last shape route
+    void writeRouteStats(const QString &filename) const;
+    // Visible layers, text height: font size of editor
+    void writeSVG(const QString &filename, int fontSize);
 
     bool fillPads;
     bool openMaskOnVia;
@@ -156,11 +206,17 @@ public:
     Element element;
     Group group;
     Groups groups;
+    Journal journal;
+    JsonCache jsonCache;
     Layers layers;
+    NetClasses netClasses;
+    NetIndex nets;
     Placer placer;
     Point point;
     Polygon border;
     Polygon polygon;
+    ProgressFunction progress;
+    Ratsnest ratsnest;
     QRect groupBorder;
     QString message;
     QString packageName;
@@ -187,7 +243,7 @@ public:
     std::list<Segment> bottomSegments;
     std::list<Via> vias;
     std::vector<Element> elements;
-    std::vector<Net> nets;
+    std::vector<RouteStats> routeStats;     // nets of last shape route
     std::vector<Point> points;
     std::vector<Point> points2;
 
@@ -196,9 +252,16 @@ public:
     std::vector<int> pointY;
 
 private:
+    void attachJournal();
     void drawSegments(const std::list<Segment> &segments, QPainter &painter,
                       QPen &pen, int width, double scale, int space = 0);
     void drawSolderMask(QPainter &painter, int layer, double scale);
+    QJsonObject optionsJson() const;
+    bool proceed(int done, int total) const;
+    void recordElement(int number, const QJsonObject &before);
+    void recordNets(int object, const std::vector<int> &oldNets);
+    void recordSegments(int object, const std::list<Segment> &before);
+    void recordVias(const std::list<Via> &before);
     bool round45DegreesTurn(std::list<Segment>::iterator it[], int tx, int ty,
                             int minTurn, int maxTurn, int turningRadius);
     bool round90DegreesTurn(std::list<Segment>::iterator it[], int tx, int ty,
@@ -206,7 +269,13 @@ private:
     bool roundCrossing(std::list<Segment>::iterator it[]);
     bool roundJoin(std::list<Segment>::iterator it[]);
     bool roundTurn2(std::list<Segment>::iterator it[], int turningRadius);
+    QJsonValue sectionJson(int object) const;
+    void setSnapshotDirty(const JournalChange &change);
     int turnNumber(int x0, int y0, int x, int y);
+
+    bool pourDirty;                 // copper or polygons are changed since pour
+    bool snapshotNetsDirty;
+    BoardSnapshot snapshotData;     // last snapshot
 };
 
 #endif  // BOARD_H
@@ -0,0 +1,77 @@
+// boardjob.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "boardjob.h"
+#include "exceptiondata.h"
+#include <chrono>
+
+BoardJob::BoardJob(Board &board):
+    boardChanged(false), running(false), result(0), cancelled(false),
+    donePercent(0), board(board)
+{
+    board.journal.addListener([this](const JournalChange &, bool) {
+        boardChanged = true;
+    });
+}
+
+BoardJob::~BoardJob()
+{
+    if (running) {
+        cancelled = true;
+        future.wait();
+    }
+}
+
+bool BoardJob::finish(QString &text)
+{
+    if (!running)
+        return true;
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    running = false;
+    std::unique_ptr<Board> copy(std::move(work));
+    future.get();
+
+    if (cancelled) {
+        text = jobName + ": cancelled";
+        return true;
+    }
+    if (boardChanged) {
+        text = jobName + ": board is changed, result is dropped";
+        return true;
+    }
+
+    board.commit(*copy, jobName);
+    text = jobName + ": done";
+    if (doneFunction)
+        doneFunction(result);
+
+    return true;
+}
+
+// Own thread: pool threads stay free for short tasks of editor
+void BoardJob::start(const QString &name, const Function &function,
+                     const DoneFunction &done)
+{
+    if (running)
+        throw ExceptionData(jobName + " is running");
+
+    boardChanged = false;
+    cancelled = false;
+    donePercent = 0;
+    doneFunction = done;
+    jobName = name;
+    result = 0;
+    work = board.copy();
+    work->progress = [this](int done, int total) {
+        donePercent = total > 0 ? int(100LL * done / total) : 0;
+        return !cancelled;
+    };
+
+    Board *copy = work.get();
+    future = std::async(std::launch::async, [this, copy, function]() {
+        result = function(*copy);
+    });
+    running = true;
+}
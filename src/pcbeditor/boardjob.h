@@ -0,0 +1,53 @@
+// boardjob.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef BOARDJOB_H
+#define BOARDJOB_H
+
+#include "board.h"
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
+// Long operation of board on worker thread. Operation changes copy of
+// board, so editor stays interactive. Changes of copy are committed
+// as one journal command, they are dropped if board is changed while
+// operation runs. Cancelled operation stops at next progress report.
+// Used by GUI thread.
+class BoardJob
+{
+public:
+    typedef std::function<void (int result)> DoneFunction;
+    typedef std::function<int (Board &board)> Function;
+
+    explicit BoardJob(Board &board);
+    ~BoardJob();
+    BoardJob(const BoardJob &) = delete;
+    BoardJob &operator=(const BoardJob &) = delete;
+    void cancel() { cancelled = true; }
+    // Ended operation is committed or dropped, false: operation runs.
+    // Exception of operation is thrown.
+    bool finish(QString &text);
+    bool isRunning() const { return running; }
+    const QString &name() const { return jobName; }
+    int percent() const { return donePercent; }
+    // Done function is called by finish after commit
+    void start(const QString &name, const Function &function,
+               const DoneFunction &done = nullptr);
+
+private:
+    bool boardChanged;
+    bool running;
+    int result;
+    std::atomic<bool> cancelled;
+    std::atomic<int> donePercent;
+    Board &board;
+    DoneFunction doneFunction;
+    QString jobName;
+    std::future<void> future;
+    std::unique_ptr<Board> work;
+};
+
+#endif  // BOARDJOB_H
@@ -0,0 +1,29 @@
+// boardsnapshot.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "boardsnapshot.h"
+#include "layers.h"
+#include "pour.h"
+#include <QPainterPath>
+
+void BoardSnapshot::drawCopper(QPainter &painter, int layer, const QBrush &brush) const
+{
+    bool top = layer == TOP_LAYER;
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+
+    for (auto &p : top ? topPolygons : bottomPolygons)
+        if (p.fill)
+            painter.fillPath(p.fillPath, brush);
+
+    for (auto &s : top ? topSegments : bottomSegments)
+        Pour::addSegment(path, s, 0);
+    for (auto &v : vias)
+        Pour::addVia(path, v, 0);
+    for (auto &e : elements)
+        for (auto &p : e.pads)
+            if (p.innerDiameter > 0 || e.onTop == top)
+                Pour::addPad(path, p, 0);
+
+    painter.fillPath(path, brush);
+}
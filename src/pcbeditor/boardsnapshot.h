@@ -0,0 +1,39 @@
+// boardsnapshot.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef BOARDSNAPSHOT_H
+#define BOARDSNAPSHOT_H
+
+#include "chunkedvector.h"
+#include "element.h"
+#include "netindex.h"
+#include "pcbtypes.h"
+#include "track.h"
+#include <QBrush>
+#include <QPainter>
+#include <memory>
+
+// Board data for analysis and export on other threads. Snapshot is
+// not changed by later edits of board, unchanged chunks of containers
+// are shared with other snapshots.
+class BoardSnapshot
+{
+public:
+    BoardSnapshot(): openMaskOnVia(false), polygonSpace(0), solderMaskSwell(0) {}
+    void drawCopper(QPainter &painter, int layer, const QBrush &brush) const;
+
+    bool openMaskOnVia;
+    int polygonSpace;
+    int solderMaskSwell;
+    Polygon border;
+    ChunkedVector<Polygon> bottomPolygons;
+    ChunkedVector<Segment> bottomSegments;
+    ChunkedVector<Element> elements;
+    ChunkedVector<Polygon> topPolygons;
+    ChunkedVector<Segment> topSegments;
+    ChunkedVector<Via> vias;
+    std::shared_ptr<const NetIndex> nets;
+};
+
+#endif  // BOARDSNAPSHOT_H
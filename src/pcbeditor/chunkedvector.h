@@ -0,0 +1,114 @@
+// chunkedvector.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef CHUNKEDVECTOR_H
+#define CHUNKEDVECTOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Read only sequence of shared immutable chunks. Copy shares chunks,
+// so copy is cheap and copied sequence is not changed by update.
+// Update copies only chunks marked dirty from edited container.
+// Update is not O(1): vector is read at dirty chunks only, but list is
+// walked to its last dirty chunk, and insert or erase makes all chunks
+// after it dirty.
+template <typename Type>
+class ChunkedVector
+{
+public:
+    static constexpr int chunkSize = 64;
+
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Type value_type;
+        typedef int difference_type;
+        typedef const Type *pointer;
+        typedef const Type &reference;
+
+        Iterator(const ChunkedVector *vector, int index): index(index), vector(vector) {}
+        const Type &operator*() const { return (*vector)[index]; }
+        const Type *operator->() const { return &(*vector)[index]; }
+        Iterator &operator++() { index++; return *this; }
+        bool operator==(const Iterator &iterator) const { return index == iterator.index; }
+        bool operator!=(const Iterator &iterator) const { return index != iterator.index; }
+
+    private:
+        int index;
+        const ChunkedVector *vector;
+    };
+
+    ChunkedVector(): length(0) {}
+    Iterator begin() const { return Iterator(this, 0); }
+    bool empty() const { return !length; }
+    Iterator end() const { return Iterator(this, length); }
+    void setAllDirty() { setDirtyFrom(0); }
+    // Chunk of object at index is changed
+    void setDirty(int index);
+    // Objects from index are inserted, erased or moved
+    void setDirtyFrom(int index);
+    int size() const { return length; }
+    // Container has begin, end and size, it is read in order
+    template <typename Container>
+    void update(const Container &container);
+    const Type &operator[](int index) const
+        { return (*chunks[index / chunkSize])[index % chunkSize]; }
+
+private:
+    typedef std::shared_ptr<const std::vector<Type>> Chunk;
+
+    int length;
+    std::vector<char> dirty;
+    std::vector<Chunk> chunks;
+};
+
+template <typename Type>
+void ChunkedVector<Type>::setDirty(int index)
+{
+    uint chunk = std::max(index, 0) / chunkSize;
+    if (chunk < dirty.size())
+        dirty[chunk] = true;
+}
+
+template <typename Type>
+void ChunkedVector<Type>::setDirtyFrom(int index)
+{
+    uint chunk = std::max(index, 0) / chunkSize;
+    if (chunk < dirty.size())
+        std::fill(dirty.begin() + chunk, dirty.end(), true);
+}
+
+// Clean chunk of equal size is kept and not read, new chunks are dirty
+template <typename Type>
+template <typename Container>
+void ChunkedVector<Type>::update(const Container &container)
+{
+    int newLength = container.size();
+    int newChunks = (newLength + chunkSize - 1) / chunkSize;
+
+    if (newLength == length && std::find(dirty.begin(), dirty.end(), true) == dirty.end())
+        return;
+
+    dirty.resize(newChunks, true);
+    chunks.resize(newChunks);
+    auto i = container.begin();
+    int position = 0;           // index of i
+    for (int c = 0; c < newChunks; c++) {
+        int n = std::min(chunkSize, newLength - c * chunkSize);
+        if (!dirty[c] && chunks[c] && int(chunks[c]->size()) == n)
+            continue;
+        std::advance(i, c * chunkSize - position);
+        auto last = std::next(i, n);
+        chunks[c] = std::make_shared<const std::vector<Type>>(i, last);
+        dirty[c] = false;
+        i = last;
+        position = c * chunkSize + n;
+    }
+    length = newLength;
+}
+
+#endif  // CHUNKEDVECTOR_H
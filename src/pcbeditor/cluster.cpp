@@ -0,0 +1,188 @@
+// cluster.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "cluster.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+void Cluster::clear()
+{
+    clusters.clear();
+    edges.clear();
+    padsNumber.clear();
+}
+
+// Nets with more than maxNetElements elements (power) are not edges
+void Cluster::init(const std::vector<Element> &elements, const NetIndex &nets,
+                   int maxNetElements)
+{
+    std::unordered_map<unsigned long long, double> weights;
+    std::vector<int> netElements;
+
+    clear();
+
+    for (auto &e : elements)
+        padsNumber.push_back(e.pads.size());
+
+    // Net of n elements: clique with edge weight 1 / (n - 1)
+    for (int i = 0; i < nets.size(); i++) {
+        if (nets.number(i) <= 0)    // ground
+            continue;
+        netElements.clear();
+        for (auto p = nets.begin(i); p != nets.end(i); ++p)
+            if (netElements.empty() || netElements.back() != p->x)
+                netElements.push_back(p->x);
+        int n = netElements.size();
+        if (n < 2 || n > maxNetElements)
+            continue;
+        double weight = 1.0 / (n - 1);
+        for (int j = 0; j < n; j++)
+            for (int k = j + 1; k < n; k++)
+                weights[(unsigned long long) netElements[j] << 32 | netElements[k]] += weight;
+    }
+
+    edges.resize(elements.size());
+    for (auto &w : weights) {
+        int n1 = w.first >> 32;
+        int n2 = w.first & 0xffffffff;
+        edges[n1].push_back(std::make_pair(n2, w.second));
+        edges[n2].push_back(std::make_pair(n1, w.second));
+    }
+    for (auto &e : edges)
+        std::sort(e.begin(), e.end());
+}
+
+// Center is element with most pads, next element is most connected with previous
+std::vector<int> Cluster::order(const std::vector<int> &members) const
+{
+    std::vector<int> ordered;
+    std::vector<int> rest = members;
+
+    auto weight = [this](int n1, int n2) {
+        auto i = std::lower_bound(edges[n1].begin(), edges[n1].end(),
+                                  std::make_pair(n2, 0.0));
+        return (i != edges[n1].end() && i->first == n2) ? i->second : 0;
+    };
+
+    auto center = std::max_element(rest.begin(), rest.end(), [this](int n1, int n2) {
+        return padsNumber[n1] < padsNumber[n2]; });
+    ordered.push_back(*center);
+    rest.erase(center);
+
+    std::vector<double> sum(rest.size());   // weight to ordered elements
+    while (!rest.empty()) {
+        int last = ordered.back();
+        int best = 0;
+        double bestWeight = -1;
+        double bestSum = -1;
+        for (uint i = 0; i < rest.size(); i++) {
+            double w = weight(last, rest[i]);
+            sum[i] += w;
+            if (w > bestWeight || (w == bestWeight && sum[i] > bestSum)) {
+                best = i;
+                bestWeight = w;
+                bestSum = sum[i];
+            }
+        }
+        ordered.push_back(rest[best]);
+        rest.erase(rest.begin() + best);
+        sum.erase(sum.begin() + best);
+    }
+
+    return ordered;
+}
+
+// Heavy edge matching: vertex is matched with neighbour of max rating
+// weight / (size1 * size2), matched pairs are contracted until no pairs
+void Cluster::partition(int maxClusterElements)
+{
+    bool matched = true;
+    std::vector<Edges> graph = edges;
+    std::vector<std::vector<int>> members(edges.size());
+
+    for (uint i = 0; i < members.size(); i++)
+        members[i].push_back(i);
+
+    while (matched) {
+        int n = graph.size();
+        std::vector<int> match(n, -1);
+        std::vector<int> visit(n);
+
+        // Vertices of low degree are matched first
+        std::iota(visit.begin(), visit.end(), 0);
+        std::stable_sort(visit.begin(), visit.end(), [&graph](int n1, int n2) {
+            return graph[n1].size() < graph[n2].size(); });
+
+        matched = false;
+        for (int u : visit) {
+            if (match[u] >= 0)
+                continue;
+            int best = -1;
+            double bestRating = 0;
+            for (auto &e : graph[u]) {
+                int v = e.first;
+                if (match[v] >= 0 ||
+                    int(members[u].size() + members[v].size()) > maxClusterElements)
+                    continue;
+                double rating = e.second / (members[u].size() * members[v].size());
+                if (rating > bestRating) {
+                    bestRating = rating;
+                    best = v;
+                }
+            }
+            match[u] = u;
+            if (best >= 0) {
+                match[u] = best;
+                match[best] = u;
+                matched = true;
+            }
+        }
+
+        if (!matched)
+            break;
+
+        // Contract matched pairs
+        int m = 0;
+        std::vector<int> coarse(n, -1);
+        for (int u = 0; u < n; u++)
+            if (coarse[u] < 0) {
+                coarse[u] = m;
+                coarse[match[u]] = m;
+                m++;
+            }
+
+        std::vector<Edges> graph2(m);
+        std::vector<std::vector<int>> members2(m);
+        for (int u = 0; u < n; u++) {
+            int c = coarse[u];
+            members2[c].insert(members2[c].end(), members[u].begin(), members[u].end());
+            for (auto &e : graph[u])
+                if (coarse[e.first] != c)
+                    graph2[c].push_back(std::make_pair(coarse[e.first], e.second));
+        }
+        for (auto &g : graph2) {
+            std::sort(g.begin(), g.end());
+            uint k = 0;
+            for (uint i = 0; i < g.size(); i++) {
+                if (k && g[k-1].first == g[i].first)
+                    g[k-1].second += g[i].second;
+                else
+                    g[k++] = g[i];
+            }
+            g.resize(k);
+        }
+
+        graph.swap(graph2);
+        members.swap(members2);
+    }
+
+    clusters.clear();
+    for (auto &m : members)
+        if (m.size() > 1)
+            clusters.push_back(order(m));
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const std::vector<int> &c1, const std::vector<int> &c2) {
+        return c1.size() > c2.size(); });
+}
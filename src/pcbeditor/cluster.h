@@ -0,0 +1,32 @@
+// cluster.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "element.h"
+#include "netindex.h"
+#include <utility>
+#include <vector>
+
+// Element clustering by multilevel coarsening of element-net hypergraph
+class Cluster
+{
+public:
+    void clear();
+    void init(const std::vector<Element> &elements, const NetIndex &nets,
+              int maxNetElements);
+    void partition(int maxClusterElements);
+
+    std::vector<std::vector<int>> clusters; // element numbers, center first
+
+private:
+    typedef std::vector<std::pair<int, double>> Edges;  // vertex, weight
+
+    std::vector<int> order(const std::vector<int> &members) const;
+
+    std::vector<Edges> edges;               // element graph, clique net model
+    std::vector<int> padsNumber;            // pads of element
+};
+
+#endif  // CLUSTER_H
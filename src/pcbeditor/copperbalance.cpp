@@ -2,10 +2,14 @@
 // Copyright (C) 2026 Alexander Karpeko
 
 #include "copperbalance.h"
+#include "layers.h"
+#include <algorithm>
+#include <chrono>
 #include <QMessageBox>
+#include <QPainter>
 
-CopperBalance::CopperBalance(const Board &board, QWidget *parent):
-    board(board), QDialog(parent)
+CopperBalance::CopperBalance(const BoardSnapshot &board, QWidget *parent):
+    cancelled(false), countedParts(0), board(board), QDialog(parent)
 {
     setupUi(this);
     setGeometry(QRect(101, 108, 300, 520));
@@ -13,15 +17,73 @@ CopperBalance::CopperBalance(const Board &board, QWidget *parent):
     connect(okButton, SIGNAL(clicked()), this, SLOT(accept()));
     connect(runButton, SIGNAL(clicked()), this, SLOT(run()));
     connect(updateButton, SIGNAL(clicked()), this, SLOT(update()));
+    connect(&timer, SIGNAL(timeout()), this, SLOT(finish()));
 
     init();
 }
 
+CopperBalance::~CopperBalance()
+{
+    if (future.valid()) {
+        cancelled = true;
+        future.wait();
+    }
+}
+
 void CopperBalance::accept()
 {
     done(QDialog::Accepted);
 }
 
+void CopperBalance::count(const Point &pMin, int partWidth, int partHeight,
+                          int partImageWidth, int imageWidth, int imageHeight)
+{
+    QImage image(imageWidth, imageHeight, QImage::Format_Grayscale8);
+
+    for (int layer : {TOP_LAYER, BOTTOM_LAYER}) {
+        double (&area)[rows][columns] = layer == TOP_LAYER ? topCopperArea : bottomCopperArea;
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < columns; j++) {
+                int64_t copperPixels = 0;
+                for (int x = 0; x < partImageWidth; x += imageWidth) {
+                    if (cancelled)
+                        return;
+                    int width = std::min(partImageWidth - x, imageWidth);
+                    image.fill(0);
+                    QPainter painter(&image);
+                    painter.scale(1. / step, 1. / step);
+                    painter.translate(-(pMin.x + j * partWidth + x * step),
+                                      -(pMin.y + i * partHeight));
+                    board.drawCopper(painter, layer, QBrush(Qt::white));
+                    painter.end();
+                    for (int y = 0; y < imageHeight; y++) {
+                        const uchar *line = image.constScanLine(y);
+                        for (int k = 0; k < width; k++)
+                            if (line[k])
+                                copperPixels++;
+                    }
+                }
+                area[i][j] = double(copperPixels) / (int64_t(partImageWidth) * imageHeight);
+                countedParts++;
+            }
+    }
+}
+
+void CopperBalance::finish()
+{
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        runButton->setText(tr("Cancel %1%").arg(100 * countedParts / (2 * rows * columns)));
+        return;
+    }
+
+    timer.stop();
+    future.get();
+    runButton->setText(tr("Run"));
+    updateButton->setEnabled(true);
+    if (!cancelled)
+        showAreas();
+}
+
 void CopperBalance::init()
 {
     maxMiBImageSize = defaultMaxMiBImageSize;
@@ -125,6 +187,11 @@ bool CopperBalance::isRectangleBoard(Point &pMin, Point &pMax)
 
 void CopperBalance::run()
 {
+    if (future.valid()) {
+        cancelled = true;
+        return;
+    }
+
     bool isRectangle = false;
     Point pMin;
     Point pMax;
@@ -139,26 +206,53 @@ void CopperBalance::run()
 
     int boardWidth = pMax.x - pMin.x;
     int boardHeight = pMax.y - pMin.y;
-    int boardPartWidth = boardWidth / 4;
-    int boardPartHeight = boardHeight / 4;
+    int boardPartWidth = boardWidth / columns;
+    int boardPartHeight = boardHeight / rows;
+    int partImageWidth = boardPartWidth / step;
     int imageHeight = boardPartHeight / step;
 
-    int64_t maxImageSize = 1024 * 1024 * maxMiBImageSize;
-    int imageWidth = 8 * maxImageSize / imageHeight;
-    if (imageWidth > boardPartWidth / step)
-        imageWidth = boardPartWidth / step;
+    if (partImageWidth < 1 || imageHeight < 1) {
+        QMessageBox::information(this, tr("Copper Balance"),
+            tr("Step is too big for the board."));
+        return;
+    }
 
-    QImage image(imageWidth, imageHeight, QImage::Format_Mono);
+    // One byte per pixel, part is drawn by vertical strips if image is small
+    int64_t maxImageSize = int64_t(1024 * 1024) * maxMiBImageSize;
+    int64_t imageWidth = maxImageSize / imageHeight;
+    if (imageWidth > partImageWidth)
+        imageWidth = partImageWidth;
+    if (imageWidth < 1)
+        imageWidth = 1;
 
+    cancelled = false;
+    countedParts = 0;
+    runButton->setText(tr("Cancel 0%"));
+    updateButton->setEnabled(false);
+    future = std::async(std::launch::async, [=]() {
+        count(pMin, boardPartWidth, boardPartHeight, partImageWidth, int(imageWidth),
+              imageHeight);
+    });
+    timer.start(timerInterval);
+}
+
+void CopperBalance::showAreas()
+{
     topAverageCopperArea = 0;
     bottomAverageCopperArea = 0;
     for (int i = 0; i < rows; i++)
         for (int j = 0; j < columns; j++) {
             topAverageCopperArea += topCopperArea[i][j];
             bottomAverageCopperArea += bottomCopperArea[i][j];
+            topCopperTableWidget->setItem(i, j,
+                new QTableWidgetItem(QString::number(100 * topCopperArea[i][j], 'f', 1)));
+            bottomCopperTableWidget->setItem(i, j,
+                new QTableWidgetItem(QString::number(100 * bottomCopperArea[i][j], 'f', 1)));
         }
     topAverageCopperArea /= (rows * columns);
     bottomAverageCopperArea /= (rows * columns);
+    topAverageCopperAreaLineEdit->setText(QString::number(100 * topAverageCopperArea, 'f', 1));
+    bottomAverageCopperAreaLineEdit->setText(QString::number(100 * bottomAverageCopperArea, 'f', 1));
 }
 
 void CopperBalance::update()
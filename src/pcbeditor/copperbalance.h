@@ -4,24 +4,33 @@
 #ifndef COPPER_BALANCE_H
 #define COPPER_BALANCE_H
 
-#include "board.h"
+#include "boardsnapshot.h"
 #include "types.h"
 #include "ui_copperbalance.h"
 #include <QDialog>
+#include <QTimer>
+#include <atomic>
+#include <future>
 
 class CopperBalance : public QDialog, private Ui::CopperBalance
 {
     Q_OBJECT
 
 public:
-    explicit CopperBalance(const Board &board, QWidget *parent = nullptr);
+    explicit CopperBalance(const BoardSnapshot &board, QWidget *parent = nullptr);
+    ~CopperBalance();
 
 private:
+    // Copper of parts is counted on worker thread
+    void count(const Point &pMin, int partWidth, int partHeight,
+               int partImageWidth, int imageWidth, int imageHeight);
     void init();
     bool isRectangleBoard(Point &pMin, Point &pMax);
+    void showAreas();
 
 private slots:
     void accept();
+    void finish();
     void run();
     void update();
 
@@ -30,13 +39,18 @@ private:
     static constexpr int rows = 4;
     static constexpr int defaultMaxMiBImageSize = 256;  // MiB
     static constexpr int defaultStep = 10;              // micrometers
+    static constexpr int timerInterval = 200;           // ms
+    std::atomic<bool> cancelled;
+    std::atomic<int> countedParts;
     double bottomAverageCopperArea;
     double topAverageCopperArea;
     double bottomCopperArea[rows][columns];
     double topCopperArea[rows][columns];
     int maxMiBImageSize;
     int step;
-    const Board &board;
+    const BoardSnapshot board;
+    QTimer timer;
+    std::future<void> future;
 };
 
 #endif  // COPPER_BALANCE_H
@@ -11,26 +11,20 @@
 #include <QPainterPath>
 
 double Element::padCornerRadius = 0;
-std::vector<Package> Element::packages;
 
 Element::Element(int refX, int refY, int orientation, const QString &name,
                  const QString &packageName, const QString &reference,
                  bool onTop, bool hasOptions):
     onTop(onTop), orientation(orientation), refX(refX), refY(refY),
-    name(name), packageName(packageName), reference(reference)
+    name(name), packageName(Library::intern(packageName)), reference(reference)
 {
-    for (uint i = 0; i < packages.size(); i++) {
-        if (!packageName.compare(packages[i].name)) {
-                packageID = i;
-                break;
-        }
-        if (i == packages.size() - 1)
-            throw ExceptionData("Package name error: " + packageName);
-    }
+    packageID = Library::packages().find(packageName);
+    if (packageID < 0)
+        throw ExceptionData("Package name error: " + packageName);
 
     isJumper = false;
 
-    init(packages[packageID]);
+    init(*Library::packages().package(packageID));
 
     if (hasOptions)
         roundPadCorners();
@@ -43,6 +37,7 @@ Element::Element(int refX, int refY, int orientation, const QString &name,
     name(name), packageName(package.name), reference(reference)
 {
     isJumper = false;
+    packageID = Library::packages().find(packageName);
 
     init(package);
 
@@ -60,16 +55,11 @@ Element::Element(const QJsonObject &object, bool hasOptions)
 
     reference = object["reference"].toString();
     name = object["name"].toString();
-    packageName = object["package"].toString();
+    packageName = Library::intern(object["package"].toString());
 
-    for (uint i = 0; i < packages.size(); i++) {
-        if (!packageName.compare(packages[i].name)) {
-                packageID = i;
-                break;
-        }
-        if (i == packages.size() - 1)
-            throw ExceptionData("Package name error: " + packageName);
-    }
+    packageID = Library::packages().find(packageName);
+    if (packageID < 0)
+        throw ExceptionData("Package name error: " + packageName);
 
     refX = object["refX"].toInt();
     refY = object["refY"].toInt();
@@ -84,7 +74,7 @@ Element::Element(const QJsonObject &object, bool hasOptions)
             throw ExceptionData("Element orientation error");
     }
 
-    init(packages[packageID]);
+    init(*Library::packages().package(packageID));
 
     QJsonArray elementPads = object["pads"].toArray();
 
@@ -113,20 +103,15 @@ Element::Element(const QJsonObject &object, int refX, int refY, bool hasOptions)
 
     reference = object["reference"].toString();
     name = object["name"].toString();
-    packageName = object["package"].toString();
+    packageName = Library::intern(object["package"].toString());
 
-    for (uint i = 0; i < packages.size(); i++) {
-        if (!packageName.compare(packages[i].name)) {
-                packageID = i;
-                break;
-        }
-        if (i == packages.size() - 1)
-            throw ExceptionData("Package name error: " + packageName);
-    }
+    packageID = Library::packages().find(packageName);
+    if (packageID < 0)
+        throw ExceptionData("Package name error: " + packageName);
 
     orientation = UP;
 
-    init(packages[packageID]);
+    init(*Library::packages().package(packageID));
 
     QJsonArray elementPads = object["pads"].toArray();
 
@@ -144,14 +129,8 @@ Element::Element(const QJsonObject &object, int refX, int refY, bool hasOptions)
         roundPadCorners();
 }
 
-void Element::addPackage(const QJsonValue &value)
-{
-    Package package(value);
-    Element::packages.push_back(package);
-}
-
 void Element::draw(QPainter &painter, const Layers &layers,
-                   const ElementDrawingOptions &options)
+                   const ElementDrawingOptions &options) const
 {
     int align;
     int d, h, inD, w;
@@ -168,7 +147,7 @@ void Element::draw(QPainter &painter, const Layers &layers,
             painter.setPen(QColor(255, 255, 255));
         else
             painter.setPen(layers.color[TOP_PAD_LAYER]);
-        for (auto p : pads) {
+        for (const auto &p : pads) {
             d = scale * p.diameter;
             h = scale * p.height;
             inD = scale * p.innerDiameter;
@@ -209,11 +188,11 @@ void Element::draw(QPainter &painter, const Layers &layers,
 
     if (layers.draw & (1 << TOP_PACKAGE_LAYER)) {
         painter.setPen(layers.color[TOP_PACKAGE_LAYER]);
-        for (auto e : ellipses)
+        for (const auto &e : ellipses)
             painter.drawEllipse(scale * (e.x - e.w / 2),
                                 scale * (e.y - e.h / 2),
                                 scale * e.w, scale * e.h);
-        for (auto l : lines)
+        for (const auto &l : lines)
             painter.drawLine(scale * l.x1, scale * l.y1,
                              scale * l.x2, scale * l.y2);
     }
@@ -224,9 +203,7 @@ void Element::draw(QPainter &painter, const Layers &layers,
         h = fontSize;
         x = scale * centerX - w / 2;
         y = scale * border.bottomY + 0.2 * fontSize;
-        nameTextAlignH = "Center";
-        nameTextAlignV = "Center";
-        align = alignment(nameTextAlignH, nameTextAlignV);
+        align = Qt::AlignHCenter | Qt::AlignVCenter;
         painter.drawText(x, y, w, h, align, name);
     }
 
@@ -236,14 +213,12 @@ void Element::draw(QPainter &painter, const Layers &layers,
         h = fontSize;
         x = scale * centerX - w / 2;
         y = scale * border.topY - 1.2 * fontSize;
-        referenceTextAlignH = "Center";
-        referenceTextAlignV = "Center";
-        align = alignment(referenceTextAlignH, referenceTextAlignV);
+        align = Qt::AlignHCenter | Qt::AlignVCenter;
         painter.drawText(x, y, w, h, align, reference);
     }
 }
 
-bool Element::exist(int x, int y)
+bool Element::exist(int x, int y) const
 {
     int dx = abs(border.rightX - border.leftX) / 2;
     int dy = abs(border.bottomY - border.topY) / 2;
@@ -262,14 +237,14 @@ void Element::findOuterBorder()
     int minY = refY;
     int maxY = refY;
 
-    for (auto e : ellipses) {
+    for (const auto &e : ellipses) {
         if (minX > e.x - e.w / 2) minX = e.x - e.w / 2;
         if (maxX < e.x + e.w / 2) maxX = e.x + e.w / 2;
         if (minY > e.y - e.h / 2) minY = e.y - e.h / 2;
         if (maxY < e.y + e.h / 2) maxY = e.y + e.h / 2;
     }
 
-    for (auto l : lines) {
+    for (const auto &l : lines) {
         if (minX > l.x1) minX = l.x1;
         if (minX > l.x2) minX = l.x2;
         if (maxX < l.x1) maxX = l.x1;
@@ -280,7 +255,7 @@ void Element::findOuterBorder()
         if (maxY < l.y2) maxY = l.y2;
     }
 
-    for (auto p : pads) {
+    for (const auto &p : pads) {
         int w = p.width;
         int h = p.height;
         if (w == 0 || h == 0) {
@@ -338,7 +313,7 @@ void Element::init(const Package &package)
     type = package.type;
 
     Ellipse ellipse;
-    for (auto e : package.ellipses) {
+    for (const auto &e : package.ellipses) {
         ellipse.x = refX + c[t][0] * e.x + c[t][1] * e.y;
         ellipse.y = refY + c[t][2] * e.x + c[t][3] * e.y;
         ellipse.w = e.w;
@@ -347,7 +322,7 @@ void Element::init(const Package &package)
     }
 
     Line line;
-    for (auto l : package.lines) {
+    for (const auto &l : package.lines) {
         line.x1 = refX + c[t][0] * l.x1 + c[t][1] * l.y1;
         line.y1 = refY + c[t][2] * l.x1 + c[t][3] * l.y1;
         line.x2 = refX + c[t][0] * l.x2 + c[t][1] * l.y2;
@@ -356,7 +331,7 @@ void Element::init(const Package &package)
     }
 
     Pad pad;
-    for (auto p : package.pads) {
+    for (const auto &p : package.pads) {
         pad.diameter = p.diameter;
         pad.height = p.height;
         pad.innerDiameter = p.innerDiameter;
@@ -378,7 +353,7 @@ void Element::init(const Package &package)
     findOuterBorder();
 }
 
-bool Element::inside(int leftX, int topY, int rightX, int bottomY)
+bool Element::inside(int leftX, int topY, int rightX, int bottomY) const
 {
     if (centerX >= leftX && centerX <= rightX &&
         centerY >= topY && centerY <= bottomY)
@@ -389,22 +364,26 @@ bool Element::inside(int leftX, int topY, int rightX, int bottomY)
 
 void Element::roundPadCorners()
 {
+    auto package = Library::packages().package(packageID);
+    if (!package)
+        return;
+
     if (padCornerRadius > 0 && padCornerRadius < 0.5 + minValue)
         for (uint i = 0; i < pads.size(); i++)
-            if (packages[packageID].pads[i].diameter == 0)
+            if (package->pads[i].diameter == 0)
                 pads[i].diameter = lround(2 * padCornerRadius *
                                           std::min(pads[i].height, pads[i].width));
 
     if (padCornerRadius > 1 - minValue)
         for (uint i = 0; i < pads.size(); i++)
-            if (packages[packageID].pads[i].diameter == 0) {
+            if (package->pads[i].diameter == 0) {
                 pads[i].diameter = lround(2 * padCornerRadius);
                 if (pads[i].diameter > std::min(pads[i].height, pads[i].width))
                     pads[i].diameter = std::min(pads[i].height, pads[i].width);
             }
 }
 
-QJsonObject Element::toJson()
+QJsonObject Element::toJson() const
 {
     QString orientationString(elementOrientationString[orientation]);
     QJsonArray elementPads;
@@ -438,9 +417,11 @@ QJsonObject Element::toJson()
 QJsonObject Element::writePackages(const QString &packageType)
 {
     QJsonArray packageArray;
-    for (auto e : packages)
-        if (!e.type.compare(packageType))
-            packageArray.append(e.toJson());
+    for (int i = 0; i < Library::packages().size(); i++) {
+        auto package = Library::packages().package(i);
+        if (!package->type.compare(packageType))
+            packageArray.append(Package(*package).toJson());
+    }
 
     QJsonObject object
     {
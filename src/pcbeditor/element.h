@@ -6,7 +6,7 @@
 #define ELEMENT_H
 
 #include "layers.h"
-#include "package.h"
+#include "library.h"
 #include <QPainter>
 #include <QString>
 
@@ -48,19 +48,17 @@ public:
             bool onTop, bool hasOptions = true);
     Element(const QJsonObject &object, bool hasOptions = true);
     Element(const QJsonObject &object, int refX, int refY, bool hasOptions = true);
-    static void addPackage(const QJsonValue &value);
     static QJsonObject writePackages(const QString &packageType);
     void draw(QPainter &painter, const Layers &layers,
-              const ElementDrawingOptions &options);
-    bool exist(int x, int y);
+              const ElementDrawingOptions &options) const;
+    bool exist(int x, int y) const;
     void findOuterBorder();
     void init(const Package &package);
-    bool inside(int leftX, int topY, int rightX, int bottomY);
+    bool inside(int leftX, int topY, int rightX, int bottomY) const;
     void roundPadCorners();
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     static double padCornerRadius;
-    static std::vector<Package> packages;
     bool enabled;
     bool fixed;             // fixed on board
     bool group;
@@ -0,0 +1,607 @@
+// gerber.cpp
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#include "exceptiondata.h"
+#include "gerber.h"
+#include "threadpool.h"
+#include <QFile>
+#include <QPolygonF>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+const char *extensions[Gerber::FILE_TYPES] =
+{
+    "gko", "gbl", "gbs", "gbp", "gbo", "drl", "gtl", "gts", "gtp", "gto"
+};
+
+const char *fileFunctions[Gerber::FILE_TYPES] =
+{
+    "Profile,NP", "Copper,L2,Bot", "Soldermask,Bot", "Paste,Bot", "Legend,Bot", "",
+    "Copper,L1,Top", "Soldermask,Top", "Paste,Top", "Legend,Top"
+};
+
+// Rectangle with corner circles: width, height, corner radius
+const char *roundRectMacro =
+    "%AMRoundRect*\n"
+    "21,1,$1,$2-$3-$3,0,0,0*\n"
+    "21,1,$1-$3-$3,$2,0,0,0*\n"
+    "1,1,$3+$3,$1/2-$3,$2/2-$3*\n"
+    "1,1,$3+$3,$3-$1/2,$2/2-$3*\n"
+    "1,1,$3+$3,$1/2-$3,$3-$2/2*\n"
+    "1,1,$3+$3,$3-$1/2,$3-$2/2*%\n";
+
+// Buffered file output, numbers are formatted without strings
+class Output
+{
+public:
+    static constexpr int bufferSize = 64 * 1024;
+
+    explicit Output(const QString &filename);
+    void close();
+    void millimeters(int um);
+    void number(long long n);
+    Output &operator<<(const char *text);
+
+private:
+    void flush();
+
+    std::vector<char> buffer;
+    QFile file;
+};
+
+Output::Output(const QString &filename): file(filename)
+{
+    buffer.reserve(bufferSize);
+    if (!file.open(QIODevice::WriteOnly))
+        throw ExceptionData(filename + " open error");
+}
+
+void Output::close()
+{
+    flush();
+    file.close();
+}
+
+void Output::flush()
+{
+    if (file.write(buffer.data(), buffer.size()) != qint64(buffer.size()))
+        throw ExceptionData(file.fileName() + " write error");
+    buffer.clear();
+}
+
+void Output::millimeters(int um)
+{
+    if (um < 0) {
+        *this << "-";
+        um = -um;
+    }
+    number(um / 1000);
+    char fraction[] = {'.', char('0' + um / 100 % 10), char('0' + um / 10 % 10),
+                       char('0' + um % 10), 0};
+    *this << fraction;
+}
+
+void Output::number(long long n)
+{
+    char text[24];
+    int i = sizeof text - 1;
+    unsigned long long u = n < 0 ? -(unsigned long long) n : n;
+
+    text[i] = 0;
+    do {
+        text[--i] = '0' + u % 10;
+        u /= 10;
+    } while (u);
+    if (n < 0)
+        text[--i] = '-';
+
+    *this << text + i;
+}
+
+Output &Output::operator<<(const char *text)
+{
+    int n = strlen(text);
+
+    if (int(buffer.size()) + n > bufferSize)
+        flush();
+    buffer.insert(buffer.end(), text, text + n);
+
+    return *this;
+}
+
+class Aperture
+{
+public:
+    bool operator<(const Aperture &a) const
+    {
+        return std::tie(type, w, h, r) < std::tie(a.type, a.w, a.h, a.r);
+    }
+
+    char type;      // C: circle, M: rounded rectangle, O: obround, R: rectangle
+    int w;
+    int h;
+    int r;          // corner radius
+};
+
+Aperture circleAperture(int diameter)
+{
+    return Aperture{'C', diameter, diameter, 0};
+}
+
+// Pad shape with space, as Pour::addPad
+Aperture padAperture(const Pad &pad, int space)
+{
+    int d = pad.diameter;
+    int h = pad.height;
+    int w = pad.width;
+
+    if (pad.orientation == Element::RIGHT)
+        std::swap(w, h);
+    if (h == 0 || w == 0)
+        return circleAperture(d + 2 * space);
+    h += 2 * space;
+    w += 2 * space;
+    int r = std::min(d / 2 + space, std::min(w, h) / 2);
+
+    if (r <= 0)
+        return Aperture{'R', w, h, 0};
+    if (2 * r >= std::min(w, h))
+        return w == h ? circleAperture(w) : Aperture{'O', w, h, 0};
+    return Aperture{'M', w, h, r};
+}
+
+// Objects of layer, apertures are only collected while output is null
+class Layer
+{
+public:
+    explicit Layer(Output *output = nullptr):
+        hasPoint(false), aperture(-1), mode(0), x(0), y(0), output(output) {}
+    void arc(int width, const Segment &segment);
+    void circle(int width, int centerX, int centerY, int radius);
+    void flash(const Aperture &a, int x, int y);
+    void line(int width, int x1, int y1, int x2, int y2);
+    void region(const QPainterPath &path);
+    void writeApertures();
+
+    std::map<Aperture, int> apertures;      // aperture, D code
+
+private:
+    void moveTo(int x, int y);
+    void point(double x, double y);
+    bool select(const Aperture &a);
+    void setMode(int mode);
+
+    bool hasPoint;
+    int aperture;           // current D code
+    int mode;               // interpolation: G01, G02, G03
+    int x;                  // current point
+    int y;
+    Output *output;
+};
+
+void Layer::arc(int width, const Segment &segment)
+{
+    const double pi = acos(-1);
+    const Segment &s = segment;
+
+    if (!select(circleAperture(width)))
+        return;
+
+    double a1 = s.startAngle * pi / 180;
+    double a2 = (s.startAngle + s.spanAngle) * pi / 180;
+    int x1 = lround(s.x0 + s.radius * cos(a1));
+    int y1 = lround(s.y0 - s.radius * sin(a1));
+    int x2 = lround(s.x0 + s.radius * cos(a2));
+    int y2 = lround(s.y0 - s.radius * sin(a2));
+
+    moveTo(x1, y1);
+    setMode(s.spanAngle > 0 ? 3 : 2);
+    point(x2, y2);
+    *output << "I";
+    output->number(1000ll * (s.x0 - x1));
+    *output << "J";
+    output->number(1000ll * (y1 - s.y0));
+    *output << "D01*\n";
+    x = x2;
+    y = y2;
+}
+
+void Layer::circle(int width, int centerX, int centerY, int radius)
+{
+    if (!select(circleAperture(width)))
+        return;
+
+    moveTo(centerX + radius, centerY);
+    setMode(3);
+    point(centerX + radius, centerY);
+    *output << "I";
+    output->number(-1000ll * radius);
+    *output << "J0D01*\n";
+}
+
+void Layer::flash(const Aperture &a, int x, int y)
+{
+    if (!select(a))
+        return;
+
+    point(x, y);
+    *output << "D03*\n";
+    this->x = x;
+    this->y = y;
+    hasPoint = true;
+}
+
+void Layer::line(int width, int x1, int y1, int x2, int y2)
+{
+    if (x1 == x2 && y1 == y2) {
+        flash(circleAperture(width), x1, y1);
+        return;
+    }
+
+    if (!select(circleAperture(width)))
+        return;
+
+    moveTo(x1, y1);
+    setMode(1);
+    point(x2, y2);
+    *output << "D01*\n";
+    x = x2;
+    y = y2;
+}
+
+void Layer::moveTo(int x, int y)
+{
+    if (hasPoint && x == this->x && y == this->y)
+        return;
+
+    point(x, y);
+    *output << "D02*\n";
+    this->x = x;
+    this->y = y;
+    hasPoint = true;
+}
+
+// Y axis of Gerber is up, coordinate unit is 1 nm
+void Layer::point(double x, double y)
+{
+    *output << "X";
+    output->number(llround(1000 * x));
+    *output << "Y";
+    output->number(llround(-1000 * y));
+}
+
+// Contours of fill do not cross, contour inside odd number of contours
+// is hole. Holes are cleared, islands inside holes are drawn again.
+void Layer::region(const QPainterPath &path)
+{
+    if (!output || path.isEmpty())
+        return;
+
+    QList<QPolygonF> contours = path.toSubpathPolygons();
+    std::vector<QRectF> bounds(contours.size());
+    std::vector<int> depths(contours.size());
+    int maxDepth = 0;
+
+    for (int i = 0; i < contours.size(); i++)
+        bounds[i] = contours[i].boundingRect();
+
+    for (int i = 0; i < contours.size(); i++) {
+        if (contours[i].size() < 3)
+            continue;
+        for (int j = 0; j < contours.size(); j++)
+            if (j != i && bounds[j].contains(bounds[i]) &&
+                contours[j].containsPoint(contours[i][0], Qt::OddEvenFill))
+                depths[i]++;
+        maxDepth = std::max(maxDepth, depths[i]);
+    }
+
+    setMode(1);
+    for (int depth = 0; depth <= maxDepth; depth++) {
+        *output << (depth % 2 ? "%LPC*%\n" : "%LPD*%\n");
+        *output << "G36*\n";
+        for (int i = 0; i < contours.size(); i++) {
+            const QPolygonF &c = contours[i];
+            if (depths[i] != depth || c.size() < 3)
+                continue;
+            point(c[0].x(), c[0].y());
+            *output << "D02*\n";
+            for (int j = 1; j < c.size(); j++) {
+                point(c[j].x(), c[j].y());
+                *output << "D01*\n";
+            }
+            if (c.first() != c.last()) {
+                point(c[0].x(), c[0].y());
+                *output << "D01*\n";
+            }
+        }
+        *output << "G37*\n";
+    }
+    if (maxDepth > 0)
+        *output << "%LPD*%\n";
+
+    hasPoint = false;
+}
+
+// Aperture is selected if it is written
+bool Layer::select(const Aperture &a)
+{
+    if (!output) {
+        apertures.emplace(a, 0);
+        return false;
+    }
+
+    int code = apertures[a];
+    if (code != aperture) {
+        *output << "D";
+        output->number(code);
+        *output << "*\n";
+        aperture = code;
+    }
+
+    return true;
+}
+
+void Layer::setMode(int mode)
+{
+    const char *modes[] = {"", "G01*\n", "G02*\n", "G03*\n"};
+
+    if (this->mode != mode) {
+        *output << modes[mode];
+        this->mode = mode;
+    }
+}
+
+void Layer::writeApertures()
+{
+    int code = 10;
+
+    for (auto &a : apertures) {
+        a.second = code;
+        *output << "%ADD";
+        output->number(code++);
+        if (a.first.type == 'C') {
+            *output << "C,";
+            output->millimeters(a.first.w);
+        }
+        else {
+            char type[] = {a.first.type, ',', 0};
+            *output << (a.first.type == 'M' ? "RoundRect," : type);
+            output->millimeters(a.first.w);
+            *output << "X";
+            output->millimeters(a.first.h);
+            if (a.first.type == 'M') {
+                *output << "X";
+                output->millimeters(a.first.r);
+            }
+        }
+        *output << "*%\n";
+    }
+}
+
+bool hasPad(const Element &element, const Pad &pad, bool top)
+{
+    return pad.innerDiameter > 0 || element.onTop == top;
+}
+
+// Plated holes of pads and vias: function(diameter, x, y)
+template<typename F>
+void drawHoles(const BoardSnapshot &board, F function)
+{
+    for (auto &e : board.elements)
+        for (auto &p : e.pads)
+            if (p.innerDiameter > 0)
+                function(p.innerDiameter, p.x, p.y);
+
+    for (auto &v : board.vias)
+        if (v.innerDiameter > 0)
+            function(v.innerDiameter, v.x, v.y);
+}
+
+void drawBorder(const BoardSnapshot &board, Layer &layer)
+{
+    const std::vector<Point> &points = board.border.points;
+
+    for (uint i = 0; i < points.size(); i++) {
+        const Point &p1 = points[i];
+        const Point &p2 = points[(i + 1) % points.size()];
+        layer.line(Gerber::borderLineWidth, p1.x, p1.y, p2.x, p2.y);
+    }
+}
+
+// Bigger polygons first, polygon inside hole of other polygon is not cleared
+void drawCopper(const BoardSnapshot &board, bool top, Layer &layer)
+{
+    std::vector<const Polygon*> polygons;
+
+    for (auto &p : top ? board.topPolygons : board.bottomPolygons)
+        if (p.fill && !p.fillPath.isEmpty())
+            polygons.push_back(&p);
+
+    std::stable_sort(polygons.begin(), polygons.end(),
+                     [](const Polygon *p1, const Polygon *p2) {
+        QRectF r1 = p1->fillPath.boundingRect();
+        QRectF r2 = p2->fillPath.boundingRect();
+        return r1.width() * r1.height() > r2.width() * r2.height(); });
+
+    for (auto p : polygons)
+        layer.region(p->fillPath);
+
+    for (auto &s : top ? board.topSegments : board.bottomSegments) {
+        if (s.type == Segment::ARC)
+            layer.arc(s.width, s);
+        else
+            layer.line(s.width, s.x1, s.y1, s.x2, s.y2);
+    }
+
+    for (auto &v : board.vias)
+        layer.flash(circleAperture(v.diameter), v.x, v.y);
+
+    for (auto &e : board.elements)
+        for (auto &p : e.pads)
+            if (hasPad(e, p, top))
+                layer.flash(padAperture(p, 0), p.x, p.y);
+}
+
+void drawMask(const BoardSnapshot &board, bool top, Layer &layer)
+{
+    int swell = board.solderMaskSwell;
+
+    for (auto &e : board.elements)
+        for (auto &p : e.pads)
+            if (hasPad(e, p, top))
+                layer.flash(padAperture(p, swell), p.x, p.y);
+
+    if (board.openMaskOnVia)
+        for (auto &v : board.vias)
+            layer.flash(circleAperture(v.diameter + 2 * swell), v.x, v.y);
+}
+
+void drawPaste(const BoardSnapshot &board, bool top, Layer &layer)
+{
+    for (auto &e : board.elements)
+        if (e.onTop == top)
+            for (auto &p : e.pads)
+                if (p.innerDiameter == 0)
+                    layer.flash(padAperture(p, 0), p.x, p.y);
+}
+
+void drawSilk(const BoardSnapshot &board, bool top, Layer &layer)
+{
+    const double pi = acos(-1);
+    const int w = Gerber::silkLineWidth;
+
+    for (auto &e : board.elements) {
+        if (e.onTop != top)
+            continue;
+        for (auto &l : e.lines)
+            layer.line(w, l.x1, l.y1, l.x2, l.y2);
+        for (auto &el : e.ellipses) {
+            if (el.w == el.h) {
+                layer.circle(w, el.x, el.y, el.w / 2);
+                continue;
+            }
+            int x1 = el.x + el.w / 2;
+            int y1 = el.y;
+            for (int i = 1; i <= Gerber::ellipseSegments; i++) {
+                double a = 2 * pi * i / Gerber::ellipseSegments;
+                int x2 = lround(el.x + el.w / 2. * cos(a));
+                int y2 = lround(el.y - el.h / 2. * sin(a));
+                layer.line(w, x1, y1, x2, y2);
+                x1 = x2;
+                y1 = y2;
+            }
+        }
+    }
+}
+
+void drawLayer(const BoardSnapshot &board, int fileType, Layer &layer)
+{
+    bool top = fileType >= Gerber::TOP_COPPER;
+
+    switch (fileType) {
+    case Gerber::BORDER:
+        drawBorder(board, layer);
+        break;
+    case Gerber::BOTTOM_COPPER:
+    case Gerber::TOP_COPPER:
+        drawCopper(board, top, layer);
+        break;
+    case Gerber::BOTTOM_MASK:
+    case Gerber::TOP_MASK:
+        drawMask(board, top, layer);
+        break;
+    case Gerber::BOTTOM_PASTE:
+    case Gerber::TOP_PASTE:
+        drawPaste(board, top, layer);
+        break;
+    case Gerber::BOTTOM_SILK:
+    case Gerber::TOP_SILK:
+        drawSilk(board, top, layer);
+        break;
+    }
+}
+
+}
+
+QString Gerber::filename(const QString &basename, int fileType)
+{
+    return basename + "." + extensions[fileType];
+}
+
+void Gerber::write(const QString &basename) const
+{
+    ThreadPool::global().parallelFor(0, FILE_TYPES, [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            if (i == DRILL)
+                writeDrill(filename(basename, i));
+            else
+                writeLayer(i, filename(basename, i));
+        }
+    }, 1);
+}
+
+// Excellon: holes of each tool are written by pass over board
+void Gerber::writeDrill(const QString &filename) const
+{
+    int number = 1;
+    std::map<int, int> tools;       // diameter, tool number
+
+    drawHoles(board, [&tools](int d, int, int) { tools.emplace(d, 0); });
+
+    Output output(filename);
+    output << "M48\nFMAT,2\nMETRIC\n";
+    for (auto &t : tools) {
+        t.second = number++;
+        output << "T";
+        output.number(t.second);
+        output << "C";
+        output.millimeters(t.first);
+        output << "\n";
+    }
+    output << "%\nG90\nG05\n";
+
+    for (auto &t : tools) {
+        output << "T";
+        output.number(t.second);
+        output << "\n";
+        drawHoles(board, [&output, &t](int d, int x, int y) {
+            if (d != t.first)
+                return;
+            output << "X";
+            output.millimeters(x);
+            output << "Y";
+            output.millimeters(-y);
+            output << "\n";
+        });
+    }
+
+    output << "M30\n";
+    output.close();
+}
+
+void Gerber::writeLayer(int fileType, const QString &filename) const
+{
+    bool mask = fileType == BOTTOM_MASK || fileType == TOP_MASK;
+    Layer apertures;
+
+    drawLayer(board, fileType, apertures);
+
+    Output output(filename);
+    Layer layer(&output);
+    layer.apertures.swap(apertures.apertures);
+
+    output << "%TF.FileFunction," << fileFunctions[fileType] << "*%\n";
+    output << "%TF.FilePolarity," << (mask ? "Negative" : "Positive") << "*%\n";
+    output << "%FSLAX46Y46*%\n%MOMM*%\n" << roundRectMacro << "G75*\n%LPD*%\n";
+    layer.writeApertures();
+    drawLayer(board, fileType, layer);
+    output << "M02*\n";
+    output.close();
+}
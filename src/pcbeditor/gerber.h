@@ -0,0 +1,38 @@
+// gerber.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef GERBER_H
+#define GERBER_H
+
+#include "boardsnapshot.h"
+#include <QString>
+
+// Fabrication files: Gerber RS-274X layers and Excellon drill file.
+// Files are written from board snapshot: apertures are collected in first pass,
+// objects are streamed to buffered file in second pass.
+class Gerber
+{
+public:
+    static constexpr int borderLineWidth = 100;
+    static constexpr int ellipseSegments = 32;
+    static constexpr int silkLineWidth = 150;
+
+    enum FileType
+    {
+        BORDER, BOTTOM_COPPER, BOTTOM_MASK, BOTTOM_PASTE, BOTTOM_SILK, DRILL,
+        TOP_COPPER, TOP_MASK, TOP_PASTE, TOP_SILK, FILE_TYPES
+    };
+
+    explicit Gerber(const BoardSnapshot &board): board(board) {}
+    static QString filename(const QString &basename, int fileType);
+    // All files, each file is written by own thread
+    void write(const QString &basename) const;
+    void writeDrill(const QString &filename) const;
+    void writeLayer(int fileType, const QString &filename) const;
+
+private:
+    BoardSnapshot board;
+};
+
+#endif  // GERBER_H
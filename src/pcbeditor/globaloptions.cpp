@@ -11,7 +11,7 @@ GlobalOptions::GlobalOptions(GlobalOptionsData &options, QWidget *parent):
     QDialog(parent), options(&options)
 {
     setupUi(this);
-    setGeometry(QRect(97, 111, 550, 200));
+    setGeometry(QRect(97, 111, 550, 320));
 
     connect(cancelButton, SIGNAL(clicked()), this, SLOT(reject()));
     connect(okButton, SIGNAL(clicked()), this, SLOT(accept()));
@@ -31,10 +31,11 @@ GlobalOptions::GlobalOptions(GlobalOptionsData &options, QWidget *parent):
 
 void GlobalOptions::accept()
 {
-    constexpr int size = 3;
+    constexpr int size = 4;
     bool ok[size];
     int n = 0;
 
+    ok[n++] = getNetClasses();
     ok[n++] = getOpenMaskOnVia();
     ok[n++] = getPadCornerRadius();
     ok[n++] = getSolderMaskSwell();
@@ -46,6 +47,23 @@ void GlobalOptions::accept()
     done(QDialog::Accepted);
 }
 
+// Line edit of wrong text shows old nets
+bool GlobalOptions::getNetClasses()
+{
+    NetClasses &c = options->netClasses;
+    QLineEdit *lineEdits[] = {criticalNetsLineEdit, groundNetsLineEdit, powerNetsLineEdit};
+    std::set<int> *nets[] = {&c.criticalNets, &c.groundNets, &c.powerNets};
+    bool ok = true;
+
+    for (int i = 0; i < 3; i++)
+        if (!NetClasses::parse(lineEdits[i]->text(), *nets[i])) {
+            lineEdits[i]->setText(NetClasses::text(*nets[i]));
+            ok = false;
+        }
+
+    return ok;
+}
+
 bool GlobalOptions::getOpenMaskOnVia()
 {
     options->openMaskOnVia = openMaskOnViaCheckBox->isChecked();
@@ -111,11 +129,19 @@ bool GlobalOptions::getSolderMaskSwell()
 
 void GlobalOptions::init()
 {
+    setNetClasses();
     setOpenMaskOnVia();
     setPadCornerRadius();
     setSolderMaskSwell();
 }
 
+void GlobalOptions::setNetClasses()
+{
+    criticalNetsLineEdit->setText(NetClasses::text(options->netClasses.criticalNets));
+    groundNetsLineEdit->setText(NetClasses::text(options->netClasses.groundNets));
+    powerNetsLineEdit->setText(NetClasses::text(options->netClasses.powerNets));
+}
+
 void GlobalOptions::setOpenMaskOnVia()
 {
     openMaskOnViaCheckBox->setChecked(options->openMaskOnVia);
@@ -4,6 +4,7 @@
 #ifndef GLOBAL_OPTIONS_H
 #define GLOBAL_OPTIONS_H
 
+#include "routestrategy.h"
 #include "ui_globaloptions.h"
 #include <QDialog>
 
@@ -13,6 +14,7 @@ public:
     bool openMaskOnVia;
     double padCornerRadius;
     int solderMaskSwell;
+    NetClasses netClasses;
 };
 
 class GlobalOptions : public QDialog, private Ui::GlobalOptions
@@ -30,10 +32,12 @@ public:
     explicit GlobalOptions(GlobalOptionsData &options, QWidget *parent = nullptr);
 
 private:
+    bool getNetClasses();
     bool getOpenMaskOnVia();
     bool getPadCornerRadius();
     bool getSolderMaskSwell();
     void init();
+    void setNetClasses();
     void setOpenMaskOnVia();
     void setPadCornerRadius();
     void setSolderMaskSwell();
@@ -0,0 +1,116 @@
+// netindex.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "netindex.h"
+#include <algorithm>
+
+// Pads without net (net < 0) are not indexed
+void NetIndex::build(const std::vector<Element> &elements)
+{
+    std::vector<int> counts;
+
+    clear();
+
+    for (auto &e : elements)
+        for (auto &p : e.pads)
+            if (p.net >= 0)
+                numbers.push_back(p.net);
+    std::sort(numbers.begin(), numbers.end());
+    numbers.erase(std::unique(numbers.begin(), numbers.end()), numbers.end());
+
+    // Count pads of nets, then place pads to rows
+    counts.resize(numbers.size() + 1);
+    for (auto &e : elements)
+        for (auto &p : e.pads)
+            if (p.net >= 0)
+                counts[find(p.net) + 1]++;
+
+    offsets.resize(numbers.size() + 1);
+    for (uint i = 1; i < counts.size(); i++) {
+        counts[i] += counts[i-1];
+        offsets[i] = counts[i];
+    }
+
+    pads.resize(offsets.back());
+    for (uint i = 0; i < elements.size(); i++)
+        for (uint j = 0; j < elements[i].pads.size(); j++)
+            if (elements[i].pads[j].net >= 0)
+                pads[counts[find(elements[i].pads[j].net)]++] = Point(i, j);
+}
+
+void NetIndex::clear()
+{
+    numbers.clear();
+    offsets.assign(1, 0);
+    pads.clear();
+}
+
+// Index of net or -1
+int NetIndex::find(int number) const
+{
+    auto i = std::lower_bound(numbers.begin(), numbers.end(), number);
+    if (i == numbers.end() || *i != number)
+        return -1;
+
+    return i - numbers.begin();
+}
+
+// Call after element is inserted to elements
+void NetIndex::insertElement(int element, const Element &e)
+{
+    for (auto &p : pads)
+        if (p.x >= element)
+            p.x++;
+
+    for (uint i = 0; i < e.pads.size(); i++)
+        setPadNet(element, i, -1, e.pads[i].net);
+}
+
+// Call before element is erased from elements
+void NetIndex::removeElement(int element, const Element &e)
+{
+    for (uint i = 0; i < e.pads.size(); i++)
+        setPadNet(element, i, e.pads[i].net, -1);
+
+    for (auto &p : pads)
+        if (p.x > element)
+            p.x--;
+}
+
+void NetIndex::setPadNet(int element, int pad, int oldNet, int newNet)
+{
+    Point point(element, pad);
+
+    if (oldNet == newNet)
+        return;
+
+    int n = find(oldNet);
+    if (n >= 0) {
+        auto i = std::lower_bound(pads.begin() + offsets[n],
+                                  pads.begin() + offsets[n+1], point);
+        if (i != pads.begin() + offsets[n+1] && *i == point) {
+            pads.erase(i);
+            for (uint j = n + 1; j < offsets.size(); j++)
+                offsets[j]--;
+            if (offsets[n] == offsets[n+1]) {
+                numbers.erase(numbers.begin() + n);
+                offsets.erase(offsets.begin() + n);
+            }
+        }
+    }
+
+    if (newNet < 0)
+        return;
+
+    n = find(newNet);
+    if (n < 0) {
+        n = std::lower_bound(numbers.begin(), numbers.end(), newNet) - numbers.begin();
+        numbers.insert(numbers.begin() + n, newNet);
+        offsets.insert(offsets.begin() + n, offsets[n]);
+    }
+    auto i = std::lower_bound(pads.begin() + offsets[n],
+                              pads.begin() + offsets[n+1], point);
+    pads.insert(i, point);
+    for (uint j = n + 1; j < offsets.size(); j++)
+        offsets[j]++;
+}
@@ -0,0 +1,31 @@
+// netindex.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef NETINDEX_H
+#define NETINDEX_H
+
+#include "element.h"
+#include <vector>
+
+// Net -> pads index in compressed sparse row format,
+// pads of net are sorted by element and pad number
+class NetIndex
+{
+public:
+    const Point *begin(int index) const { return pads.data() + offsets[index]; }
+    void build(const std::vector<Element> &elements);
+    void clear();
+    const Point *end(int index) const { return pads.data() + offsets[index+1]; }
+    int find(int number) const;
+    void insertElement(int element, const Element &e);
+    int number(int index) const { return numbers[index]; }
+    void removeElement(int element, const Element &e);
+    void setPadNet(int element, int pad, int oldNet, int newNet);
+    int size() const { return numbers.size(); }
+
+    std::vector<int> numbers;   // net numbers, sorted
+    std::vector<int> offsets;   // pads of net i: offsets[i], ..., offsets[i+1] - 1
+    std::vector<Point> pads;    // x: element, y: pad
+};
+
+#endif  // NETINDEX_H
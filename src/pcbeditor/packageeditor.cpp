@@ -3,6 +3,7 @@
 
 #include "exceptiondata.h"
 #include "function.h"
+#include "library.h"
 #include "packageeditor.h"
 #include "ui_packageeditor.h"
 #include <QFile>
@@ -355,14 +356,8 @@ void PackageEditor::openFile()
         return;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-    QByteArray array = file.readAll();
-    file.close();
-
     try {
-        readPackages(array);
+        packages = Library::parsePackages(Library::readFile(fileName), fileName);
         if (!packages.empty()) {
             package = packages[0];
             updateElement();
@@ -435,28 +430,6 @@ void PackageEditor::paintEvent(QPaintEvent *)
     element.draw(painter, layers, options);
 }
 
-void PackageEditor::readPackages(const QByteArray &byteArray)
-{
-    QJsonParseError error;
-    QString str;
-
-    QJsonDocument document(QJsonDocument::fromJson(byteArray, &error));
-    if (document.isNull())
-        throw ExceptionData("Packages file read error: " + error.errorString() +
-                            ", offset: " + str.setNum(error.offset));
-
-    QJsonObject object = document.object();
-
-    if (object["object"].toString() != "packages")
-        throw ExceptionData("File is not a packages file");
-
-    QJsonArray packageArray(object["packages"].toArray());
-    for (auto p : packageArray) {
-        Package package(p);
-        packages.push_back(package);
-    }
-}
-
 void PackageEditor::saveFile()
 {
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save pkg file"),
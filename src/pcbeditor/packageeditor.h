@@ -65,7 +65,6 @@ private:
     void centerElement();
     QString padShape(const PadTypeParams &padTypeParams);
     void paintEvent(QPaintEvent *);
-    void readPackages(const QByteArray &byteArray);
     void selectRadioButton(int number, bool state);
     void setPadTypeLineEdit(QLabel *label, const QString &labelText, QLineEdit *lineEdit,
                             const QString &lineEditText, bool state);
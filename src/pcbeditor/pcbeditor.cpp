@@ -4,13 +4,16 @@
 #include "copperbalance.h"
 #include "exceptiondata.h"
 #include "function.h"
+#include "gerber.h"
 #include "globaloptions.h"
 #include "jumperselector.h"
 #include "localoptions.h"
 #include "pcbeditor.h"
 #include <cmath>
+#include <QCoreApplication>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QIODevice>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -19,11 +22,12 @@
 #include <QListWidget>
 #include <QMessageBox>
 #include <QPushButton>
-#include <QSvgGenerator>
+#include <QStatusBar>
 #include <QTextStream>
 #include <QVBoxLayout>
 
-PcbEditor::PcbEditor(QWidget *parent) : QMainWindow(parent)
+PcbEditor::PcbEditor(QWidget *parent) : QMainWindow(parent), job(board),
+    editLog("pcbeditor-autosave")
 {
     setupUi(this);
 
@@ -32,14 +36,24 @@ PcbEditor::PcbEditor(QWidget *parent) : QMainWindow(parent)
     connect(actionSaveFile, SIGNAL(triggered()), this, SLOT(saveFile()));
     connect(actionCloseFile, SIGNAL(triggered()), this, SLOT(closeFile()));
     connect(actionQuit, SIGNAL(triggered()), this, SLOT(close()));
+    connect(actionUndo, SIGNAL(triggered()), this, SLOT(undo()));
+    connect(actionRedo, SIGNAL(triggered()), this, SLOT(redo()));
     connect(actionSaveErrorCheck, SIGNAL(triggered()), this, SLOT(saveErrorCheck()));
+    connect(actionSaveGerber, SIGNAL(triggered()), this, SLOT(saveGerber()));
     connect(actionSaveSVG, SIGNAL(triggered()), this, SLOT(saveSVG()));
     connect(actionSaveJSON, SIGNAL(triggered()), this, SLOT(saveJSON()));
     connect(actionGlobalOptions, SIGNAL(triggered()), this, SLOT(globalOptions()));
     connect(actionLocalOptions, SIGNAL(triggered()), this, SLOT(localOptions()));
     connect(actionPackageEditor, SIGNAL(triggered()), this, SLOT(openPackageEditor()));
     connect(actionCopperBalance, SIGNAL(triggered()), this, SLOT(copperBalance()));
+    connect(actionCompareRouteStrategies, SIGNAL(triggered()),
+            this, SLOT(compareRouteStrategies()));
+    connect(actionSaveRouteStats, SIGNAL(triggered()), this, SLOT(saveRouteStats()));
+    connect(actionShapeRoute, SIGNAL(triggered()), this, SLOT(shapeRoute()));
+    connect(actionShapeRouteArcs, SIGNAL(triggered()), this, SLOT(shapeRouteArcs()));
+    connect(actionTwoLayerRoute, SIGNAL(triggered()), this, SLOT(twoLayerRoute()));
     connect(actionAbout, SIGNAL(triggered()), this, SLOT(about()));
+    connect(&jobTimer, SIGNAL(timeout()), this, SLOT(updateJob()));
 
     QCheckBox *tmpCheckBox[checkBoxes] =
     {
@@ -118,6 +132,7 @@ PcbEditor::PcbEditor(QWidget *parent) : QMainWindow(parent)
     gridLineEdit->setText(str.setNum(grid[gridNumber]));
     space = board.defaultPolygonSpace;
     spaceLineEdit->setText(str.setNum(space));
+    routeStrategy = 0;
     turningRadius = defaultTurningRadius;
     turningRadiusLineEdit->setText(str.setNum(turningRadius));
     viaDiameter = defaultViaDiameter;
@@ -135,6 +150,27 @@ PcbEditor::PcbEditor(QWidget *parent) : QMainWindow(parent)
     stepLineEdit->setText(str.setNum(step));
 
     showGrid = true;
+
+    // Board of interrupted session
+    if (editLog.canRecover() &&
+        QMessageBox::question(this, tr("Recovery"), tr("Recover unsaved board?")) ==
+        QMessageBox::Yes) {
+        try {
+            editLog.recover([this](const QByteArray &snapshot) { board.fromJson(snapshot); },
+                            [this](const JournalChange &change, bool undo) {
+                                board.applyChange(change, undo);
+                            });
+            centerBoardBorder();
+            actionOpenFile->setEnabled(false);
+            actionCloseFile->setEnabled(true);
+        }
+        catch (ExceptionData &e) {
+            QMessageBox::warning(this, tr("Error"), e.show());
+        }
+    }
+
+    editLog.attach(board.journal, [this]() { return board.toJsonData(); });
+    editLog.snapshot();
 }
 
 void PcbEditor::about()
@@ -180,9 +216,27 @@ void PcbEditor::closeFile()
     // buttonsSetEnabled("000000");
 }
 
+// Best strategy is used by next shape routes
+void PcbEditor::compareRouteStrategies()
+{
+    Via via(0, 0);
+    via.diameter = viaDiameter;
+    via.innerDiameter = viaInnerDiameter;
+    int radius = turningRadius;
+
+    startJob(tr("Compare route strategies"), [via, radius](Board &b) {
+        return b.compareRouteStrategies(via, radius);
+    }, [this](int result) {
+        if (result >= 0)
+            routeStrategy = result;
+        QMessageBox::information(this, tr("Route Strategies"), board.message);
+    });
+}
+
 void PcbEditor::copperBalance()
 {
-    CopperBalance cb(board);
+    board.pourPolygons();
+    CopperBalance cb(board.snapshot());
     cb.exec();
 }
 
@@ -192,6 +246,7 @@ void PcbEditor::globalOptions()
     options.openMaskOnVia = board.openMaskOnVia;
     options.padCornerRadius = Element::padCornerRadius;
     options.solderMaskSwell = board.solderMaskSwell;
+    options.netClasses = board.netClasses;
 
     GlobalOptions globalOptions(options);
     int n = globalOptions.exec();
@@ -201,13 +256,20 @@ void PcbEditor::globalOptions()
         Element::padCornerRadius = options.padCornerRadius;
         for (auto &e : board.elements)
             e.roundPadCorners();
+        board.setSnapshotDirty();
         board.solderMaskSwell = options.solderMaskSwell;
+        board.netClasses = options.netClasses;
         update();
     }
 }
 
 void PcbEditor::keyPressEvent(QKeyEvent *event)
 {
+    if (event->key() == Qt::Key_Escape && job.isRunning()) {
+        job.cancel();
+        return;
+    }
+
 /*  switch (command) {
     case PLACE_NET_NAME:
         if (board.selectedWire)
@@ -482,6 +544,22 @@ void PcbEditor::paintEvent(QPaintEvent *)
     board.draw(painter, fontSize, scale);
 }
 
+void PcbEditor::redo()
+{
+    board.selectedElement = false;
+    board.selectedPad = false;
+    board.pointNumber = 0;
+
+    try {
+        board.redo();
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+
+    update();
+}
+
 void PcbEditor::saveErrorCheck()
 {
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save erc file"),
@@ -509,34 +587,57 @@ void PcbEditor::saveFile()
     if (!file.open(QIODevice::WriteOnly))
         return;
 
-    QJsonDocument document(board.toJson());
-    QByteArray array(document.toJson());
-
-    file.write(array);
+    file.write(board.toJsonData());
     file.close();
 }
 
-void PcbEditor::saveSVG()
+// Gerber layers and drill file are named by selected file
+void PcbEditor::saveGerber()
 {
-    constexpr int x = 0;
-    constexpr int y = 0;
-    constexpr int width = 1500;
-    constexpr int height = 1000;
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save gerber files"),
+                       boardDirectory, tr("gerber files (*.gbr)"));
+    if (fileName.isNull())
+        return;
+
+    QFileInfo fileInfo(fileName);
+
+    try {
+        board.pourPolygons();
+        Gerber(board.snapshot()).write(fileInfo.path() + "/" + fileInfo.completeBaseName());
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+}
+
+void PcbEditor::saveRouteStats()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save route statistics"),
+                       boardDirectory, tr("csv files (*.csv)"));
+    if (fileName.isNull())
+        return;
 
+    try {
+        board.writeRouteStats(fileName);
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+}
+
+void PcbEditor::saveSVG()
+{
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save svg file"),
                        boardDirectory, tr("svg files (*.svg)"));
+    if (fileName.isNull())
+        return;
 
-    QSvgGenerator generator;
-    generator.setFileName(fileName);
-    generator.setSize(QSize(width, height));
-    generator.setViewBox(QRect(x, y, width, height));
-    generator.setTitle(tr("Board"));
-    generator.setDescription(tr("Board"));
-    QPainter painter;
-    painter.begin(&generator);
-    painter.fillRect(x, y, width, height, Qt::white);
-    board.draw(painter, fontSize, scale);
-    painter.end();
+    try {
+        board.writeSVG(fileName, fontSize);
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
 }
 
 void PcbEditor::saveJSON()
@@ -582,9 +683,9 @@ bool PcbEditor::selectJumper(QString &packageName)
 {
     QStringList jumperSymbolNames;
 
-    for (auto p : Element::packages)
-        if (p.pads.size() == 2)
-            jumperSymbolNames += p.name;
+    for (int i = 0; i < Library::packages().size(); i++)
+        if (Library::packages().padsNumber(i) == 2)
+            jumperSymbolNames += Library::packages().name(i);
 
     JumperSelector jumperSelector(jumperSymbolNames, packageName);
 
@@ -667,7 +768,6 @@ void PcbEditor::selectRadioButton()
 
 void PcbEditor::selectToolButton(int number)
 {
-    int tmp;
     QString str;
 
     bool isElementLayer = board.layers.edit == TOP_LAYER ||
@@ -683,7 +783,7 @@ void PcbEditor::selectToolButton(int number)
             board.pointNumber = 0;
         break;
     case CREATE_GROUPS:
-        board.createGroups();
+        startJob(tr("Create groups"), [](Board &b) { b.createGroups(); return 0; });
         break;
     case DECREASE_STEP:
         step /= 4;
@@ -724,7 +824,7 @@ void PcbEditor::selectToolButton(int number)
         board.selectedWire = false;
         break;*/
     case PLACE_ELEMENTS:
-        board.placeElements();
+        startJob(tr("Place elements"), [](Board &b) { b.placeElements(); return 0; });
         break;
     case PLACE_JUMPER:
         if (!selectJumper(board.packageName))
@@ -741,11 +841,11 @@ void PcbEditor::selectToolButton(int number)
             board.pointNumber = 0;
         break;
     case ROUTE_TRACKS:
-        board.routeTracks();
+        startJob(tr("Route tracks"), [](Board &b) { b.routeTracks(); return 0; });
         break;
     case SEGMENT_NETS:
         if (isElementLayer)
-            board.segmentNets();
+            startJob(tr("Segment nets"), [](Board &b) { return int(b.segmentNets()); });
         break;
     case SELECT:
         board.packageName.clear();
@@ -765,12 +865,12 @@ void PcbEditor::selectToolButton(int number)
     /* case UPDATE_NETS:
         break; */
     case TABLE_ROUTE:
-        board.tableRoute();
+        startJob(tr("Table route"), [](Board &b) { return b.tableRoute(); });
         break;
     case WAVE_ROUTE:
         stepLineEdit->setText(str.setNum(0));
-        tmp = board.waveRoute();
-        stepLineEdit->setText(str.setNum(tmp));
+        startJob(tr("Wave route"), [](Board &b) { return b.waveRoute(); },
+                 [this](int result) { stepLineEdit->setText(QString::number(result)); });
         break;
     case ZOOM_IN:
         gridNumber -= 2;
@@ -785,6 +885,90 @@ void PcbEditor::selectToolButton(int number)
     update();
 }
 
+void PcbEditor::shapeRoute()
+{
+    RouteStrategy strategy(RouteStrategy::strategies()[routeStrategy]);
+    startJob(tr("Shape route"), [strategy](Board &b) {
+        return b.shapeRoute(Via(0, 0), 0, strategy);
+    });
+}
+
+// Corners are rounded by turning radius of editor
+void PcbEditor::shapeRouteArcs()
+{
+    int radius = turningRadius;
+    RouteStrategy strategy(RouteStrategy::strategies()[routeStrategy]);
+    startJob(tr("Shape route"), [radius, strategy](Board &b) {
+        return b.shapeRoute(Via(0, 0), radius, strategy);
+    });
+}
+
+void PcbEditor::startJob(const QString &name, const BoardJob::Function &function,
+                         const BoardJob::DoneFunction &done)
+{
+    try {
+        job.start(name, function, done);
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+        return;
+    }
+
+    statusBar()->showMessage(name + ": 0%");
+    jobTimer.start(jobInterval);
+}
+
+// Vias of local options are placed at layer changes
+void PcbEditor::twoLayerRoute()
+{
+    Via via(0, 0);
+    via.diameter = viaDiameter;
+    via.innerDiameter = viaInnerDiameter;
+    RouteStrategy strategy(RouteStrategy::strategies()[routeStrategy]);
+    startJob(tr("Two layer route"), [via, strategy](Board &b) {
+        return b.shapeRoute(via, 0, strategy);
+    });
+}
+
+void PcbEditor::undo()
+{
+    board.selectedElement = false;
+    board.selectedPad = false;
+    board.pointNumber = 0;
+
+    try {
+        board.undo();
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+
+    update();
+}
+
+void PcbEditor::updateJob()
+{
+    QString text;
+
+    try {
+        if (!job.finish(text)) {
+            statusBar()->showMessage(job.name() +
+                QString(": %1%  Esc: cancel").arg(job.percent()));
+            return;
+        }
+    }
+    catch (ExceptionData &e) {
+        jobTimer.stop();
+        statusBar()->clearMessage();
+        QMessageBox::warning(this, tr("Error"), e.show());
+        return;
+    }
+
+    jobTimer.stop();
+    statusBar()->showMessage(text, jobMessageTimeout);
+    update();
+}
+
 void PcbEditor::writeLibraryFile(QString filename, QJsonObject object)
 {
     QFile file("library/json/" + filename);
@@ -5,6 +5,8 @@
 #define PCBEDITOR_H
 
 #include "board.h"
+#include "boardjob.h"
+#include "editlog.h"
 #include "packageeditor.h"
 #include "ui_pcbeditor.h"
 #include <QJsonObject>
@@ -13,6 +15,7 @@
 #include <QMouseEvent>
 #include <QPushButton>
 #include <QSignalMapper>
+#include <QTimer>
 #include <QToolButton>
 
 static const char *boardDirectory = "";
@@ -60,6 +63,9 @@ private:
     void centerBoardBorder();
     void paintEvent(QPaintEvent *);
     bool selectJumper(QString &packageName);
+    // Board operation on worker thread, status bar shows progress
+    void startJob(const QString &name, const BoardJob::Function &function,
+                  const BoardJob::DoneFunction &done = nullptr);
     void writeLibraryFile(QString filename, QJsonObject object);
     // Set buttons: left, right, up, down, zoom in, zoom out
     // void buttonsSetEnabled(const char *params);
@@ -67,14 +73,18 @@ private:
 private slots:
     void about();
     void closeFile();
+    void compareRouteStrategies();
     void copperBalance();
     void globalOptions();
     void localOptions();
     void newFile();
     void openFile();
     void openPackageEditor();
+    void redo();
     void saveErrorCheck();
     void saveFile();
+    void saveGerber();
+    void saveRouteStats();
     void saveSVG();
     void saveJSON();
     void selectCheckBox(int number);
@@ -82,6 +92,11 @@ private slots:
     void selectPushButton(int number);
     void selectRadioButton();
     void selectToolButton(int number);
+    void shapeRoute();
+    void shapeRouteArcs();
+    void twoLayerRoute();
+    void undo();
+    void updateJob();
 
 private:
     static constexpr int defaultFontSize = 10;
@@ -95,6 +110,8 @@ private:
     static constexpr int gridY = 30;
     static constexpr int gridCenterX = 570;
     static constexpr int gridCenterY = 400;
+    static constexpr int jobInterval = 200;         // ms
+    static constexpr int jobMessageTimeout = 5000;  // ms
     static constexpr int spaceStep = 100;  // um
     static constexpr int widthStep = 100;
     static constexpr int maxX = 10000;
@@ -123,6 +140,7 @@ private:
     int gridNumber;
     int orientation;
     int previousCommand;
+    int routeStrategy;      // strategy of shape route
     int space;
     int step;
     int turningRadius;
@@ -130,6 +148,8 @@ private:
     int viaInnerDiameter;
     int width;
     Board board;
+    BoardJob job;
+    EditLog editLog;
     PackageEditor packageEditor;
     QPoint mousePoint;
     QSignalMapper *checkBoxMapper;
@@ -137,6 +157,7 @@ private:
     QSignalMapper *radioButtonMapper;
     QSignalMapper *pushButtonMapper;
     QSignalMapper *toolButtonMapper;
+    QTimer jobTimer;
     QCheckBox *checkBox[checkBoxes];
     QCheckBox *layerCheckBox[layersNumber];
     QRadioButton *radioButton[radioButtons];
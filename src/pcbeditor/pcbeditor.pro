@@ -14,34 +14,52 @@ DEFINES += QT_DEPRECATED_WARNINGS
 include(../common/common.pri)
 
 SOURCES += board.cpp \
+    boardjob.cpp \
+    boardsnapshot.cpp \
+    cluster.cpp \
     copperbalance.cpp \
     element.cpp \
     function.cpp \
+    gerber.cpp \
     globaloptions.cpp \
     jumperselector.cpp \
     layers.cpp \
     localoptions.cpp \
     main.cpp \
+    netindex.cpp \
     packageeditor.cpp \
     pcbeditor.cpp \
     pcbtypes.cpp \
+    pour.cpp \
+    ratsnest.cpp \
     router.cpp \
+    routestrategy.cpp \
+    shaperouter.cpp \
     text.cpp \
     track.cpp
 
 HEADERS += board.h \
+    boardjob.h \
+    boardsnapshot.h \
+    chunkedvector.h \
+    cluster.h \
     copperbalance.h \
     element.h \
-    exceptiondata.h \
     function.h \
+    gerber.h \
     globaloptions.h \
     jumperselector.h \
     layers.h \
     localoptions.h \
+    netindex.h \
     packageeditor.h \
     pcbeditor.h \
     pcbtypes.h \
+    pour.h \
+    ratsnest.h \
     router.h \
+    routestrategy.h \
+    shaperouter.h \
     text.h \
     track.h
 
@@ -6,6 +6,7 @@
 #include <cmath>
 #include <QJsonArray>
 #include <QPainterPath>
+#include <QTransform>
 
 Polygon::Polygon(const QJsonValue &value)
 {
@@ -30,7 +31,7 @@ bool Polygon::center(int &x, int &y)
     double x2 = 0;
     double y2 = 0;
 
-    for (auto p : points) {
+    for (const auto &p : points) {
         x2 += p.x;
         y2 += p.y;
     }
@@ -41,7 +42,7 @@ bool Polygon::center(int &x, int &y)
     return true;
 }
 
-void Polygon::draw(QPainter &painter, double scale, QBrush brush)
+void Polygon::draw(QPainter &painter, double scale, const QBrush &brush) const
 {
     QPainterPath path;
 
@@ -52,7 +53,7 @@ void Polygon::draw(QPainter &painter, double scale, QBrush brush)
         path.lineTo(scale * points[0].x, scale * points[0].y);
         painter.drawPath(path);
         if (fill)
-            painter.fillPath(path, brush);
+            painter.fillPath(QTransform::fromScale(scale, scale).map(fillPath), brush);
     }
 }
 
@@ -75,7 +76,7 @@ bool Polygon::hasInnerPoint(int x, int y)
 {
     int b = 0;
 
-    for (auto p : points) {
+    for (const auto &p : points) {
         if (p.x < x && p.y < y)
             b |= 1;
         if (p.x < x && p.y > y)
@@ -91,10 +92,10 @@ bool Polygon::hasInnerPoint(int x, int y)
     return false;
 }
 
-QJsonObject Polygon::toJson()
+QJsonObject Polygon::toJson() const
 {
     QJsonArray pointArray;
-    for (auto p : points)
+    for (const auto &p : points)
         pointArray.append(p.toJson());
 
     QJsonObject object
@@ -126,7 +127,7 @@ Via::Via(const QJsonValue &value)
     y = object["y"].toInt();
 }
 
-void Via::draw(QPainter &painter, int layerNumber, double scale, int space)
+void Via::draw(QPainter &painter, int layerNumber, double scale, int space) const
 {
     if (layerNumber != TOP_VIA_LAYER && layerNumber != BOTTOM_VIA_LAYER)
         return;
@@ -161,7 +162,7 @@ void Via::draw(QPainter &painter, int layerNumber, double scale, int space)
     }
 }
 
-bool Via::exist(int x_, int y_)
+bool Via::exist(int x_, int y_) const
 {
     int r = diameter / 2;
 
@@ -183,7 +184,7 @@ void Via::fromJson(const QJsonValue &value)
     y = object["y"].toInt();
 }
 
-QJsonObject Via::toJson()
+QJsonObject Via::toJson() const
 {
     QJsonObject object
     {
@@ -9,28 +9,24 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QPainter>
+#include <QPainterPath>
 #include <vector>
 
-class Net
-{
-public:
-    int number;               // net number
-    std::vector<Point> pads;  // x: element, y: pad
-};
-
 class Polygon
 {
 public:
     Polygon() {}
     Polygon(const QJsonValue &value);
     bool center(int &x, int &y);
-    void draw(QPainter &painter, double scale, QBrush brush);
+    void draw(QPainter &painter, double scale, const QBrush &brush) const;
     void fromJson(const QJsonValue &value);
     bool hasInnerPoint(int x, int y);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     bool fill;
     int net;
+    unsigned long long fillHash = 0;    // copper of last fill
+    QPainterPath fillPath;              // fill with clearance, unscaled
     std::vector<Point> points;
 };
 
@@ -41,10 +37,10 @@ public:
     Via() {}
     Via(int x, int y);
     Via(const QJsonValue &value);
-    void draw(QPainter &painter, int layerNumber, double scale, int space = 0);
-    bool exist(int x_, int y_);
+    void draw(QPainter &painter, int layerNumber, double scale, int space = 0) const;
+    bool exist(int x_, int y_) const;
     void fromJson(const QJsonValue &value);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int diameter;
     int innerDiameter;
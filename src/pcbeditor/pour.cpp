@@ -0,0 +1,258 @@
+// pour.cpp
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#include "pour.h"
+#include <QPainterPathStroker>
+#include <algorithm>
+
+namespace {
+
+void mix(unsigned long long &hash, long long value)
+{
+    hash = (hash ^ (unsigned long long) value) * 1099511628211ull;
+}
+
+// Axis aligned bounds of feature with space
+class Bounds
+{
+public:
+    bool overlaps(const Bounds &b) const
+    {
+        return x1 <= b.x2 && b.x1 <= x2 && y1 <= b.y2 && b.y1 <= y2;
+    }
+
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+};
+
+Bounds padBounds(const Pad &pad, int space)
+{
+    int r = std::max(std::max(pad.width, pad.height), pad.diameter) / 2 + space;
+    return Bounds{pad.x - r, pad.y - r, pad.x + r, pad.y + r};
+}
+
+Bounds segmentBounds(const Segment &s, int space)
+{
+    int r = s.width / 2 + space;
+    if (s.type == Segment::ARC) {
+        r += s.radius;
+        return Bounds{s.x0 - r, s.y0 - r, s.x0 + r, s.y0 + r};
+    }
+    return Bounds{std::min(s.x1, s.x2) - r, std::min(s.y1, s.y2) - r,
+                  std::max(s.x1, s.x2) + r, std::max(s.y1, s.y2) + r};
+}
+
+Bounds viaBounds(const Via &v, int space)
+{
+    int r = v.diameter / 2 + space;
+    return Bounds{v.x - r, v.y - r, v.x + r, v.y + r};
+}
+
+Bounds polygonBounds(const Polygon &polygon)
+{
+    Bounds b{0, 0, -1, -1};
+
+    if (polygon.points.empty())
+        return b;
+
+    b = Bounds{polygon.points[0].x, polygon.points[0].y,
+               polygon.points[0].x, polygon.points[0].y};
+    for (auto &p : polygon.points) {
+        b.x1 = std::min(b.x1, p.x);
+        b.y1 = std::min(b.y1, p.y);
+        b.x2 = std::max(b.x2, p.x);
+        b.y2 = std::max(b.y2, p.y);
+    }
+
+    return b;
+}
+
+}
+
+Pour::Pour(const std::vector<Element> &elements, const std::list<Segment> &segments,
+           const std::list<Via> &vias, bool top, int clearance):
+    top(top), clearance(clearance), elements(elements), segments(segments), vias(vias)
+{
+}
+
+// Pad shape as drawn by element, enlarged by space
+void Pour::addPad(QPainterPath &path, const Pad &pad, int space)
+{
+    int d = pad.diameter;
+    int h = pad.height;
+    int w = pad.width;
+
+    if (pad.orientation == Element::RIGHT)
+        std::swap(w, h);
+    if (h == 0 || w == 0) {
+        h = d;
+        w = d;
+    }
+    h += 2 * space;
+    w += 2 * space;
+    double r = d / 2 + space;
+
+    path.addRoundedRect(pad.x - w / 2., pad.y - h / 2., w, h, r, r);
+}
+
+void Pour::addSegment(QPainterPath &path, const Segment &segment, int space)
+{
+    int w = segment.width + 2 * space;
+    QPainterPath center;
+
+    if (segment.type == Segment::ARC) {
+        int r = segment.radius;
+        QRectF rect(segment.x0 - r, segment.y0 - r, 2 * r, 2 * r);
+        center.arcMoveTo(rect, segment.startAngle);
+        center.arcTo(rect, segment.startAngle, segment.spanAngle);
+    }
+    else {
+        if (segment.x1 == segment.x2 && segment.y1 == segment.y2) {
+            path.addEllipse(QPointF(segment.x1, segment.y1), w / 2., w / 2.);
+            return;
+        }
+        center.moveTo(segment.x1, segment.y1);
+        center.lineTo(segment.x2, segment.y2);
+    }
+
+    QPainterPathStroker stroker;
+    stroker.setWidth(w);
+    stroker.setCapStyle(Qt::RoundCap);
+    stroker.setJoinStyle(Qt::RoundJoin);
+    path.addPath(stroker.createStroke(center));
+}
+
+void Pour::addVia(QPainterPath &path, const Via &via, int space)
+{
+    double r = via.diameter / 2. + space;
+    path.addEllipse(QPointF(via.x, via.y), r, r);
+}
+
+// Polygon minus other net copper with clearance. Pads of polygon net
+// get clearance ring crossed by four spokes, vias and segments of
+// polygon net are joined to fill directly.
+QPainterPath Pour::fill(const Polygon &polygon) const
+{
+    QPainterPath area = outline(polygon);
+    if (area.isEmpty())
+        return area;
+
+    Bounds bounds = polygonBounds(polygon);
+    QPainterPath cut;       // other net copper and pad reliefs
+    QPainterPath other;     // other net copper
+    QPainterPath spokes;
+    cut.setFillRule(Qt::WindingFill);
+    other.setFillRule(Qt::WindingFill);
+    spokes.setFillRule(Qt::WindingFill);
+
+    auto sameNet = [&polygon](int net) { return polygon.net >= 0 && net == polygon.net; };
+
+    for (auto &s : segments)
+        if (!sameNet(s.net) && segmentBounds(s, clearance).overlaps(bounds))
+            addSegment(other, s, clearance);
+
+    for (auto &v : vias)
+        if (!sameNet(v.net) && viaBounds(v, clearance).overlaps(bounds))
+            addVia(other, v, clearance);
+
+    for (auto &e : elements)
+        for (auto &p : e.pads) {
+            if (!hasPad(e, p) || !padBounds(p, clearance).overlaps(bounds))
+                continue;
+            if (!sameNet(p.net)) {
+                addPad(other, p, clearance);
+                continue;
+            }
+            addPad(cut, p, clearance);
+            int r = std::max(std::max(p.width, p.height), p.diameter) / 2 +
+                    clearance + thermalSpokeWidth;
+            int s = thermalSpokeWidth / 2;
+            spokes.addRect(p.x - r, p.y - s, 2 * r, 2 * s);
+            spokes.addRect(p.x - s, p.y - r, 2 * s, 2 * r);
+        }
+
+    cut.addPath(other);
+    QPainterPath copper = area.subtracted(cut);
+    if (!spokes.isEmpty())
+        copper = copper.united(spokes.intersected(area).subtracted(other));
+
+    return copper;
+}
+
+bool Pour::hasPad(const Element &element, const Pad &pad) const
+{
+    return pad.innerDiameter > 0 || element.onTop == top;
+}
+
+// Fill changes only if polygon or copper inside it changes
+unsigned long long Pour::hash(const Polygon &polygon) const
+{
+    unsigned long long h = 14695981039346656037ull;
+    Bounds bounds = polygonBounds(polygon);
+
+    mix(h, polygon.net);
+    mix(h, clearance);
+    for (auto &p : polygon.points) {
+        mix(h, p.x);
+        mix(h, p.y);
+    }
+
+    for (auto &s : segments)
+        if (segmentBounds(s, clearance).overlaps(bounds)) {
+            mix(h, s.type);
+            mix(h, s.net);
+            mix(h, s.width);
+            if (s.type == Segment::ARC) {
+                mix(h, s.x0);
+                mix(h, s.y0);
+                mix(h, s.radius);
+                mix(h, s.startAngle);
+                mix(h, s.spanAngle);
+            }
+            else {
+                mix(h, s.x1);
+                mix(h, s.y1);
+                mix(h, s.x2);
+                mix(h, s.y2);
+            }
+        }
+
+    for (auto &v : vias)
+        if (viaBounds(v, clearance).overlaps(bounds)) {
+            mix(h, v.net);
+            mix(h, v.diameter);
+            mix(h, v.x);
+            mix(h, v.y);
+        }
+
+    for (auto &e : elements)
+        for (auto &p : e.pads)
+            if (hasPad(e, p) && padBounds(p, clearance).overlaps(bounds)) {
+                mix(h, p.net);
+                mix(h, p.diameter);
+                mix(h, p.width);
+                mix(h, p.height);
+                mix(h, p.orientation);
+                mix(h, p.x);
+                mix(h, p.y);
+            }
+
+    return h;
+}
+
+QPainterPath Pour::outline(const Polygon &polygon)
+{
+    QPainterPath path;
+
+    if (polygon.points.size() > 2) {
+        path.moveTo(polygon.points[0].x, polygon.points[0].y);
+        for (uint i = 1; i < polygon.points.size(); i++)
+            path.lineTo(polygon.points[i].x, polygon.points[i].y);
+        path.closeSubpath();
+    }
+
+    return path;
+}
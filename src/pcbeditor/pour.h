@@ -0,0 +1,41 @@
+// pour.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef POUR_H
+#define POUR_H
+
+#include "element.h"
+#include "pcbtypes.h"
+#include "track.h"
+#include <QPainterPath>
+#include <list>
+#include <vector>
+
+// Copper fill of polygon: other net copper is cut out with clearance,
+// pads of polygon net are connected by thermal spokes
+class Pour
+{
+public:
+    static constexpr int thermalSpokeWidth = 400;
+
+    Pour(const std::vector<Element> &elements, const std::list<Segment> &segments,
+         const std::list<Via> &vias, bool top, int clearance);
+    static void addPad(QPainterPath &path, const Pad &pad, int space);
+    static void addSegment(QPainterPath &path, const Segment &segment, int space);
+    static void addVia(QPainterPath &path, const Via &via, int space);
+    QPainterPath fill(const Polygon &polygon) const;
+    unsigned long long hash(const Polygon &polygon) const;
+    static QPainterPath outline(const Polygon &polygon);
+
+private:
+    bool hasPad(const Element &element, const Pad &pad) const;
+
+    bool top;
+    int clearance;
+    const std::vector<Element> &elements;
+    const std::list<Segment> &segments;
+    const std::list<Via> &vias;
+};
+
+#endif  // POUR_H
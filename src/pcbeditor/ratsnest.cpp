@@ -0,0 +1,411 @@
+// ratsnest.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "ratsnest.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+static int findRoot(std::vector<int> &parent, int n)
+{
+    while (parent[n] != n) {
+        parent[n] = parent[parent[n]];
+        n = parent[n];
+    }
+
+    return n;
+}
+
+static bool joinRoots(std::vector<int> &parent, int n1, int n2)
+{
+    n1 = findRoot(parent, n1);
+    n2 = findRoot(parent, n2);
+    if (n1 == n2)
+        return false;
+    parent[n2] = n1;
+
+    return true;
+}
+
+void Ratsnest::addEndPoint(int layer, int x, int y, int radius, int node)
+{
+    EndPoint endPoint;
+
+    endPoint.island = node;
+    endPoint.radius = radius;
+    endPoint.x = x;
+    endPoint.y = y;
+    grids[layer][cell(cellNumber(x), cellNumber(y))].push_back(endPoints.size());
+    endPoints.push_back(endPoint);
+}
+
+unsigned long long Ratsnest::cell(int cellX, int cellY)
+{
+    return (unsigned long long) (unsigned int) cellX << 32 | (unsigned int) cellY;
+}
+
+int Ratsnest::cellNumber(int x)
+{
+    return x >= 0 ? x / cellSize : (x + 1) / cellSize - 1;
+}
+
+void Ratsnest::clear()
+{
+    allDirty = true;
+    copperHash = 0;
+    totalLength = 0;
+    dirtyNets.clear();
+    endPoints.clear();
+    grids[0].clear();
+    grids[1].clear();
+    lengths.clear();
+    lines.clear();
+}
+
+// Bowyer-Watson triangulation, points are added in x order and triangles
+// left of current point are closed, returns edges (i, j), i < j
+std::vector<std::pair<int, int>> Ratsnest::delaunayEdges(const std::vector<Point> &points)
+{
+    class Triangle
+    {
+    public:
+        int a, b, c;
+        double x, y;    // circumcircle center
+        double r2;      // squared radius
+    };
+
+    int n = points.size();
+    double minX = points[0].x, maxX = minX;
+    double minY = points[0].y, maxY = minY;
+    std::vector<double> px(n + 3);
+    std::vector<double> py(n + 3);
+    std::vector<int> order(n);
+    std::vector<std::pair<int, int>> edges;
+    std::vector<std::pair<int, int>> polygon;
+    std::vector<Triangle> open;
+    std::vector<Triangle> closed;
+
+    for (auto &p : points) {
+        minX = std::min(minX, double(p.x));
+        maxX = std::max(maxX, double(p.x));
+        minY = std::min(minY, double(p.y));
+        maxY = std::max(maxY, double(p.y));
+    }
+
+    // Coordinates from bounding box center
+    double d = std::max(maxX - minX, maxY - minY) + 1;
+    for (int i = 0; i < n; i++) {
+        px[i] = points[i].x - 0.5 * (minX + maxX);
+        py[i] = points[i].y - 0.5 * (minY + maxY);
+    }
+
+    // Super triangle
+    px[n] = -20 * d;
+    py[n] = -d;
+    px[n+1] = 0;
+    py[n+1] = 20 * d;
+    px[n+2] = 20 * d;
+    py[n+2] = -d;
+
+    auto triangle = [&px, &py](int a, int b, int c) {
+        Triangle t;
+        t.a = a;
+        t.b = b;
+        t.c = c;
+        double ax = px[a], ay = py[a];
+        double bx = px[b], by = py[b];
+        double cx = px[c], cy = py[c];
+        double d = 2 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+        if (fabs(d) < minValue) {   // collinear points
+            t.x = 0;
+            t.y = 0;
+            t.r2 = HUGE_VAL;
+            return t;
+        }
+        double a2 = ax * ax + ay * ay;
+        double b2 = bx * bx + by * by;
+        double c2 = cx * cx + cy * cy;
+        t.x = (a2 * (by - cy) + b2 * (cy - ay) + c2 * (ay - by)) / d;
+        t.y = (a2 * (cx - bx) + b2 * (ax - cx) + c2 * (bx - ax)) / d;
+        t.r2 = (ax - t.x) * (ax - t.x) + (ay - t.y) * (ay - t.y);
+        return t;
+    };
+
+    open.push_back(triangle(n, n + 1, n + 2));
+
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&px](int i, int j) { return px[i] < px[j]; });
+
+    for (int i : order) {
+        double x = px[i];
+        double y = py[i];
+        polygon.clear();
+        for (uint j = 0; j < open.size();) {
+            Triangle &t = open[j];
+            double dx = x - t.x;
+            double dy = y - t.y;
+            if (dx > 0 && dx * dx > t.r2) {
+                closed.push_back(t);
+            }
+            else if (dx * dx + dy * dy <= t.r2) {
+                polygon.push_back(std::make_pair(std::min(t.a, t.b), std::max(t.a, t.b)));
+                polygon.push_back(std::make_pair(std::min(t.b, t.c), std::max(t.b, t.c)));
+                polygon.push_back(std::make_pair(std::min(t.c, t.a), std::max(t.c, t.a)));
+            }
+            else {
+                j++;
+                continue;
+            }
+            open[j] = open.back();
+            open.pop_back();
+        }
+
+        // Edges of removed triangles, shared edges are inside hole
+        std::sort(polygon.begin(), polygon.end());
+        for (uint j = 0; j < polygon.size(); j++) {
+            if ((j + 1 < polygon.size() && polygon[j] == polygon[j+1]) ||
+                (j && polygon[j] == polygon[j-1]))
+                continue;
+            open.push_back(triangle(polygon[j].first, polygon[j].second, i));
+        }
+    }
+
+    closed.insert(closed.end(), open.begin(), open.end());
+    for (auto &t : closed) {
+        int v[3] = {t.a, t.b, t.c};
+        for (int j = 0; j < 3; j++) {
+            int a = v[j];
+            int b = v[(j+1)%3];
+            if (a < n && b < n)
+                edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    return edges;
+}
+
+// Segment ends and vias, connected ends have same island
+void Ratsnest::findIslands(const std::list<Segment> &topSegments,
+                           const std::list<Segment> &bottomSegments,
+                           const std::list<Via> &vias)
+{
+    const std::list<Segment> *segments[2] = {&topSegments, &bottomSegments};
+    int node = 0;
+    std::vector<int> parent;
+
+    endPoints.clear();
+    grids[0].clear();
+    grids[1].clear();
+
+    for (int layer = 0; layer < 2; layer++)
+        for (auto &s : *segments[layer]) {
+            parent.push_back(node);
+            addEndPoint(layer, s.x1, s.y1, 0, node++);
+            parent.push_back(node);
+            addEndPoint(layer, s.x2, s.y2, 0, node++);
+            joinRoots(parent, node - 2, node - 1);
+        }
+
+    for (auto &v : vias) {
+        parent.push_back(node);
+        addEndPoint(0, v.x, v.y, v.diameter / 2, node);
+        addEndPoint(1, v.x, v.y, v.diameter / 2, node++);
+    }
+
+    // Join ends inside via or at same point
+    for (int layer = 0; layer < 2; layer++)
+        for (auto &g : grids[layer])
+            for (int i : g.second) {
+                const EndPoint &e = endPoints[i];
+                int r = e.radius + endPointSpace;
+                for (int cx = cellNumber(e.x - r); cx <= cellNumber(e.x + r); cx++)
+                    for (int cy = cellNumber(e.y - r); cy <= cellNumber(e.y + r); cy++) {
+                        auto c = grids[layer].find(cell(cx, cy));
+                        if (c == grids[layer].end())
+                            continue;
+                        for (int j : c->second) {
+                            const EndPoint &e2 = endPoints[j];
+                            long long dx = e2.x - e.x;
+                            long long dy = e2.y - e.y;
+                            long long r2 = std::max(e.radius, e2.radius) + endPointSpace;
+                            if (dx * dx + dy * dy <= r2 * r2)
+                                joinRoots(parent, e.island, e2.island);
+                        }
+                    }
+            }
+
+    for (auto &e : endPoints)
+        e.island = findRoot(parent, e.island);
+}
+
+// Islands with ends inside pad
+void Ratsnest::padIslands(const Element &element, const Pad &pad,
+                          std::vector<int> &islands) const
+{
+    bool throughHole = pad.innerDiameter > 0;
+    int w = std::max(pad.width, pad.diameter) / 2;
+    int h = std::max(pad.height, pad.diameter) / 2;
+
+    islands.clear();
+
+    for (int layer = 0; layer < 2; layer++) {
+        if (!throughHole && element.onTop != !layer)
+            continue;
+        for (int cx = cellNumber(pad.x - w); cx <= cellNumber(pad.x + w); cx++)
+            for (int cy = cellNumber(pad.y - h); cy <= cellNumber(pad.y + h); cy++) {
+                auto c = grids[layer].find(cell(cx, cy));
+                if (c == grids[layer].end())
+                    continue;
+                for (int j : c->second) {
+                    const EndPoint &e = endPoints[j];
+                    if (abs(e.x - pad.x) <= w && abs(e.y - pad.y) <= h)
+                        islands.push_back(e.island);
+                }
+            }
+    }
+}
+
+void Ratsnest::setElementDirty(const Element &element)
+{
+    for (auto &p : element.pads)
+        if (p.net >= 0)
+            dirtyNets.insert(p.net);
+}
+
+// Copper is checked by hash, moved elements mark their nets
+void Ratsnest::update(const std::vector<Element> &elements, const NetIndex &nets,
+                      const std::list<Segment> &topSegments,
+                      const std::list<Segment> &bottomSegments,
+                      const std::list<Via> &vias)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    auto add = [&hash](int value) {
+        hash = (hash ^ (unsigned int) value) * 1099511628211ULL;
+    };
+
+    for (auto &s : topSegments) {
+        add(s.x1);
+        add(s.y1);
+        add(s.x2);
+        add(s.y2);
+    }
+    add(-1);
+    for (auto &s : bottomSegments) {
+        add(s.x1);
+        add(s.y1);
+        add(s.x2);
+        add(s.y2);
+    }
+    add(-1);
+    for (auto &v : vias) {
+        add(v.x);
+        add(v.y);
+        add(v.diameter);
+    }
+
+    if (hash != copperHash) {
+        copperHash = hash;
+        findIslands(topSegments, bottomSegments, vias);
+        allDirty = true;
+    }
+
+    if (allDirty) {
+        lines.clear();
+        lengths.clear();
+        for (int i = 0; i < nets.size(); i++)
+            updateNet(elements, nets, i);
+    }
+    else
+        for (int number : dirtyNets) {
+            int i = nets.find(number);
+            if (i >= 0)
+                updateNet(elements, nets, i);
+            else {
+                lines.erase(number);
+                lengths.erase(number);
+            }
+        }
+
+    allDirty = false;
+    dirtyNets.clear();
+
+    totalLength = 0;
+    for (auto &l : lengths)
+        totalLength += l.second;
+}
+
+void Ratsnest::updateNet(const std::vector<Element> &elements,
+                         const NetIndex &nets, int index)
+{
+    int number = nets.number(index);
+    double length = 0;
+    std::map<std::pair<int, int>, int> pointPad;    // first pad at point
+    std::unordered_map<int, int> islandPad;         // first pad of island
+    std::vector<int> islands;
+    std::vector<int> parent;
+    std::vector<int> uniquePads;
+    std::vector<Point> points;
+    std::vector<Point> uniquePoints;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<Line> &netLines = lines[number];
+
+    netLines.clear();
+
+    // Pads on same point or same copper island are joined
+    for (auto p = nets.begin(index); p != nets.end(index); ++p) {
+        const Element &element = elements[p->x];
+        const Pad &pad = element.pads[p->y];
+        int i = points.size();
+        points.push_back(Point(pad.x, pad.y));
+        parent.push_back(i);
+        auto k = pointPad.insert(std::make_pair(std::make_pair(pad.x, pad.y), i));
+        if (!k.second)
+            joinRoots(parent, k.first->second, i);
+        else {
+            uniquePads.push_back(i);
+            uniquePoints.push_back(points[i]);
+        }
+        padIslands(element, pad, islands);
+        for (int island : islands) {
+            auto j = islandPad.insert(std::make_pair(island, i));
+            if (!j.second)
+                joinRoots(parent, j.first->second, i);
+        }
+    }
+
+    if (uniquePoints.size() < 2) {
+        lengths[number] = 0;
+        return;
+    }
+
+    // Euclidean minimum spanning tree is subgraph of Delaunay triangulation
+    if (uniquePoints.size() <= maxCompleteGraphPads) {
+        for (uint i = 0; i < uniquePoints.size(); i++)
+            for (uint j = i + 1; j < uniquePoints.size(); j++)
+                edges.push_back(std::make_pair(i, j));
+    }
+    else
+        edges = delaunayEdges(uniquePoints);
+
+    auto squaredLength = [&uniquePoints](const std::pair<int, int> &e) {
+        long long dx = uniquePoints[e.second].x - uniquePoints[e.first].x;
+        long long dy = uniquePoints[e.second].y - uniquePoints[e.first].y;
+        return dx * dx + dy * dy;
+    };
+    std::sort(edges.begin(), edges.end(),
+              [&squaredLength](const std::pair<int, int> &e1, const std::pair<int, int> &e2) {
+        return squaredLength(e1) < squaredLength(e2); });
+
+    // Kruskal
+    for (auto &e : edges)
+        if (joinRoots(parent, uniquePads[e.first], uniquePads[e.second])) {
+            const Point &p1 = uniquePoints[e.first];
+            const Point &p2 = uniquePoints[e.second];
+            netLines.push_back(Line(p1.x, p1.y, p2.x, p2.y));
+            length += sqrt(double(squaredLength(e)));
+        }
+
+    lengths[number] = length;
+}
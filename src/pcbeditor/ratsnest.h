@@ -0,0 +1,72 @@
+// ratsnest.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef RATSNEST_H
+#define RATSNEST_H
+
+#include "element.h"
+#include "netindex.h"
+#include "pcbtypes.h"
+#include "track.h"
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Unrouted connections: minimum spanning tree of net pads,
+// pads connected by copper island are joined before
+class Ratsnest
+{
+public:
+    static constexpr int cellSize = 2000;           // endpoint grid cell
+    static constexpr int endPointSpace = 2;         // joined segment ends
+    static constexpr int maxCompleteGraphPads = 64; // bigger net: Delaunay edges
+
+    Ratsnest() { clear(); }
+    void clear();
+    double length() const { return totalLength; }
+    void setAllDirty() { allDirty = true; }
+    void setElementDirty(const Element &element);
+    void setNetDirty(int number) { dirtyNets.insert(number); }
+    void update(const std::vector<Element> &elements, const NetIndex &nets,
+                const std::list<Segment> &topSegments,
+                const std::list<Segment> &bottomSegments,
+                const std::list<Via> &vias);
+
+    std::map<int, std::vector<Line>> lines;     // net number, lines
+
+private:
+    class EndPoint
+    {
+    public:
+        int island;     // node before islands are joined
+        int radius;     // via radius
+        int x;
+        int y;
+    };
+
+    typedef std::unordered_map<unsigned long long, std::vector<int>> Grid;
+
+    void addEndPoint(int layer, int x, int y, int radius, int node);
+    static unsigned long long cell(int cellX, int cellY);
+    static int cellNumber(int x);
+    static std::vector<std::pair<int, int>> delaunayEdges(const std::vector<Point> &points);
+    void findIslands(const std::list<Segment> &topSegments,
+                     const std::list<Segment> &bottomSegments,
+                     const std::list<Via> &vias);
+    void padIslands(const Element &element, const Pad &pad,
+                    std::vector<int> &islands) const;
+    void updateNet(const std::vector<Element> &elements, const NetIndex &nets, int index);
+
+    bool allDirty;
+    double totalLength;
+    unsigned long long copperHash;
+    Grid grids[2];                          // top, bottom endpoints
+    std::map<int, double> lengths;          // net number, length
+    std::set<int> dirtyNets;
+    std::vector<EndPoint> endPoints;
+};
+
+#endif  // RATSNEST_H
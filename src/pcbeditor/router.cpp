@@ -2,10 +2,17 @@
 // Copyright (C) 2018 Alexander Karpeko
 
 #include "board.h"
+#include "cluster.h"
+#include "shaperouter.h"
+#include "threadpool.h"
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
 
 void Board::addLineToTrack(double track[][4], int &trackLength,
                            double x1, double y1, double x2, double y2)
@@ -89,6 +96,39 @@ int Board::compareLine(int greater, int *lineIndex, int lines,
     return n + greater;
 }
 
+// Strategies are compared by connected nets, then by time of routing
+int Board::compareRouteStrategies(const Via &via, int turningRadius)
+{
+    std::vector<RouteStrategy> strategies(RouteStrategy::strategies());
+    std::vector<std::tuple<int, double, int>> results;  // -connected, time, strategy
+    int size = strategies.size();
+
+    message.clear();
+    for (int i = 0; i < size; i++) {
+        std::unique_ptr<Board> work(copy());
+        work->progress = [this, i, size](int done, int total) {
+            return proceed(i * total + done, size * total);
+        };
+        int connected = work->shapeRoute(via, turningRadius, strategies[i]);
+        if (!proceed(i + 1, size))
+            break;
+        double time = 0;
+        for (auto &s : work->routeStats)
+            time += s.time;
+        results.push_back(std::make_tuple(-connected, time, i));
+        message += work->message + "\n";
+    }
+
+    if (results.empty())
+        return -1;
+
+    int best = std::get<2>(*std::min_element(results.begin(), results.end()));
+    message += "Best: " + strategies[best].name;
+    showMessage = false;
+
+    return best;
+}
+
 void Board::connectPadCenter(double track[][4], int &trackLength)
 {
     double x, y;
@@ -116,127 +156,27 @@ void Board::connectPadCenter(double track[][4], int &trackLength)
     }
 }
 
+// Groups of connected elements, power nets are not used
 void Board::createGroups()
 {
-    const int connectLevel = 2;
     const int groupStart = 0x10000;
-    const int maxElements = 10;
-    const int maxGroups = 10;
-    int connect;
     int groupNumber = groupStart;
-    int n;
-    std::multimap <int, int> tmpMultimap;   // pads number, element number
-    std::vector <int> bigElements;          // big element numbers
+    Cluster cluster;
 
     for (auto &e : elements)
         e.group = false;
+    groups.clear();
 
-    // Create groups for parallel 2 pads elements    
-    for (uint i = 0; i < elements.size(); i++) {
-        if (elements[i].pads.size() != 2)
-            continue;
-        group.clear();
-        for (uint j = i + 1; j < elements.size(); j++) {
-            if (elements[j].pads.size() != 2 || elements[j].group)
-                continue;
-            if ((elements[i].pads[0].net == elements[j].pads[0].net &&
-                 elements[i].pads[1].net == elements[j].pads[1].net) ||
-                (elements[i].pads[0].net == elements[j].pads[1].net &&
-                 elements[i].pads[1].net == elements[j].pads[0].net))
-                addToGroup(group, i, j, groupNumber);
-        }
-        if (!group.empty())
-            groups.push_back(group);
-    }
-
-    // Sort more then 2 pads elements by pads number
-    for (uint i = 0; i < elements.size(); i++) {
-        n = elements[i].pads.size();
-        if (n > 2)
-            tmpMultimap.insert(std::make_pair(n, i));
-    }
-    for (auto i = tmpMultimap.end();; --i) {
-        if (i != tmpMultimap.end())
-            bigElements.push_back((*i).second);
-        if (i == tmpMultimap.begin())
-            break;
-    }
-
-    // Create groups, more then 2 pads elements are centers
-    for (auto b : bigElements) {
-        if (elements[b].group)
-            continue;
-        group.clear();
-        for (uint j = 0; j < elements.size(); j++) {
-            if (b == j || elements[j].group)
-                continue;
-            connect = 0;
-            for (uint n1 = 0; n1 < elements[b].pads.size(); n1++)
-                for (uint n2 = 0; n2 < elements[j].pads.size(); n2++) {
-                    if (elements[b].pads[n1].net &&
-                        elements[b].pads[n1].net == elements[j].pads[n2].net)
-                        connect++;
-                }
-            if (connect >= connectLevel)
-                addToGroup(group, b, j, groupNumber);
-            if (group.size() > maxElements)
-                break;
-        }
-        if (!group.empty())
-            groups.push_back(group);
-        if (groups.size() > maxGroups)
-            break;
-    }
-
-    // Create groups
-    for (uint i = 0; i < elements.size(); i++) {
-        if (elements[i].group)
-            continue;
-        group.clear();
-        for (uint j = 0; j < elements.size(); j++) {
-            if (i == j || elements[j].group)
-                continue;
-            connect = 0;
-            for (uint n1 = 0; n1 < elements[i].pads.size(); n1++)
-                for (uint n2 = 0; n2 < elements[j].pads.size(); n2++) {
-                    if (elements[i].pads[n1].net &&
-                        elements[i].pads[n1].net == elements[j].pads[n2].net)
-                        connect++;
-                }
-            if (connect)
-                addToGroup(group, i, j, groupNumber);
-            if (group.size() > maxElements)
-                break;
-        }
-        if (!group.empty())
-            groups.push_back(group);
-        if (groups.size() > maxGroups)
-            break;
-    }
+    cluster.init(elements, nets, placer.maxNetElements);
+    cluster.partition(placer.maxGroupElements);
 
-    // Create groups
-    for (uint i = 0; i < elements.size(); i++) {
-        if (elements[i].group)
-            continue;
+    for (auto &c : cluster.clusters) {
+        if (!proceed(groups.size(), cluster.clusters.size()))
+            return;
         group.clear();
-        for (uint j = 0; j < elements.size(); j++) {
-            if (i == j || elements[j].group)
-                continue;
-            connect = 0;
-            for (uint n1 = 0; n1 < elements[i].pads.size(); n1++)
-                for (uint n2 = 0; n2 < elements[j].pads.size(); n2++) {
-                    if (elements[i].pads[n1].net == elements[j].pads[n2].net)
-                        connect++;
-                }
-            if (connect)
-                addToGroup(group, i, j, groupNumber);
-            if (group.size() > maxElements)
-                break;
-        }
-        if (!group.empty())
-            groups.push_back(group);
-        if (groups.size() > maxGroups)
-            break;
+        for (uint i = 1; i < c.size(); i++)
+            addToGroup(group, c[0], c[i], groupNumber);
+        groups.push_back(group);
     }
 }
 
@@ -641,7 +581,9 @@ bool Board::nearestVerticalLine(int side, int index, double &x1,
     return false;
 }
 
-int Board::netLength(const Element &element1, const Element &element2)
+// Element 1 is shifted by offsetX, offsetY
+int Board::netLength(const Element &element1, const Element &element2,
+                     int offsetX, int offsetY) const
 {
     int dx, dy;
     int length = 0;
@@ -649,8 +591,8 @@ int Board::netLength(const Element &element1, const Element &element2)
     for (auto &e1 : element1.pads)
         for (auto &e2 : element2.pads)
             if (e1.net == e2.net) {
-                dx = fabs(e2.x - e1.x);
-                dy = fabs(e2.y - e1.y);
+                dx = fabs(e2.x - e1.x - offsetX);
+                dy = fabs(e2.y - e1.y - offsetY);
                 length += sqrt(dx * dx + dy * dy);
             }
 
@@ -1149,10 +1091,12 @@ void Board::orderTrackLines(double track[][4], int &trackLength)
     }
 }
 
-int Board::packageSpace(const Element &element1, const Element &element2)
+// Element 1 is shifted by offsetX, offsetY
+int Board::packageSpace(const Element &element1, const Element &element2,
+                        int offsetX, int offsetY) const
 {
-    int dx = fabs(element2.centerX - element1.centerX);
-    int dy = fabs(element2.centerY - element1.centerY);
+    int dx = fabs(element2.centerX - element1.centerX - offsetX);
+    int dy = fabs(element2.centerY - element1.centerY - offsetY);
     int w1 = fabs(element1.border.rightX - element1.border.leftX);
     int h1 = fabs(element1.border.bottomY - element1.border.topY);
     int w2 = fabs(element2.border.rightX - element2.border.leftX);
@@ -1170,7 +1114,9 @@ int Board::packageSpace(const Element &element1, const Element &element2)
     return space;
 }
 
-int Board::padSpace(const Element &element1, const Element &element2)
+// Element 1 is shifted by offsetX, offsetY
+int Board::padSpace(const Element &element1, const Element &element2,
+                    int offsetX, int offsetY) const
 {
     int dx, dy;
     int w, h;
@@ -1180,8 +1126,8 @@ int Board::padSpace(const Element &element1, const Element &element2)
 
     for (auto &e1 : element1.pads)
         for (auto &e2 : element2.pads) {
-            dx = abs(e2.x - e1.x);
-            dy = abs(e2.y - e1.y);
+            dx = abs(e2.x - e1.x - offsetX);
+            dy = abs(e2.y - e1.y - offsetY);
             w = 0.5 * (e1.width + e2.width);
             h = 0.5 * (e1.height + e2.height);
             sx = dx - w;
@@ -1211,7 +1157,10 @@ void Board::placeElements()
     int x = dx;
     int y = 3 * dy;
 
+    journal.begin("Place elements");
     for (auto &g : groups) {
+        if (!proceed(n, groups.size()))
+            break;
         for (auto j = g.begin(); j != g.end(); ++j) {
             if (j != g.begin())
                 moveElement(*j, x, y);
@@ -1224,42 +1173,57 @@ void Board::placeElements()
         }
         n++;
     }
+    journal.end();
 }
 
+// Candidate positions are checked on shifted pads of the element,
+// rows of the search area are shared between pool threads
 void Board::placeGroup(const Group &group, int refX, int refY)
 {
     const int delta = 100;
     const int space = 1000;
     const int steps = 400;
     int j, k;
-    int length;
-    int minLength;
     int n = 0;
-    int x, y;
-    int xMin, yMin;
 
     for (auto &g : group) {
         j = g;
         if (n == 1)
             moveElement(j, refX, refY);
         if (n > 1) {
-            minLength = steps * delta;
-            for (int n1 = 0; n1 < steps; n1++)
-                for (int n2 = 0; n2 < steps; n2++) {
-                    x = refX + (n1 - 0.5 * steps) * delta;
-                    y = refY + (n2 - 0.5 * steps) * delta;
-                    moveElement(j, x, y);
-                    if (packageSpace(elements[j], elements[k]) < space ||
-                        padSpace(elements[j], elements[k]) < space)
-                        continue;
-                    length = netLength(elements[j], elements[k]);
-                    if (length < minLength) {
-                        minLength = length;
-                        xMin = x;
-                        yMin = y;
+            const Element &element1 = elements[j];
+            const Element &element2 = elements[k];
+            std::mutex mutex;
+            int minLength = steps * delta;
+            int minIndex = -1;  // n1 * steps + n2, first of equal lengths
+            ThreadPool::global().parallelFor(0, steps, [&](int first, int last) {
+                int length;
+                int localLength = steps * delta;
+                int localIndex = -1;
+                int offsetX, offsetY;
+                for (int n1 = first; n1 < last; n1++)
+                    for (int n2 = 0; n2 < steps; n2++) {
+                        offsetX = refX + (n1 - 0.5 * steps) * delta - element1.refX;
+                        offsetY = refY + (n2 - 0.5 * steps) * delta - element1.refY;
+                        if (packageSpace(element1, element2, offsetX, offsetY) < space ||
+                            padSpace(element1, element2, offsetX, offsetY) < space)
+                            continue;
+                        length = netLength(element1, element2, offsetX, offsetY);
+                        if (length < localLength) {
+                            localLength = length;
+                            localIndex = n1 * steps + n2;
+                        }
                     }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (localIndex >= 0 && (localLength < minLength ||
+                    (localLength == minLength && localIndex < minIndex))) {
+                    minLength = localLength;
+                    minIndex = localIndex;
                 }
-            moveElement(j, xMin, yMin);
+            }, 1);
+            if (minIndex >= 0)
+                moveElement(j, refX + (minIndex / steps - 0.5 * steps) * delta,
+                            refY + (minIndex % steps - 0.5 * steps) * delta);
         }
         k = j;
         n++;
@@ -1285,7 +1249,7 @@ void Board::placePadsToTable()
 
     row = startRow;
     col = startColumn;
-    for (auto g : groups) {
+    for (const auto &g : groups) {
         tmpRow = row;
         tmpCol = col;
         do {
@@ -1636,7 +1600,10 @@ void Board::routeTracks()
     int x = dx;
     int y = dy;
 
+    journal.begin("Route tracks");
     for (auto &g : groups) {
+        if (!proceed(n, groups.size()))
+            break;
         placeGroup(g, x, y);
         x += 2 * dx;
         if (n && !(n % 3)) {
@@ -1645,6 +1612,7 @@ void Board::routeTracks()
         }
         n++;
     }
+    journal.end();
 }
 
 void Board::setPadSteps(int padSteps[][maxPad], int netPad, int netPadsLength,
@@ -1812,6 +1780,91 @@ void Board::setTurnSteps(int padSteps[][maxPad], int padTurns[][maxPad], int net
     }
 }
 
+// Nets without segments are routed on edit layer, on top layer if edit
+// layer is not copper layer. Return: number of connected nets.
+// Ground and power nets of net classes have widths of their class
+int Board::shapeRoute(const Via &via, int turningRadius, const RouteStrategy &strategy)
+{
+    bool top = via.diameter > 0 || layers.edit != BOTTOM_LAYER;
+    bool bottom = via.diameter > 0 || layers.edit == BOTTOM_LAYER;
+    int connected = 0;
+    std::set<int> routedNets;
+    std::vector<int> order(strategy.order(nets, elements, netClasses));
+
+    for (auto &s : topSegments)
+        routedNets.insert(s.net);
+    for (auto &s : bottomSegments)
+        routedNets.insert(s.net);
+
+    ShapeRouter shapeRouter(snapshot(), router, top, bottom);
+    shapeRouter.setCosts(strategy.bendCost, strategy.viaCost, strategy.lineCost);
+    routeStats.clear();
+    journal.begin("Shape route");
+    for (uint i = 0; i < order.size(); i++) {
+        if (!proceed(i, order.size()))
+            break;
+        int net = order[i];
+        if (routedNets.count(net))
+            continue;
+        int index = nets.find(net);
+        int pads = nets.end(index) - nets.begin(index);
+        int width = router.width;
+        switch (RouteStrategy::netClass(net, netClasses)) {
+        case RouteStrategy::GROUND_NET:
+            width = router.groundWidth;
+            break;
+        case RouteStrategy::POWER_NET:
+            width = router.powerWidth;
+            break;
+        }
+
+        std::vector<Segment> lines[2];
+        std::vector<Via> netVias;
+        RouteStats stats;
+        auto start = std::chrono::steady_clock::now();
+        stats.connected = shapeRouter.route(net, width, via, turningRadius, lines, netVias,
+                                            stats.bends);
+        stats.time = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start).count();
+        stats.length = 0;
+        stats.net = net;
+        stats.pads = pads;
+        stats.vias = netVias.size();
+        for (auto &l : lines)
+            for (auto &s : l)
+                stats.length += s.length();
+        routeStats.push_back(stats);
+        if (stats.connected)
+            connected++;
+
+        shapeRouter.addSegments(lines[0], true);
+        shapeRouter.addSegments(lines[1], false);
+        shapeRouter.addVias(netVias);
+
+        // Routed objects are appended, so only they are recorded
+        for (auto &s : lines[0]) {
+            topSegments.push_back(s);
+            journal.record(TOP_SEGMENT_OBJECT, topSegments.size() - 1,
+                           QJsonObject(), s.toJson());
+        }
+        for (auto &s : lines[1]) {
+            bottomSegments.push_back(s);
+            journal.record(BOTTOM_SEGMENT_OBJECT, bottomSegments.size() - 1,
+                           QJsonObject(), s.toJson());
+        }
+        for (auto &v : netVias) {
+            vias.push_back(v);
+            journal.record(VIA_OBJECT, vias.size() - 1, QJsonObject(), v.toJson());
+        }
+    }
+    journal.end();
+
+    message = strategy.name + ": " + RouteStats::summary(routeStats);
+    showMessage = true;
+
+    return connected;
+}
+
 void Board::sortLineIndex()
 {
 
@@ -1911,6 +1964,8 @@ int Board::tableRoute()
 
     // Route tracks
     for (netNumber = 0; netNumber < nets.size(); netNumber++) {   // netNumber < nets.size()
+        if (!proceed(netNumber, nets.size()))
+            return error;
         netPadsLength = getPadsOfNet(netPadsRow, netPadsCol);
 
         // Try to reduce path cells, increasing path length step by step
@@ -2367,8 +2422,8 @@ int Board::waveRoute()
         *(board + (maxX - 1) * maxY + i) = -1;
     }
 
-    for (auto e : elements) {
-        for (auto ep : e.pads) {
+    for (const auto &e : elements) {
+        for (const auto &ep : e.pads) {
             net = ep.net;
             x = ep.x / grid;
             y = ep.y / grid;
@@ -2391,6 +2446,10 @@ int Board::waveRoute()
 
     // find paths
     while (step < maxStep) {
+        if (!proceed(step, maxStep)) {
+            delete [] buffer;
+            return 0;
+        }
         step++;
         newWaveLength = 0;
         for (int i = 0; i < waveLength; i++) {
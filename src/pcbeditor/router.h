@@ -17,6 +17,8 @@ public:
     double grid;            // grid step
     double packageSpace;    // space between packages
     int groupNumber;
+    int maxGroupElements;   // elements in group
+    int maxNetElements;     // elements of net used for grouping
     Groups groups;
 };
 
@@ -0,0 +1,197 @@
+// routestrategy.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "routestrategy.h"
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <climits>
+#include <tuple>
+
+namespace
+{
+std::set<int> netsFromJson(const QJsonValue &value)
+{
+    std::set<int> nets;
+
+    for (auto v : value.toArray())
+        nets.insert(v.toInt());
+
+    return nets;
+}
+
+QJsonArray netsToJson(const std::set<int> &nets)
+{
+    QJsonArray array;
+
+    for (int n : nets)
+        array.append(n);
+
+    return array;
+}
+}
+
+void NetClasses::clear()
+{
+    criticalNets.clear();
+    groundNets.clear();
+    powerNets.clear();
+}
+
+void NetClasses::fromJson(const QJsonValue &value)
+{
+    QJsonObject object(value.toObject());
+
+    criticalNets = netsFromJson(object["criticalNets"]);
+    groundNets = netsFromJson(object["groundNets"]);
+    powerNets = netsFromJson(object["powerNets"]);
+}
+
+bool NetClasses::isEmpty() const
+{
+    return criticalNets.empty() && groundNets.empty() && powerNets.empty();
+}
+
+bool NetClasses::parse(const QString &text, std::set<int> &nets)
+{
+    std::set<int> numbers;
+
+    for (auto &s : text.split(QRegularExpression("[,\\s]+"), Qt::SkipEmptyParts)) {
+        bool ok;
+        int n = s.toInt(&ok);
+        if (!ok || n < 0)
+            return false;
+        numbers.insert(n);
+    }
+    nets = numbers;
+
+    return true;
+}
+
+QString NetClasses::text(const std::set<int> &nets)
+{
+    QStringList list;
+
+    for (int n : nets)
+        list.append(QString::number(n));
+
+    return list.join(", ");
+}
+
+QJsonObject NetClasses::toJson() const
+{
+    QJsonObject object
+    {
+        {"criticalNets", netsToJson(criticalNets)},
+        {"groundNets", netsToJson(groundNets)},
+        {"powerNets", netsToJson(powerNets)}
+    };
+
+    return object;
+}
+
+QString RouteStats::summary(const std::vector<RouteStats> &stats)
+{
+    int bends = 0;
+    int connected = 0;
+    int vias = 0;
+    double length = 0;
+    double time = 0;
+
+    for (auto &s : stats) {
+        bends += s.bends;
+        connected += s.connected;
+        vias += s.vias;
+        length += s.length;
+        time += s.time;
+    }
+
+    return QString("connected = %1/%2  length = %3 mm  bends = %4  vias = %5  time = %6 ms")
+           .arg(connected).arg(stats.size()).arg(length / 1000, 0, 'f', 1)
+           .arg(bends).arg(vias).arg(time, 0, 'f', 0);
+}
+
+RouteStrategy::RouteStrategy():
+    bendCost(ShapeRouter::defaultBendCost), netOrder(BOARD_ORDER),
+    viaCost(ShapeRouter::defaultViaCost), name("Board order")
+{
+}
+
+RouteStrategy::RouteStrategy(const QString &name, int order, int bendCost, int viaCost,
+                             const ShapeRouter::LineCost &lineCost):
+    bendCost(bendCost), netOrder(order), viaCost(viaCost), name(name), lineCost(lineCost)
+{
+}
+
+int RouteStrategy::netClass(int net, const NetClasses &classes)
+{
+    if (classes.groundNets.count(net))
+        return GROUND_NET;
+    if (classes.powerNets.count(net))
+        return POWER_NET;
+    return SIGNAL_NET;
+}
+
+// Keys are compared in order: critical, class, area or pads, net number
+std::vector<int> RouteStrategy::order(const NetIndex &nets, const std::vector<Element> &elements,
+                                      const NetClasses &classes) const
+{
+    typedef std::tuple<bool, int, double, int> Key;
+    std::vector<std::pair<Key, int>> keys;
+
+    for (int i = 0; i < nets.size(); i++) {
+        int net = nets.number(i);
+        int pads = nets.end(i) - nets.begin(i);
+        Border b(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+        for (auto p = nets.begin(i); p != nets.end(i); ++p) {
+            const Pad &pad = elements[p->x].pads[p->y];
+            b.leftX = std::min(b.leftX, pad.x);
+            b.topY = std::min(b.topY, pad.y);
+            b.rightX = std::max(b.rightX, pad.x);
+            b.bottomY = std::max(b.bottomY, pad.y);
+        }
+        double area = pads ? double(b.rightX - b.leftX) * (b.bottomY - b.topY) : 0;
+
+        Key key(!classes.criticalNets.count(net), 0, 0, net);
+        switch (netOrder) {
+        case AREA_ORDER:
+            std::get<2>(key) = area;
+            break;
+        case PAD_ORDER:
+            std::get<2>(key) = pads;
+            break;
+        case CLASS_ORDER:
+            std::get<1>(key) = netClass(net, classes);
+            std::get<2>(key) = area;
+            break;
+        }
+        keys.push_back(std::make_pair(key, net));
+    }
+
+    std::sort(keys.begin(), keys.end());
+    std::vector<int> numbers;
+    for (auto &k : keys)
+        numbers.push_back(k.second);
+
+    return numbers;
+}
+
+std::vector<RouteStrategy> RouteStrategy::strategies()
+{
+    const int bendCost = ShapeRouter::defaultBendCost;
+    const int viaCost = ShapeRouter::defaultViaCost;
+
+    // Bottom lines are longer by half
+    ShapeRouter::LineCost topLayer = [](int layer, const Point &p, const Point &p2) {
+        return (layer ? 1.5 : 1) * ShapeRouter::octilinearLength(p, p2);
+    };
+
+    return {RouteStrategy("Board order", BOARD_ORDER, bendCost, viaCost),
+            RouteStrategy("Small area first", AREA_ORDER, bendCost, viaCost),
+            RouteStrategy("Few pads first", PAD_ORDER, bendCost, viaCost),
+            RouteStrategy("Power first", CLASS_ORDER, bendCost, viaCost),
+            RouteStrategy("Few bends", AREA_ORDER, 4 * bendCost, viaCost),
+            RouteStrategy("Few vias", AREA_ORDER, bendCost, 4 * viaCost),
+            RouteStrategy("Top layer", AREA_ORDER, bendCost, viaCost, topLayer)};
+}
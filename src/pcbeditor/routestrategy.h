@@ -0,0 +1,86 @@
+// routestrategy.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef ROUTESTRATEGY_H
+#define ROUTESTRATEGY_H
+
+#include "element.h"
+#include "netindex.h"
+#include "shaperouter.h"
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <set>
+#include <vector>
+
+// Result of routing of one net
+class RouteStats
+{
+public:
+    // Connected nets, length, bends, vias and time of all nets
+    static QString summary(const std::vector<RouteStats> &stats);
+
+    bool connected;
+    int bends;          // corners of lines
+    int net;
+    int pads;
+    int vias;
+    double length;      // length of lines and arcs
+    double time;        // milliseconds
+};
+
+// Net classes set by user in options of board, other nets are signal nets
+class NetClasses
+{
+public:
+    void clear();
+    void fromJson(const QJsonValue &value);
+    bool isEmpty() const;
+    // Net numbers separated by commas or spaces, false: text is not net numbers
+    static bool parse(const QString &text, std::set<int> &nets);
+    static QString text(const std::set<int> &nets);
+    QJsonObject toJson() const;
+
+    std::set<int> criticalNets;     // routed first by any order
+    std::set<int> groundNets;       // routed with ground width
+    std::set<int> powerNets;        // routed with power width
+};
+
+// Order of nets and costs of shape router. Critical nets are routed
+// first by any order. Pad count orders nets only, track width is
+// chosen by net class.
+class RouteStrategy
+{
+public:
+    enum NetOrder
+    {
+        BOARD_ORDER,    // net numbers
+        AREA_ORDER,     // small pad border area first
+        PAD_ORDER,      // few pads first
+        CLASS_ORDER     // ground, power, signal nets, then small area first
+    };
+
+    enum NetClass
+    {
+        GROUND_NET, POWER_NET, SIGNAL_NET
+    };
+
+    RouteStrategy();
+    RouteStrategy(const QString &name, int order, int bendCost, int viaCost,
+                  const ShapeRouter::LineCost &lineCost = nullptr);
+    static int netClass(int net, const NetClasses &classes);
+    // Net numbers of nets in order of routing
+    std::vector<int> order(const NetIndex &nets, const std::vector<Element> &elements,
+                           const NetClasses &classes) const;
+    // Strategies compared by board
+    static std::vector<RouteStrategy> strategies();
+
+    int bendCost;
+    int netOrder;
+    int viaCost;
+    QString name;
+    ShapeRouter::LineCost lineCost;
+};
+
+#endif  // ROUTESTRATEGY_H
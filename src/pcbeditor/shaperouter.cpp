@@ -0,0 +1,743 @@
+// shaperouter.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "element.h"
+#include "shaperouter.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace
+{
+const double pi = acos(-1);
+const int noNets = -2;
+const int otherNets = -1;
+
+// Obstacle without net is obstacle of other nets
+void addNet(int &nets, int net)
+{
+    if (net < 0 || (nets != noNets && nets != net))
+        nets = otherNets;
+    else
+        nets = net;
+}
+
+// Bend of two 45 degree lines from p to p2, variant 0: diagonal line first
+Point bendPoint(const Point &p, const Point &p2, int variant)
+{
+    int dx = p2.x - p.x;
+    int dy = p2.y - p.y;
+    int d = std::min(abs(dx), abs(dy));
+    int sx = dx < 0 ? -1 : 1;
+    int sy = dy < 0 ? -1 : 1;
+
+    if (!variant)
+        return Point(p.x + sx * d, p.y + sy * d);
+    return Point(p2.x - sx * d, p2.y - sy * d);
+}
+
+double pointDistance(double x, double y, double x1, double y1, double x2, double y2)
+{
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? ((x - x1) * dx + (y - y1) * dy) / length2 : 0;
+    t = std::max(0., std::min(1., t));
+
+    return hypot(x - x1 - t * dx, y - y1 - t * dy);
+}
+
+bool crossed(double x1, double y1, double x2, double y2,
+             double x3, double y3, double x4, double y4)
+{
+    auto side = [](double ax, double ay, double bx, double by, double cx, double cy) {
+        double s = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        return (s > 0) - (s < 0);
+    };
+
+    return side(x1, y1, x2, y2, x3, y3) * side(x1, y1, x2, y2, x4, y4) < 0 &&
+           side(x3, y3, x4, y4, x1, y1) * side(x3, y3, x4, y4, x2, y2) < 0;
+}
+
+double lineDistance(double x1, double y1, double x2, double y2,
+                    double x3, double y3, double x4, double y4)
+{
+    if (crossed(x1, y1, x2, y2, x3, y3, x4, y4))
+        return 0;
+
+    return std::min({pointDistance(x1, y1, x3, y3, x4, y4),
+                     pointDistance(x2, y2, x3, y3, x4, y4),
+                     pointDistance(x3, y3, x1, y1, x2, y2),
+                     pointDistance(x4, y4, x1, y1, x2, y2)});
+}
+
+double boxDistance(double x1, double y1, double x2, double y2,
+                   int left, int top, int right, int bottom)
+{
+    auto inside = [&](double x, double y) {
+        return x >= left && x <= right && y >= top && y <= bottom;
+    };
+
+    if (inside(x1, y1) || inside(x2, y2))
+        return 0;
+
+    return std::min({lineDistance(x1, y1, x2, y2, left, top, right, top),
+                     lineDistance(x1, y1, x2, y2, right, top, right, bottom),
+                     lineDistance(x1, y1, x2, y2, right, bottom, left, bottom),
+                     lineDistance(x1, y1, x2, y2, left, bottom, left, top)});
+}
+}
+
+ShapeRouter::ShapeRouter(const BoardSnapshot &board, const Router &router,
+                         bool top, bool bottom):
+    bendCost(defaultBendCost), clearance(router.clearance), viaCost(defaultViaCost), stamp(0),
+    board(board)
+{
+    const std::vector<Point> &points = board.border.points;
+
+    layers[0].used = top;
+    layers[1].used = bottom;
+
+    area = Border(INT_MIN / 2, INT_MIN / 2, INT_MAX / 2, INT_MAX / 2);
+    if (!points.empty()) {
+        area = Border(points[0].x, points[0].y, points[0].x, points[0].y);
+        for (auto &p : points) {
+            area.leftX = std::min(area.leftX, p.x);
+            area.topY = std::min(area.topY, p.y);
+            area.rightX = std::max(area.rightX, p.x);
+            area.bottomY = std::max(area.bottomY, p.y);
+        }
+    }
+
+    for (uint i = 0; i < points.size() && points.size() > 1; i++) {
+        const Point &p = points[i];
+        const Point &p2 = points[(i + 1) % points.size()];
+        for (int layer : {0, 1})
+            addObstacle(layer, Obstacle{false, -1, 0, p.x, p.y, p2.x, p2.y});
+    }
+
+    for (auto &e : board.elements)
+        for (auto &p : e.pads) {
+            int w = p.width;
+            int h = p.height;
+            if (p.orientation == Element::RIGHT)
+                std::swap(w, h);
+            if (w == 0 || h == 0) {
+                w = p.diameter;
+                h = p.diameter;
+            }
+            Obstacle o{true, p.net, 0, p.x - w / 2, p.y - h / 2,
+                       p.x + (w + 1) / 2, p.y + (h + 1) / 2};
+            for (int layer : {0, 1})
+                if (p.innerDiameter > 0 || e.onTop == !layer)
+                    addObstacle(layer, o);
+        }
+
+    addVias(std::vector<Via>(board.vias.begin(), board.vias.end()));
+    for (auto &s : board.topSegments)
+        addSegment(0, s);
+    for (auto &s : board.bottomSegments)
+        addSegment(1, s);
+
+    // Corners of track widths, corners of vias are found by first route
+    for (double width : {router.width, router.groundWidth, router.powerWidth})
+        for (int layer : {0, 1})
+            if (layers[layer].used)
+                cornerSet(layer, clearance + (int(width) + 1) / 2);
+}
+
+// Corner of many obstacles is one corner
+void ShapeRouter::addCorners(Corners &set, const Obstacle &obstacle)
+{
+    std::vector<Point> points;
+
+    corners(obstacle, set.space + cornerMargin, points);
+    for (auto &p : points) {
+        if (p.x < area.leftX || p.x > area.rightX || p.y < area.topY || p.y > area.bottomY)
+            continue;
+        auto i = set.points.find(cell(p.x, p.y));
+        if (i != set.points.end()) {
+            addNet(set.corners[i->second].owner, obstacle.net);
+            continue;
+        }
+
+        Corner c{{noNets, noNets}, noNets, p};
+        addNet(c.owner, obstacle.net);
+        for (int layer : {0, 1})
+            if (set.layer == layer || set.layer == bothLayers)
+                c.blocker[layer] = blocker(layer, p, set.space);
+        int number = set.corners.size();
+        set.corners.push_back(c);
+        set.points.emplace(cell(p.x, p.y), number);
+        set.grid[cell(cellNumber(p.x), cellNumber(p.y))].push_back(number);
+    }
+}
+
+void ShapeRouter::addObstacle(int layer, const Obstacle &obstacle)
+{
+    const Obstacle &o = obstacle;
+    Layer &l = layers[layer];
+    int number = l.obstacles.size();
+    int r = o.radius;
+
+    l.obstacles.push_back(o);
+    l.stamps.push_back(0);
+    for (int x = cellNumber(std::min(o.x1, o.x2) - r); x <= cellNumber(std::max(o.x1, o.x2) + r); x++)
+        for (int y = cellNumber(std::min(o.y1, o.y2) - r);
+             y <= cellNumber(std::max(o.y1, o.y2) + r); y++)
+            l.grid[cell(x, y)].push_back(number);
+
+    for (auto &s : cornerSets)
+        if (s.second.layer == layer || s.second.layer == bothLayers) {
+            addCorners(s.second, o);
+            blockCorners(s.second, layer, o);
+        }
+}
+
+// Arc is lines between chord points, radius includes arc sagitta
+void ShapeRouter::addSegment(int layer, const Segment &segment)
+{
+    const Segment &s = segment;
+    int r = (s.width + 1) / 2;
+
+    if (s.type != Segment::ARC) {
+        addObstacle(layer, Obstacle{false, s.net, r, s.x1, s.y1, s.x2, s.y2});
+        return;
+    }
+
+    double step = (pi / 180) * s.spanAngle / arcChords;
+    int sagitta = ceil(s.radius * (1 - cos(step / 2)));
+    double a = (pi / 180) * s.startAngle;
+    int x = s.x0 + lround(s.radius * cos(a));
+    int y = s.y0 - lround(s.radius * sin(a));
+    for (int i = 1; i <= arcChords; i++) {
+        a += step;
+        int x2 = s.x0 + lround(s.radius * cos(a));
+        int y2 = s.y0 - lround(s.radius * sin(a));
+        addObstacle(layer, Obstacle{false, s.net, r + sagitta, x, y, x2, y2});
+        x = x2;
+        y = y2;
+    }
+}
+
+void ShapeRouter::addSegments(const std::vector<Segment> &segments, bool top)
+{
+    for (auto &s : segments)
+        addSegment(top ? 0 : 1, s);
+}
+
+void ShapeRouter::addVias(const std::vector<Via> &vias)
+{
+    for (auto &v : vias)
+        for (int layer : {0, 1})
+            addObstacle(layer, Obstacle{false, v.net, (v.diameter + 1) / 2, v.x, v.y, v.x, v.y});
+}
+
+int ShapeRouter::blocker(int layer, const Point &point, int space) const
+{
+    const Layer &l = layers[layer];
+    int nets = noNets;
+
+    for (int x = cellNumber(point.x - space); x <= cellNumber(point.x + space); x++)
+        for (int y = cellNumber(point.y - space); y <= cellNumber(point.y + space); y++) {
+            auto i = l.grid.find(cell(x, y));
+            if (i == l.grid.end())
+                continue;
+            for (int n : i->second)
+                if (obstacleDistance(l.obstacles[n], point, point) < space)
+                    addNet(nets, l.obstacles[n].net);
+        }
+
+    return nets;
+}
+
+void ShapeRouter::blockCorners(Corners &set, int layer, const Obstacle &obstacle)
+{
+    const Obstacle &o = obstacle;
+    int r = o.radius + set.space;
+
+    for (int x = cellNumber(std::min(o.x1, o.x2) - r); x <= cellNumber(std::max(o.x1, o.x2) + r); x++)
+        for (int y = cellNumber(std::min(o.y1, o.y2) - r);
+             y <= cellNumber(std::max(o.y1, o.y2) + r); y++) {
+            auto i = set.grid.find(cell(x, y));
+            if (i == set.grid.end())
+                continue;
+            for (int n : i->second) {
+                Corner &c = set.corners[n];
+                if (obstacleDistance(o, c.point, c.point) < set.space)
+                    addNet(c.blocker[layer], o.net);
+            }
+        }
+}
+
+unsigned long long ShapeRouter::cell(int cellX, int cellY)
+{
+    return (unsigned long long) (unsigned int) cellX << 32 | (unsigned int) cellY;
+}
+
+int ShapeRouter::cellNumber(int x)
+{
+    return x >= 0 ? x / cellSize : (x + 1) / cellSize - 1;
+}
+
+// Cells of each column are cells of line part in column
+bool ShapeRouter::clear(int layer, const Point &p, const Point &p2, int net, int space) const
+{
+    const Layer &l = layers[layer];
+    int minX = std::min(p.x, p2.x);
+    int maxX = std::max(p.x, p2.x);
+    double dx = p2.x - p.x;
+
+    stamp++;
+    for (int x = cellNumber(minX - space); x <= cellNumber(maxX + space); x++) {
+        double left = std::max(double(minX), double(x) * cellSize - space);
+        double right = std::min(double(maxX), double(x + 1) * cellSize + space);
+        double y1 = p.y;
+        double y2 = p2.y;
+        if (dx != 0) {
+            y1 = p.y + (p2.y - p.y) * (left - p.x) / dx;
+            y2 = p.y + (p2.y - p.y) * (right - p.x) / dx;
+        }
+        int first = cellNumber(int(floor(std::min(y1, y2))) - space);
+        int last = cellNumber(int(ceil(std::max(y1, y2))) + space);
+        for (int y = first; y <= last; y++) {
+            auto i = l.grid.find(cell(x, y));
+            if (i == l.grid.end())
+                continue;
+            for (int n : i->second) {
+                if (l.stamps[n] == stamp)
+                    continue;
+                l.stamps[n] = stamp;
+                const Obstacle &o = l.obstacles[n];
+                if (o.net == net && net >= 0)
+                    continue;
+                if (obstacleDistance(o, p, p2) < space)
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+const ShapeRouter::Corners &ShapeRouter::cornerSet(int layer, int space)
+{
+    auto key = std::make_pair(layer, space);
+    auto i = cornerSets.find(key);
+    if (i != cornerSets.end())
+        return i->second;
+
+    Corners &set = cornerSets[key];
+    set.layer = layer;
+    set.space = space;
+    for (int l : {0, 1})
+        if (layer == l || layer == bothLayers)
+            for (auto &o : layers[l].obstacles)
+                addCorners(set, o);
+
+    return set;
+}
+
+// Vertices of octagon around corner or line end, octagon edges
+// are at distance of radius and space
+void ShapeRouter::corners(const Obstacle &obstacle, int space,
+                          std::vector<Point> &points) const
+{
+    const Obstacle &o = obstacle;
+    int r = o.radius + space;
+    int t = ceil(r * tan(pi / 8));
+
+    auto add = [&points, r, t](int x, int y, int sx, int sy) {
+        points.push_back(Point(x + sx * r, y + sy * t));
+        points.push_back(Point(x + sx * t, y + sy * r));
+    };
+
+    if (o.box) {
+        add(o.x1, o.y1, -1, -1);
+        add(o.x2, o.y1, 1, -1);
+        add(o.x2, o.y2, 1, 1);
+        add(o.x1, o.y2, -1, 1);
+        return;
+    }
+
+    for (int sx : {-1, 1})
+        for (int sy : {-1, 1}) {
+            add(o.x1, o.y1, sx, sy);
+            if (o.x1 != o.x2 || o.y1 != o.y2)
+                add(o.x2, o.y2, sx, sy);
+        }
+}
+
+void ShapeRouter::lines(int layer, const std::vector<Point> &polyline, int net, int width,
+                        int space, int turningRadius, std::vector<Segment> &segments,
+                        int &bends) const
+{
+    std::vector<Point> points;
+
+    // Points inside straight line are removed
+    for (auto &p : polyline) {
+        if (!points.empty() && points.back() == p)
+            continue;
+        if (points.size() > 1) {
+            const Point &p1 = points[points.size() - 2];
+            const Point &p2 = points.back();
+            if (int64_t(p2.x - p1.x) * (p.y - p2.y) == int64_t(p2.y - p1.y) * (p.x - p2.x)) {
+                points.back() = p;
+                continue;
+            }
+        }
+        points.push_back(p);
+    }
+
+    if (points.size() < 2)
+        return;
+
+    Point start = points[0];
+    bends += points.size() - 2;
+    for (uint i = 1; i + 1 < points.size(); i++) {
+        const Point &p = points[i-1];
+        const Point &corner = points[i];
+        const Point &p2 = points[i+1];
+        double length1 = hypot(corner.x - start.x, corner.y - start.y);
+        double length2 = hypot(p2.x - corner.x, p2.y - corner.y);
+        double dx1 = (corner.x - p.x) / hypot(corner.x - p.x, corner.y - p.y);
+        double dy1 = (corner.y - p.y) / hypot(corner.x - p.x, corner.y - p.y);
+        double dx2 = (p2.x - corner.x) / length2;
+        double dy2 = (p2.y - corner.y) / length2;
+        double turn = acos(std::max(-1., std::min(1., dx1 * dx2 + dy1 * dy2)));
+        double trim = turningRadius * tan(turn / 2);
+        if (i + 2 < points.size())
+            length2 /= 2;
+
+        if (turningRadius > 0 && trim <= length1 && trim <= length2) {
+            // Left turn on screen: center is at left side of first line
+            bool left = dx1 * dy2 - dy1 * dx2 < 0;
+            double nx = left ? dy1 : -dy1;
+            double ny = left ? -dx1 : dx1;
+            double x0 = corner.x - dx1 * trim + nx * turningRadius;
+            double y0 = corner.y - dy1 * trim + ny * turningRadius;
+            Point p3(lround(corner.x - dx1 * trim), lround(corner.y - dy1 * trim));
+            Point p4(lround(corner.x + dx2 * trim), lround(corner.y + dy2 * trim));
+            double mx = corner.x - x0;
+            double my = corner.y - y0;
+            double m = hypot(mx, my);
+            Point middle(lround(x0 + mx / m * turningRadius), lround(y0 + my / m * turningRadius));
+            if (clear(layer, p3, middle, net, space) && clear(layer, middle, p4, net, space)) {
+                double angle1 = atan2(y0 - (p3.y), p3.x - x0) * 180 / pi;
+                double angle2 = atan2(y0 - (p4.y), p4.x - x0) * 180 / pi;
+                int startAngle = lround(left ? angle1 : angle2);
+                int spanAngle = lround(turn * 180 / pi);
+                startAngle = (startAngle % 360 + 360) % 360;
+                if (!(start == p3))
+                    segments.push_back(Segment(start.x, start.y, p3.x, p3.y, net, width));
+                segments.push_back(Segment(lround(x0), lround(y0), turningRadius,
+                                           startAngle, spanAngle, net, width));
+                start = p4;
+                continue;
+            }
+        }
+
+        segments.push_back(Segment(start.x, start.y, corner.x, corner.y, net, width));
+        start = corner;
+    }
+    if (!(start == points.back()))
+        segments.push_back(Segment(start.x, start.y, points.back().x, points.back().y,
+                                   net, width));
+}
+
+double ShapeRouter::octilinearLength(const Point &p, const Point &p2)
+{
+    int dx = abs(p2.x - p.x);
+    int dy = abs(p2.y - p.y);
+
+    return abs(dx - dy) + sqrt(2) * std::min(dx, dy);
+}
+
+double ShapeRouter::obstacleDistance(const Obstacle &obstacle, const Point &p, const Point &p2)
+{
+    const Obstacle &o = obstacle;
+
+    if (o.box)
+        return boxDistance(p.x, p.y, p2.x, p2.y, o.x1, o.y1, o.x2, o.y2);
+    return lineDistance(p.x, p.y, p2.x, p2.y, o.x1, o.y1, o.x2, o.y2) - o.radius;
+}
+
+// Each search connects nearest free pad to tree, bends and vias of tree
+// are sources of next searches. Lines of node are tried to rings of
+// nearest grid cells with at least minNeighbours nodes and to free pads,
+// so checks of node do not depend on number of nodes of dense board. Clear lines are
+// kept for next searches of net.
+bool ShapeRouter::route(int net, int width, const Via &via, int turningRadius,
+                        std::vector<Segment> segments[2], std::vector<Via> &vias,
+                        int &bends)
+{
+    const double infinity = std::numeric_limits<double>::max();
+    int space = clearance + (width + 1) / 2;
+    int viaSpace = clearance + (via.diameter + 1) / 2;
+    bool viaUsed = layers[0].used && layers[1].used && via.diameter > 0;
+    int index = board.nets ? board.nets->find(net) : -1;
+    bool complete = true;
+    int pads = 0;
+    std::vector<Node> nodes;
+    std::vector<int> layerNodes[2];
+    std::vector<int> padNodes[2];
+    Grid nodeGrids[2];                                      // cell, nodes
+    std::unordered_map<unsigned long long, int> visible;    // node pair, clear variant or -1
+
+    bends = 0;
+    if (index < 0)
+        return false;
+
+    auto addNode = [&](int layer, int pad, const Point &point) {
+        int node = nodes.size();
+        nodes.push_back(Node{layer, pad, -1, point});
+        layerNodes[layer].push_back(node);
+        nodeGrids[layer][cell(cellNumber(point.x), cellNumber(point.y))].push_back(node);
+        if (pad >= 0)
+            padNodes[layer].push_back(node);
+        return node;
+    };
+
+    auto length = [this](int layer, const Point &p, const Point &p2) {
+        return lineCost ? lineCost(layer, p, p2) : octilinearLength(p, p2);
+    };
+
+    auto link = [&nodes](int node, int node2) {
+        nodes[node].twin = node2;
+        nodes[node2].twin = node;
+    };
+
+    // Pad of both layers is two twin nodes
+    std::vector<Point> padPoints;
+    for (auto p = board.nets->begin(index); p != board.nets->end(index); ++p) {
+        const Element &e = board.elements[p->x];
+        const Pad &pad = e.pads[p->y];
+        int first = -1;
+        for (int layer : {0, 1})
+            if (layers[layer].used && (pad.innerDiameter > 0 || e.onTop == !layer)) {
+                int node = addNode(layer, pads, Point(pad.x, pad.y));
+                if (first >= 0)
+                    link(first, node);
+                first = node;
+            }
+        if (first < 0) {
+            complete = false;
+            continue;
+        }
+        padPoints.push_back(Point(pad.x, pad.y));
+        pads++;
+    }
+
+    if (pads < 2)
+        return complete;
+
+    // Corner of obstacles of other nets is node if it is clear of them
+    auto usable = [net](int owner, int blocker) {
+        return (owner != net || net < 0) && (blocker == noNets || (blocker == net && net >= 0));
+    };
+
+    for (int layer : {0, 1}) {
+        if (!layers[layer].used)
+            continue;
+        for (auto &c : cornerSet(layer, space).corners)
+            if (usable(c.owner, c.blocker[layer]))
+                addNode(layer, -1, c.point);
+    }
+
+    // Via is edge between twin nodes around obstacles of both layers
+    if (viaUsed)
+        for (auto &c : cornerSet(bothLayers, viaSpace).corners)
+            if (usable(c.owner, c.blocker[0]) && usable(c.owner, c.blocker[1]))
+                link(addNode(0, -1, c.point), addNode(1, -1, c.point));
+
+    std::vector<char> connected(pads, false);
+    std::vector<char> tree(nodes.size(), false);
+    std::vector<std::vector<Node>> paths;
+    connected[0] = true;
+    for (uint i = 0; i < nodes.size(); i++)
+        tree[i] = nodes[i].pad == 0;
+
+    auto neighbours = [&](int node, std::vector<int> &list) {
+        const Node &n = nodes[node];
+        const Grid &grid = nodeGrids[n.layer];
+        int cx = cellNumber(n.point.x);
+        int cy = cellNumber(n.point.y);
+        auto add = [&](int x, int y) {
+            auto i = grid.find(cell(x, y));
+            if (i != grid.end())
+                list.insert(list.end(), i->second.begin(), i->second.end());
+        };
+        list.clear();
+        add(cx, cy);
+        for (int r = 1; int(list.size()) < minNeighbours; r++) {
+            // Ring of more cells than nodes: nodes are checked one by one
+            if (double(2 * r + 1) * (2 * r + 1) > layerNodes[n.layer].size()) {
+                list = layerNodes[n.layer];
+                break;
+            }
+            for (int x = cx - r; x <= cx + r; x++) {
+                add(x, cy - r);
+                add(x, cy + r);
+            }
+            for (int y = cy - r + 1; y < cy + r; y++) {
+                add(cx - r, y);
+                add(cx + r, y);
+            }
+        }
+        for (int v : padNodes[n.layer])
+            if (!connected[nodes[v].pad])
+                list.push_back(v);
+    };
+
+    // Variant of clear bend line from node to node2, -1: no line
+    auto variant = [&](int node, int node2) {
+        unsigned long long key = (unsigned long long) node << 32 | (unsigned int) node2;
+        auto i = visible.find(key);
+        if (i != visible.end())
+            return i->second;
+        int layer = nodes[node].layer;
+        const Point &p = nodes[node].point;
+        const Point &p2 = nodes[node2].point;
+        int result = -1;
+        for (int v = 0; v < 2 && result < 0; v++) {
+            Point bend = bendPoint(p, p2, v);
+            if (clear(layer, p, bend, net, space) && clear(layer, bend, p2, net, space))
+                result = v;
+        }
+        visible.emplace(key, result);
+        return result;
+    };
+
+    auto estimate = [&](const Point &p) {
+        double length = infinity;
+        for (int i = 0; i < pads; i++)
+            if (!connected[i])
+                length = std::min(length, octilinearLength(p, padPoints[i]));
+        return length;
+    };
+
+    for (int n = 1; n < pads; n++) {
+        typedef std::pair<double, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        std::vector<double> cost(nodes.size(), infinity);
+        std::vector<int> parent(nodes.size(), -1);
+        std::vector<Point> bendPoints(nodes.size());
+        std::vector<char> closed(nodes.size(), false);
+        int found = -1;
+        std::vector<int> list;
+
+        for (uint i = 0; i < nodes.size(); i++)
+            if (tree[i]) {
+                cost[i] = 0;
+                queue.push(Entry(estimate(nodes[i].point), i));
+            }
+
+        while (!queue.empty()) {
+            int u = queue.top().second;
+            queue.pop();
+            if (closed[u])
+                continue;
+            closed[u] = true;
+            const Node &nu = nodes[u];
+            if (nu.pad >= 0 && !connected[nu.pad]) {
+                found = u;
+                break;
+            }
+            int twin = nu.twin;
+            if (twin >= 0 && !closed[twin]) {
+                double length = cost[u] + (nu.pad >= 0 ? 0 : viaCost * via.diameter);
+                if (length < cost[twin]) {
+                    cost[twin] = length;
+                    parent[twin] = u;
+                    bendPoints[twin] = nu.point;
+                    queue.push(Entry(length + estimate(nu.point), twin));
+                }
+            }
+            neighbours(u, list);
+            for (int v : list) {
+                if (closed[v])
+                    continue;
+                const Point &p = nu.point;
+                const Point &p2 = nodes[v].point;
+                if (cost[u] + octilinearLength(p, p2) + bendCost >= cost[v])
+                    continue;
+                int lineVariant = variant(u, v);
+                if (lineVariant < 0)
+                    continue;
+                Point bend = bendPoint(p, p2, lineVariant);
+                double pathCost = cost[u] + length(nu.layer, p, bend) +
+                                  length(nu.layer, bend, p2) + bendCost;
+                if (!(bend == p) && !(bend == p2))
+                    pathCost += bendCost;
+                if (pathCost < cost[v]) {
+                    cost[v] = pathCost;
+                    parent[v] = u;
+                    bendPoints[v] = bend;
+                    queue.push(Entry(pathCost + estimate(p2), v));
+                }
+            }
+        }
+
+        if (found < 0) {
+            complete = false;
+            break;
+        }
+
+        // Bend of path is node of tree, all nodes of connected pad are in tree
+        std::vector<Node> path;
+        for (int v = found; v >= 0; v = parent[v]) {
+            path.push_back(nodes[v]);
+            tree[v] = true;
+            int u = parent[v];
+            if (u < 0)
+                break;
+            if (!(bendPoints[v] == nodes[v].point) && !(bendPoints[v] == nodes[u].point)) {
+                int layer = nodes[v].layer;
+                path.push_back(Node{layer, -1, -1, bendPoints[v]});
+                addNode(layer, -1, bendPoints[v]);
+                tree.push_back(true);
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        connected[nodes[found].pad] = true;
+        for (uint i = 0; i < nodes.size(); i++)
+            if (nodes[i].pad == nodes[found].pad)
+                tree[i] = true;
+        paths.push_back(path);
+    }
+
+    // Path is split to polylines of layers, via is placed at layer change
+    for (auto &path : paths) {
+        std::vector<Point> polyline;
+        for (uint i = 0; i < path.size(); i++) {
+            const Node &node = path[i];
+            if (i > 0 && node.layer != path[i-1].layer) {
+                lines(path[i-1].layer, polyline, net, width, space, turningRadius,
+                      segments[path[i-1].layer], bends);
+                polyline.clear();
+                if (node.pad < 0) {
+                    Via v(node.point.x, node.point.y);
+                    v.diameter = via.diameter;
+                    v.innerDiameter = via.innerDiameter;
+                    v.net = net;
+                    vias.push_back(v);
+                }
+            }
+            polyline.push_back(node.point);
+        }
+        lines(path.back().layer, polyline, net, width, space, turningRadius,
+              segments[path.back().layer], bends);
+    }
+
+    return complete;
+}
+
+void ShapeRouter::setCosts(int bendCost, int viaCost, const LineCost &lineCost)
+{
+    this->bendCost = bendCost;
+    this->viaCost = viaCost;
+    this->lineCost = lineCost;
+}
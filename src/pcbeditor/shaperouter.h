@@ -0,0 +1,137 @@
+// shaperouter.h
+// Copyright (C) 2026 Alexander Karpeko
+// Coordinate unit: 1 micrometer
+
+#ifndef SHAPEROUTER_H
+#define SHAPEROUTER_H
+
+#include "boardsnapshot.h"
+#include "router.h"
+#include "types.h"
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Gridless router of top and bottom layers. Obstacles are pads, segments,
+// vias and border lines of board, graph nodes are corners of octagons
+// around obstacles inflated by clearance and half track width. Edge of
+// layer is one or two 45 degree lines clear of obstacles, edge between
+// layers is via at node clear on both layers. Memory depends on number
+// of obstacles, not on board area. Corners are found once for each space
+// and are updated by added obstacles, so route of net adds only its pads.
+class ShapeRouter
+{
+public:
+    static constexpr int arcChords = 4;             // arc obstacle is checked by chords
+    static constexpr int bothLayers = 2;            // corners of vias
+    static constexpr int cellSize = 2000;           // obstacle grid cell
+    static constexpr int cornerMargin = 2;          // corner is outside of space
+    static constexpr int defaultBendCost = 1000;    // length added for each line
+    static constexpr int defaultViaCost = 4;        // length added for via: viaCost * diameter
+    static constexpr int minNeighbours = 24;        // nearest nodes tried from node
+
+    // Cost of line p - p2 of layer (0: top, 1: bottom), it is not less than
+    // length of line, so search estimate stays a lower bound
+    typedef std::function<double (int layer, const Point &p, const Point &p2)> LineCost;
+
+    // Used layers, vias are placed if both layers are used
+    ShapeRouter(const BoardSnapshot &board, const Router &router, bool top, bool bottom);
+    // Segments and vias of routed nets are obstacles of next nets
+    void addSegments(const std::vector<Segment> &segments, bool top);
+    void addVias(const std::vector<Via> &vias);
+    // Length of 45 degree lines from p to p2
+    static double octilinearLength(const Point &p, const Point &p2);
+    // Tree of lines and vias from first pad of net, corners are rounded
+    // by arcs if turning radius > 0. Segments: top, bottom, bends: corners
+    // of lines. False: some pad of net is not connected.
+    bool route(int net, int width, const Via &via, int turningRadius,
+               std::vector<Segment> segments[2], std::vector<Via> &vias, int &bends);
+    // Line cost nullptr: length of line
+    void setCosts(int bendCost, int viaCost, const LineCost &lineCost);
+
+private:
+    // Rectangle x1..x2, y1..y2 or line x1, y1 - x2, y2 with radius
+    class Obstacle
+    {
+    public:
+        bool box;
+        int net;
+        int radius;
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    typedef std::unordered_map<unsigned long long, std::vector<int>> Grid;
+
+    // Nets: net of obstacles, -1: obstacles of other nets, -2: no obstacles
+    class Corner
+    {
+    public:
+        int blocker[2];     // nets of obstacles closer than space on layer
+        int owner;          // nets of obstacles of corner
+        Point point;
+    };
+
+    // Corners of obstacles of layer or both layers at space
+    class Corners
+    {
+    public:
+        int layer;
+        int space;
+        Grid grid;                                          // cell, corners
+        std::unordered_map<unsigned long long, int> points; // point, corner
+        std::vector<Corner> corners;
+    };
+
+    class Layer
+    {
+    public:
+        bool used;
+        Grid grid;                          // cell, obstacles
+        std::vector<Obstacle> obstacles;
+        mutable std::vector<int> stamps;    // obstacle is checked by line of stamp
+    };
+
+    class Node
+    {
+    public:
+        int layer;
+        int pad;        // pad of net or -1
+        int twin;       // node of other layer at point or -1
+        Point point;
+    };
+
+    void addCorners(Corners &corners, const Obstacle &obstacle);
+    void addObstacle(int layer, const Obstacle &obstacle);
+    void addSegment(int layer, const Segment &segment);
+    // Nets of obstacles closer than space to point
+    int blocker(int layer, const Point &point, int space) const;
+    // Corners closer than space to obstacle are blocked by it
+    void blockCorners(Corners &corners, int layer, const Obstacle &obstacle);
+    static unsigned long long cell(int cellX, int cellY);
+    static int cellNumber(int x);
+    // Line of net with space to obstacle copper does not cross obstacle
+    bool clear(int layer, const Point &p, const Point &p2, int net, int space) const;
+    void corners(const Obstacle &obstacle, int space, std::vector<Point> &points) const;
+    // Corners are found at first use
+    const Corners &cornerSet(int layer, int space);
+    // Lines of polyline, corners are arcs where arcs are clear
+    void lines(int layer, const std::vector<Point> &polyline, int net, int width, int space,
+               int turningRadius, std::vector<Segment> &segments, int &bends) const;
+    static double obstacleDistance(const Obstacle &obstacle, const Point &p, const Point &p2);
+
+    int bendCost;
+    int clearance;
+    int viaCost;
+    mutable int stamp;
+    Border area;            // border of board
+    Layer layers[2];        // top, bottom
+    BoardSnapshot board;
+    LineCost lineCost;
+    std::map<std::pair<int, int>, Corners> cornerSets;  // layer, space
+};
+
+#endif  // SHAPEROUTER_H
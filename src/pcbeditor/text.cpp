@@ -70,6 +70,7 @@ void Board::fromJson(const QByteArray &array)
     Element::padCornerRadius = object["padCornerRadius"].toDouble();
     polygonSpace = object["polygonSpace"].toInt();
     solderMaskSwell = object["solderMaskSwell"].toInt();
+    netClasses.fromJson(object["netClasses"]);
 
     QJsonArray elementArray(object["elements"].toArray());
     QJsonArray topPolygonArray(object["topPolygons"].toArray());
@@ -111,71 +112,82 @@ void Board::fromJson(const QByteArray &array)
     getNets();
 }
 
-void Board::readPackages(const QByteArray &byteArray)
+QJsonObject Board::optionsJson() const
 {
-    QJsonParseError error;
-    QString str;
-
-    QJsonDocument document(QJsonDocument::fromJson(byteArray, &error));
-    if (document.isNull())
-        throw ExceptionData("Packages file read error: " + error.errorString() +
-                            ", offset: " + str.setNum(error.offset));
-
-    QJsonObject object = document.object();
-
-    if (object["object"].toString() != "packages")
-        throw ExceptionData("File is not a packages file");
-
-    QJsonArray packageArray(object["packages"].toArray());
-    for (auto p : packageArray)
-        Element::addPackage(p);
-}
-
-QJsonObject Board::toJson()
-{
-    QJsonArray elementArray;
-    for (auto e : elements)
-        elementArray.append(e.toJson());
-
-    QJsonArray topPolygonArray;
-    for (auto t : topPolygons)
-        topPolygonArray.append(t.toJson());
-
-    QJsonArray bottomPolygonArray;
-    for (auto b : bottomPolygons)
-        bottomPolygonArray.append(b.toJson());
-
-    QJsonArray topSegmentArray;
-    for (auto t : topSegments)
-        topSegmentArray.append(t.toJson());
-
-    QJsonArray bottomSegmentArray;
-    for (auto b : bottomSegments)
-        bottomSegmentArray.append(b.toJson());
-
-    QJsonArray viaArray;
-    for (auto v : vias)
-        viaArray.append(v.toJson());
-
     QJsonObject object
     {
-        {"borderPolygon", border.toJson()},
-        {"bottomPolygons", bottomPolygonArray},
-        {"bottomSegments", bottomSegmentArray},
-        {"elements", elementArray},
         {"object", "board"},
         {"openMaskOnVia", openMaskOnVia},
         {"padCornerRadius", Element::padCornerRadius},
         {"polygonSpace", polygonSpace},
-        {"solderMaskSwell", solderMaskSwell},
-        {"topPolygons", topPolygonArray},
-        {"topSegments", topSegmentArray},
-        {"vias", viaArray}
+        {"solderMaskSwell", solderMaskSwell}
     };
 
+    // Board without net classes is written as before
+    if (!netClasses.isEmpty())
+        object["netClasses"] = netClasses.toJson();
+
+    return object;
+}
+
+// Section of file, object: journal object kind
+QJsonValue Board::sectionJson(int object) const
+{
+    QJsonArray array;
+
+    switch (object) {
+    case BORDER_OBJECT:
+        return border.toJson();
+    case BOTTOM_POLYGON_OBJECT:
+        for (auto &b : bottomPolygons)
+            array.append(b.toJson());
+        break;
+    case BOTTOM_SEGMENT_OBJECT:
+        for (auto &b : bottomSegments)
+            array.append(b.toJson());
+        break;
+    case ELEMENT_OBJECT:
+        for (auto &e : elements)
+            array.append(e.toJson());
+        break;
+    case TOP_POLYGON_OBJECT:
+        for (auto &t : topPolygons)
+            array.append(t.toJson());
+        break;
+    case TOP_SEGMENT_OBJECT:
+        for (auto &t : topSegments)
+            array.append(t.toJson());
+        break;
+    case VIA_OBJECT:
+        for (auto &v : vias)
+            array.append(v.toJson());
+        break;
+    }
+
+    return array;
+}
+
+QJsonObject Board::toJson() const
+{
+    QJsonObject object = optionsJson();
+    object["borderPolygon"] = sectionJson(BORDER_OBJECT);
+    object["bottomPolygons"] = sectionJson(BOTTOM_POLYGON_OBJECT);
+    object["bottomSegments"] = sectionJson(BOTTOM_SEGMENT_OBJECT);
+    object["elements"] = sectionJson(ELEMENT_OBJECT);
+    object["topPolygons"] = sectionJson(TOP_POLYGON_OBJECT);
+    object["topSegments"] = sectionJson(TOP_SEGMENT_OBJECT);
+    object["vias"] = sectionJson(VIA_OBJECT);
+
     return object;
 }
 
+QByteArray Board::toJsonData()
+{
+    return jsonCache.document(optionsJson(), [this](int object) {
+        return sectionJson(object);
+    });
+}
+
 /********************************************************************************
 
 void Board::componentList(QString &text)
@@ -342,7 +342,7 @@ bool Segment::set90DegreesTurnArc(int turn, int x, int y, int radius_,
     return true;
 }
 
-QJsonObject Segment::toJson()
+QJsonObject Segment::toJson() const
 {
     if (type == LINE) {
         QJsonObject object
@@ -393,7 +393,7 @@ void Track::deleteSegment(int x1, int y1, int x2, int y2)
 
 }
 
-void Track::draw(QPainter &painter)
+void Track::draw(QPainter &painter) const
 {
 
 }
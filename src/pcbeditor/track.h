@@ -35,7 +35,7 @@ public:
     bool reduceLength(int x, int y, int delta);
     bool set90DegreesTurnArc(int turn, int x, int y, int radius_,
                              int net_, int width_);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int net;         // net number
     int radius;
@@ -74,7 +74,7 @@ public:
     void addSegment(int x1, int y1, int x2, int y2);
     void clear();
     void deleteSegment(int x1, int y1, int x2, int y2);
-    void draw(QPainter &painter);
+    void draw(QPainter &painter) const;
     void improve();
     void improveCurve(Curve &curve);
 };
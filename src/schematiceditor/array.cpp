@@ -4,6 +4,8 @@
 #include "array.h"
 #include "exceptiondata.h"
 #include "function.h"
+#include "glyphcache.h"
+#include "library.h"
 #include "text.h"
 #include <cmath>
 #include <QJsonArray>
@@ -18,11 +20,11 @@ QJsonObject ArraySymbol::toJson()
     QString typeString(arrayTypeString[type]);
 
     QJsonArray arrayLines;
-    for (auto l : lines)
+    for (const auto &l : lines)
         arrayLines.append(l.toJson());
 
     QJsonArray arrayPins;
-    for (auto p : pins)
+    for (const auto &p : pins)
         arrayPins.append(p.toJson());
 
     QJsonObject object
@@ -65,7 +67,7 @@ Array::Array(const QJsonObject &object)
     reference = object["reference"].toString();
     name = object["name"].toString();
     number = object["number"].toInt();
-    packageName = object["package"].toString();
+    packageName = Library::intern(object["package"].toString());
     QJsonArray arrayPinNames = object["pinNames"].toArray();
 
     for (auto a : arrayPinNames)
@@ -123,7 +125,7 @@ void Array::addSymbol(const QJsonValue &value)
     Array::symbols[symbol.type] = symbol;
 }
 
-void Array::draw(QPainter &painter)
+void Array::draw(QPainter &painter) const
 {
     const ArraySymbol &symbol = symbols[type];
     int dx;
@@ -132,8 +134,11 @@ void Array::draw(QPainter &painter)
     int t = orientation;
     limit(t, 0, 1);
 
-    for (auto l : lines)
-        painter.drawLine(l.x1, l.y1, l.x2, l.y2);
+    GlyphCache::global().draw(painter, GlyphCache::ARRAY_GLYPH, type, orientation, number,
+                              refX, refY, [this](QPainter &painter) {
+        for (const auto &l : lines)
+            painter.drawLine(l.x1, l.y1, l.x2, l.y2);
+    });
 
     if (name.size())
         painter.drawText(nameTextX, nameTextY + deltaY * number, name);
@@ -164,13 +169,19 @@ void Array::draw(QPainter &painter)
     painter.drawText(referenceTextX, referenceTextY, reference);
 }
 
-bool Array::exist(int x, int y)
+Border Array::bounds() const
 {
     int dx = abs(border.rightX - border.leftX) / 2;
     int dy = abs(border.bottomY - border.topY) / 2;
 
-    if (x >= (centerX - dx) && x <= (centerX + dx) &&
-        y >= (centerY - dy) && y <= (centerY + dy))
+    return Border(centerX - dx, centerY - dy, centerX + dx, centerY + dy);
+}
+
+bool Array::exist(int x, int y) const
+{
+    Border b = bounds();
+
+    if (x >= b.leftX && x <= b.rightX && y >= b.topY && y <= b.bottomY)
         return true;
 
     return false;
@@ -196,7 +207,7 @@ void Array::init()
 
     centerX = (border.leftX + border.rightX) / 2;
     centerY = (border.topY + border.bottomY) / 2;
-    center = (centerX << 16) + centerY;
+    center = Point::key(centerX, centerY);
 
     referenceTextX = refX + symbol.referenceTextX[t];
     referenceTextY = refY + symbol.referenceTextY[t];
@@ -219,7 +230,7 @@ void Array::init()
 
     Line line;
     for (int i = 0; i < number; i++)
-        for (auto sl : symbol.lines) {
+        for (const auto &sl : symbol.lines) {
             line.x1 = refX + c[t] * sl.x1;
             line.y1 = refY + sl.y1 + deltaY * i;
             line.x2 = refX + c[t] * sl.x2;
@@ -229,14 +240,14 @@ void Array::init()
 
     Point pin;
     for (int i = 0; i < number; i++)
-        for (auto sp : symbol.pins) {
+        for (const auto &sp : symbol.pins) {
             pin.x = refX + c[t] * sp.x;
             pin.y = refY + sp.y + symbol.deltaY * i;
             pins.push_back(pin);
         }
 }
 
-bool Array::inside(int leftX, int topY, int rightX, int bottomY)
+bool Array::inside(int leftX, int topY, int rightX, int bottomY) const
 {
     if (centerX >= leftX && centerX <= rightX &&
         centerY >= topY && centerY <= bottomY)
@@ -245,13 +256,13 @@ bool Array::inside(int leftX, int topY, int rightX, int bottomY)
     return false;
 }
 
-QJsonObject Array::toJson()
+QJsonObject Array::toJson() const
 {
     QString typeString(arrayTypeString[type]);
     QString orientationString(arrayOrientationString[orientation]);
 
     QJsonArray arrayPinNames;
-    for (auto p : pinNames)
+    for (const auto &p : pinNames)
         arrayPinNames.append(p);
 
     QJsonObject object
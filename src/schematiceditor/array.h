@@ -45,17 +45,18 @@ public:
     Array(const QJsonObject &object);
     static void addSymbol(const QJsonValue &value);
     static QJsonObject writeSymbols();
-    void draw(QPainter &painter);
-    bool exist(int x, int y);
+    Border bounds() const;
+    void draw(QPainter &painter) const;
+    bool exist(int x, int y) const;
     void init();
-    bool inside(int leftX, int topY, int rightX, int bottomY);
-    QJsonObject toJson();
+    bool inside(int leftX, int topY, int rightX, int bottomY) const;
+    QJsonObject toJson() const;
 
     static std::map<int, ArraySymbol> symbols; // array nameID, array Symbol
     bool showPinName;
     bool showPinNumber;
     Border border;
-    int center;
+    qint64 center;
     int centerX;
     int centerY;
     int deltaY;
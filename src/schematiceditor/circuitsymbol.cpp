@@ -4,6 +4,7 @@
 #include "exceptiondata.h"
 #include "function.h"
 #include "circuitsymbol.h"
+#include "glyphcache.h"
 #include "text.h"
 #include <cstring>
 #include <QJsonArray>
@@ -27,19 +28,28 @@ CircuitSymbol::CircuitSymbol(const QJsonObject &object)
     init();
 }
 
-void CircuitSymbol::draw(QPainter &painter)
+void CircuitSymbol::draw(QPainter &painter) const
 {
-    for (int i = 0; i < linesNumber; i++)
-        painter.drawLine(lines[i][0], lines[i][1], lines[i][2], lines[i][3]);
+    GlyphCache::global().draw(painter, GlyphCache::CIRCUIT_SYMBOL_GLYPH, type, 0, 0,
+                              refX, refY, [this](QPainter &painter) {
+        for (int i = 0; i < linesNumber; i++)
+            painter.drawLine(lines[i][0], lines[i][1], lines[i][2], lines[i][3]);
+    });
 }
 
-bool CircuitSymbol::exist(int x, int y)
+Border CircuitSymbol::bounds() const
 {
     int dx = (circuitSymbolBorder[type][2] - circuitSymbolBorder[type][0]) / 2;
     int dy = (circuitSymbolBorder[type][3] - circuitSymbolBorder[type][1]) / 2;
 
-    if (x >= (centerX - dx) && x <= (centerX + dx) &&
-        y >= (centerY - dy) && y <= (centerY + dy))
+    return Border(centerX - dx, centerY - dy, centerX + dx, centerY + dy);
+}
+
+bool CircuitSymbol::exist(int x, int y) const
+{
+    Border b = bounds();
+
+    if (x >= b.leftX && x <= b.rightX && y >= b.topY && y <= b.bottomY)
         return true;
 
     return false;
@@ -49,7 +59,7 @@ void CircuitSymbol::init()
 {
     centerX = refX + (circuitSymbolBorder[type][0] + circuitSymbolBorder[type][2]) / 2;
     centerY = refY + (circuitSymbolBorder[type][1] + circuitSymbolBorder[type][3]) / 2;
-    center = (centerX << 16) + centerY;
+    center = Point::key(centerX, centerY);
 
     linesNumber = circuitSymbolLinesNumber[type];
     arcsNumber = 0;
@@ -57,7 +67,7 @@ void CircuitSymbol::init()
     placeLines(circuitSymbolLines[type]);
 }
 
-bool CircuitSymbol::inside(int leftX, int topY, int rightX, int bottomY)
+bool CircuitSymbol::inside(int leftX, int topY, int rightX, int bottomY) const
 {
     if (centerX >= leftX && centerX <= rightX &&
         centerY >= topY && centerY <= bottomY)
@@ -76,7 +86,7 @@ void CircuitSymbol::placeLines(const int (*symbolLines)[4])
     }
 }
 
-QJsonObject CircuitSymbol::toJson()
+QJsonObject CircuitSymbol::toJson() const
 {
     QString typeString(circuitSymbolTypeString[type]);
 
@@ -5,6 +5,7 @@
 #define CIRCUITSYMBOL_H
 
 #include "circuitsymbolimage.h"
+#include "types.h"
 #include <QJsonObject>
 #include <QPainter>
 #include <QString>
@@ -16,12 +17,13 @@ public:
     CircuitSymbol() {}
     CircuitSymbol(int type, int refX, int refY);
     CircuitSymbol(const QJsonObject &object);
-    void draw(QPainter &painter);
-    bool exist(int x, int y);
+    Border bounds() const;
+    void draw(QPainter &painter) const;
+    bool exist(int x, int y) const;
     void init();
-    bool inside(int leftX, int topY, int rightX, int bottomY);
+    bool inside(int leftX, int topY, int rightX, int bottomY) const;
     void placeLines(const int (*symbolLines)[4]);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int lines[16][4];   // lines number <= 16
     int arcs[4][4];     // arcs number <= 4
@@ -32,7 +34,7 @@ public:
     int refY;
     int centerX;
     int centerY;
-    int center;
+    qint64 center;
 };
 
 #endif  // CIRCUITSYMBOL_H
@@ -5,10 +5,13 @@
 #include "exceptiondata.h"
 #include "function.h"
 #include "text.h"
+#include <algorithm>
 #include <QJsonArray>
 
 int Device::symbolID = 0;
+QStringList Device::symbolNames;
 std::map<int, DeviceSymbol> Device::symbols;
+std::map<int, LibraryObject> Device::symbolObjects;
 
 DevicePin::DevicePin(const QJsonValue &value)
 {
@@ -21,7 +24,7 @@ DevicePin::DevicePin(const QJsonValue &value)
     unit = object["unit"].toInt();
 }
 
-QJsonObject DevicePin::toJson()
+QJsonObject DevicePin::toJson() const
 {
     QJsonObject object
     {
@@ -35,12 +38,12 @@ QJsonObject DevicePin::toJson()
     return object;
 }
 
-QJsonObject DeviceSymbol::toJson()
+QJsonObject DeviceSymbol::toJson() const
 {
     QString typeString(deviceTypeString[type]);
 
     QJsonArray devicePins;
-    for (auto p : pins)
+    for (const auto &p : pins)
         devicePins.append(p.toJson());
 
     QJsonArray deviceUnits;
@@ -79,21 +82,16 @@ Device::Device(const QString &name, int symbolNameID, int refX, int refY):
 Device::Device(const QJsonObject &object)
 {
     name = object["name"].toString();
-    packageName = object["package"].toString();
+    packageName = Library::intern(object["package"].toString());
     reference = object["reference"].toString();
     symbolName = object["symbolName"].toString();
     QJsonArray deviceUnits(object["units"].toArray());
     refX = deviceUnits[0].toObject()["refX"].toInt();
     refY = deviceUnits[0].toObject()["refY"].toInt();
 
-    for (int i = 0; i < Device::symbolID; i++) {
-        if (!symbolName.compare(Device::symbols[i].name)) {
-            symbolNameID = Device::symbols[i].nameID;
-            break;
-        }
-        if (i == Device::symbolID - 1)
-            throw ExceptionData("Device name error");
-    }
+    symbolNameID = Device::symbolNames.indexOf(symbolName);
+    if (symbolNameID < 0)
+        throw ExceptionData("Device name error");
 
     init();
     units.clear();
@@ -105,57 +103,34 @@ Device::Device(const QJsonObject &object)
 
     for (uint i = 0; i < pins.size(); i++) {
         int n = pins[i].unit - 1;
-        pins[i].x = units[n].refX + symbols[symbolNameID].pins[i].x;
-        pins[i].y = units[n].refY + symbols[symbolNameID].pins[i].y;
+        pins[i].x = units[n].refX + symbol(symbolNameID).pins[i].x;
+        pins[i].y = units[n].refY + symbol(symbolNameID).pins[i].y;
     }
 }
 
 void Device::addSymbol(const QJsonValue &value)
 {
-    DeviceSymbol symbol;
-    QJsonObject object = value.toObject();
-
-    symbol.nameID = Device::symbolID;
-
-    symbol.showPinName = object["showPinName"].toBool();
-
-    symbol.pinNameXLeft = object["pinNameXLeft"].toInt();
-    symbol.pinNameXRight = object["pinNameXRight"].toInt();
-    symbol.pinNameY = object["pinNameY"].toInt();
-
-    QString typeString(object["type"].toString());
-    if (!findIndex(symbol.type, typeString, deviceTypeString, deviceTypes))
-        throw ExceptionData("Array type error");
-    symbol.reference = deviceReference[symbol.type];
-
-    symbol.name = object["name"].toString();
-    symbol.packageName = object["package"].toString();
-
-    QJsonArray devicePins = object["pins"].toArray();
-
-    for (auto d : devicePins) {
-        DevicePin pin(d);
-        symbol.pins.push_back(pin);
-    }
-
-    QJsonArray unitArray = object["units"].toArray();
-    symbol.unitsNumber = unitArray.size();
-
-    for (int i = 0; i < symbol.unitsNumber; i++)
-        Unit::addSymbol(unitArray[i], symbol.nameID);
+    parseSymbol(value, symbolID);
+    symbolNames.append(symbols[symbolID].name);
+    symbolID++;
+}
 
-    Device::symbols[symbol.nameID] = symbol;
-    Device::symbolID++;
+// Symbol is parsed when it is used first time
+void Device::addSymbol(const LibraryObject &object)
+{
+    symbolObjects[symbolID] = object;
+    symbolNames.append(Library::intern(object.name));
+    symbolID++;
 }
 
-void Device::draw(QPainter &painter, int fontSize)
+void Device::draw(QPainter &painter, int fontSize) const
 {
     int dx;
     int h, w;
     int x, y;
     QString str;
 
-    for (auto u : units)
+    for (const auto &u : units)
         u.draw(painter, fontSize);
 
     for (uint i = 0; i < pins.size(); i++) {
@@ -184,7 +159,22 @@ void Device::draw(QPainter &painter, int fontSize)
     painter.drawText(x, y, w, h, Qt::AlignCenter, name);
 }
 
-int Device::exist(int x, int y)
+Border Device::bounds() const
+{
+    Border b = units[0].bounds();
+
+    for (uint i = 1; i < units.size(); i++) {
+        Border b2 = units[i].bounds();
+        b.leftX = std::min(b.leftX, b2.leftX);
+        b.topY = std::min(b.topY, b2.topY);
+        b.rightX = std::max(b.rightX, b2.rightX);
+        b.bottomY = std::max(b.bottomY, b2.bottomY);
+    }
+
+    return b;
+}
+
+int Device::exist(int x, int y) const
 {
     for (uint i = 0; i < units.size(); i++)
         if (units[i].exist(x, y))
@@ -195,7 +185,7 @@ int Device::exist(int x, int y)
 
 void Device::init()
 {
-    const DeviceSymbol &symbol = symbols[symbolNameID];
+    const DeviceSymbol &symbol = Device::symbol(symbolNameID);
     int id;
     int x, y;
     QString str;
@@ -219,7 +209,7 @@ void Device::init()
     symbolName = symbol.name;
 
     DevicePin pin;
-    for (auto sp : symbol.pins) {
+    for (const auto &sp : symbol.pins) {
         pin.name = sp.name;
         pin.unit = sp.unit;
         pin.side = sp.side;
@@ -244,7 +234,7 @@ void Device::init()
 }
 
 bool Device::inside(int leftX, int topY, int rightX, int bottomY,
-                    std::vector<int> &unitNumbers)
+                    std::vector<int> &unitNumbers) const
 {
     unitNumbers.clear();
 
@@ -255,10 +245,62 @@ bool Device::inside(int leftX, int topY, int rightX, int bottomY,
     return unitNumbers.size();
 }
 
-QJsonObject Device::toJson()
+void Device::parseSymbol(const QJsonValue &value, int nameID)
+{
+    DeviceSymbol symbol;
+    QJsonObject object = value.toObject();
+
+    symbol.nameID = nameID;
+
+    symbol.showPinName = object["showPinName"].toBool();
+
+    symbol.pinNameXLeft = object["pinNameXLeft"].toInt();
+    symbol.pinNameXRight = object["pinNameXRight"].toInt();
+    symbol.pinNameY = object["pinNameY"].toInt();
+
+    QString typeString(object["type"].toString());
+    if (!findIndex(symbol.type, typeString, deviceTypeString, deviceTypes))
+        throw ExceptionData("Array type error");
+    symbol.reference = deviceReference[symbol.type];
+
+    symbol.name = object["name"].toString();
+    symbol.packageName = Library::intern(object["package"].toString());
+
+    QJsonArray devicePins = object["pins"].toArray();
+
+    for (auto d : devicePins) {
+        DevicePin pin(d);
+        symbol.pins.push_back(pin);
+    }
+
+    QJsonArray unitArray = object["units"].toArray();
+    symbol.unitsNumber = unitArray.size();
+
+    for (int i = 0; i < symbol.unitsNumber; i++)
+        Unit::addSymbol(unitArray[i], symbol.nameID);
+
+    Device::symbols[symbol.nameID] = symbol;
+}
+
+const DeviceSymbol &Device::symbol(int nameID)
+{
+    auto s = symbols.find(nameID);
+    if (s != symbols.end())
+        return s->second;
+
+    auto o = symbolObjects.find(nameID);
+    if (o == symbolObjects.end())
+        throw ExceptionData("Device symbol error");
+    parseSymbol(o->second.parse(), nameID);
+    symbolObjects.erase(o);
+
+    return symbols[nameID];
+}
+
+QJsonObject Device::toJson() const
 {
     QJsonArray deviceUnits;
-    for (auto u : units)
+    for (const auto &u : units)
         deviceUnits.append(u.toJson());
 
     QJsonObject object
@@ -276,7 +318,9 @@ QJsonObject Device::toJson()
 QJsonObject Device::writeSymbols()
 {
     QJsonArray deviceSymbols;
-    for (auto d : Device::symbols)
+    for (int i = 0; i < symbolID; i++)
+        symbol(i);
+    for (const auto &d : Device::symbols)
         deviceSymbols.append(d.second.toJson());
 
     QJsonObject object
@@ -4,9 +4,11 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include "library.h"
 #include "unit.h"
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QStringList>
 
 class DevicePin
 {
@@ -15,7 +17,7 @@ public:
     DevicePin(int x, int y, QString name, bool side, int unit):
         x(x), y(y), name(name), side(side), unit(unit) {}
     DevicePin(const QJsonValue &value);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     int x;
     int y;
@@ -27,7 +29,7 @@ public:
 class DeviceSymbol
 {
 public:
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     bool showPinName;
     int nameID;
@@ -51,18 +53,24 @@ public:
     Device(const QString &name, int symbolNameID, int refX, int refY);
     Device(const QJsonObject &object);
     static void addSymbol(const QJsonValue &value);
+    static void addSymbol(const LibraryObject &object);
+    static const DeviceSymbol &symbol(int nameID);
     static QJsonObject writeSymbols();
-    void draw(QPainter &painter, int fontSize);
-    int exist(int x, int y);
+    Border bounds() const;
+    void draw(QPainter &painter, int fontSize) const;
+    int exist(int x, int y) const;
     void init();
     bool inside(int leftX, int topY, int rightX, int bottomY,
-                std::vector<int> &unitNumbers);
-    QJsonObject toJson();
+                std::vector<int> &unitNumbers) const;
+    static void parseSymbol(const QJsonValue &value, int nameID);
+    QJsonObject toJson() const;
 
     static int symbolID;
-    static std::map <int, DeviceSymbol> symbols;  // device nameID, deviceSymbol
+    static QStringList symbolNames;                     // index: device nameID
+    static std::map <int, DeviceSymbol> symbols;        // device nameID, deviceSymbol
+    static std::map <int, LibraryObject> symbolObjects; // symbols to be parsed
     bool showPinName;
-    int center;         // device center is center of 1st unit
+    qint64 center;      // device center is center of 1st unit
     int symbolNameID;
     int pinNameXLeft;
     int pinNameXRight;
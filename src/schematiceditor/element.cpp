@@ -4,11 +4,13 @@
 #include "element.h"
 #include "exceptiondata.h"
 #include "function.h"
+#include "glyphcache.h"
 #include "text.h"
 #include <cmath>
 #include <QJsonArray>
 
 std::map<int, ElementSymbol> Element::symbols;
+std::map<int, LibraryObject> Element::symbolObjects;
 
 QJsonObject ElementSymbol::toJson()
 {
@@ -18,15 +20,15 @@ QJsonObject ElementSymbol::toJson()
     QString typeString(elementTypeString[type]);
 
     QJsonArray elementArcs;
-    for (auto a : arcs)
+    for (const auto &a : arcs)
         elementArcs.append(a.toJson());
 
     QJsonArray elementLines;
-    for (auto l : lines)
+    for (const auto &l : lines)
         elementLines.append(l.toJson());
 
     QJsonArray elementPins;
-    for (auto p : pins)
+    for (const auto &p : pins)
         elementPins.append(p.toJson());
 
     int size = orientations;
@@ -64,7 +66,7 @@ Element::Element(const QJsonObject &object)
 {
     mirror = object["mirror"].toBool();
     QString orientationString(object["orientation"].toString());
-    packageName = object["package"].toString();
+    packageName = Library::intern(object["package"].toString());
     padsMap = object["padsMap"].toInt();
     refX = object["refX"].toInt();
     refY = object["refY"].toInt();
@@ -131,11 +133,21 @@ void Element::addSymbol(const QJsonValue &value)
     Element::symbols[symbol.type] = symbol;
 }
 
+// Symbol is parsed when it is used first time, name of object is type
+void Element::addSymbol(const LibraryObject &object)
+{
+    int type;
+
+    if (!findIndex(type, object.name, elementTypeString, elementTypes))
+        throw ExceptionData("Element type error");
+    symbolObjects[type] = object;
+}
+
 void Element::defaultPadsMap()
 {
     padsMap = 0;
 
-    for (auto e : equalPinsTypes)
+    for (const auto &e : equalPinsTypes)
         if (type == e) {
             if (pins.size() == 2)
                 padsMap = 12;
@@ -143,13 +155,16 @@ void Element::defaultPadsMap()
         }
 }
 
-void Element::draw(QPainter &painter, bool showText, bool showPinNumbers)
+void Element::draw(QPainter &painter, bool showText, bool showPinNumbers) const
 {
-    for (auto a : arcs)  // angle unit: 1/16th of degree
-        painter.drawArc(a.x, a.y, a.w, a.h, a.startAngle << 4, a.spanAngle << 4);
+    GlyphCache::global().draw(painter, GlyphCache::ELEMENT_GLYPH, type, orientation, 0,
+                              refX, refY, [this](QPainter &painter) {
+        for (const auto &a : arcs)  // angle unit: 1/16th of degree
+            painter.drawArc(a.x, a.y, a.w, a.h, a.startAngle << 4, a.spanAngle << 4);
 
-    for (auto l : lines)
-        painter.drawLine(l.x1, l.y1, l.x2, l.y2);
+        for (const auto &l : lines)
+            painter.drawLine(l.x1, l.y1, l.x2, l.y2);
+    });
 
     if (showText) {
         painter.drawText(referenceTextX, referenceTextY, reference);
@@ -176,13 +191,19 @@ void Element::draw(QPainter &painter, bool showText, bool showPinNumbers)
         }
 }
 
-bool Element::exist(int x, int y)
+Border Element::bounds() const
 {
     int dx = abs(border.rightX - border.leftX) / 2;
     int dy = abs(border.bottomY - border.topY) / 2;
 
-    if (x >= (centerX - dx) && x <= (centerX + dx) &&
-        y >= (centerY - dy) && y <= (centerY + dy))
+    return Border(centerX - dx, centerY - dy, centerX + dx, centerY + dy);
+}
+
+bool Element::exist(int x, int y) const
+{
+    Border b = bounds();
+
+    if (x >= b.leftX && x <= b.rightX && y >= b.topY && y <= b.bottomY)
         return true;
 
     return false;
@@ -190,7 +211,7 @@ bool Element::exist(int x, int y)
 
 void Element::init()
 {
-    const ElementSymbol &symbol = symbols[type];
+    const ElementSymbol &symbol = Element::symbol(type);
 
     constexpr int a[orientations][2] =  // arc
     {
@@ -218,7 +239,7 @@ void Element::init()
 
     centerX = (border.leftX + border.rightX) / 2;
     centerY = (border.topY + border.bottomY) / 2;
-    center = (centerX << 16) + centerY;
+    center = Point::key(centerX, centerY);
 
     referenceTextX = refX + symbol.referenceTextX[t];
     referenceTextY = refY + symbol.referenceTextY[t];
@@ -231,7 +252,7 @@ void Element::init()
     reference = symbol.reference;
 
     Arc arc;
-    for (auto sa : symbol.arcs) {
+    for (const auto &sa : symbol.arcs) {
         int arcCenterX = sa.x + sa.w / 2;
         int arcCenterY = sa.y + sa.h / 2;
         int arcCenterX2 = refX + l[t][0] * arcCenterX + l[t][1] * arcCenterY;
@@ -246,7 +267,7 @@ void Element::init()
     }
 
     Line line;
-    for (auto sl : symbol.lines) {
+    for (const auto &sl : symbol.lines) {
         line.x1 = refX + l[t][0] * sl.x1 + l[t][1] * sl.y1;
         line.y1 = refY + l[t][2] * sl.x1 + l[t][3] * sl.y1;
         line.x2 = refX + l[t][0] * sl.x2 + l[t][1] * sl.y2;
@@ -255,14 +276,14 @@ void Element::init()
     }
 
     Point pin;
-    for (auto sp : symbol.pins) {
+    for (const auto &sp : symbol.pins) {
         pin.x = refX + l[t][0] * sp.x + l[t][1] * sp.y;
         pin.y = refY + l[t][2] * sp.x + l[t][3] * sp.y;
         pins.push_back(pin);
     }
 }
 
-bool Element::inside(int leftX, int topY, int rightX, int bottomY)
+bool Element::inside(int leftX, int topY, int rightX, int bottomY) const
 {
     if (centerX >= leftX && centerX <= rightX &&
         centerY >= topY && centerY <= bottomY)
@@ -271,7 +292,23 @@ bool Element::inside(int leftX, int topY, int rightX, int bottomY)
     return false;
 }
 
-QJsonObject Element::toJson()
+const ElementSymbol &Element::symbol(int type)
+{
+    auto s = symbols.find(type);
+    if (s != symbols.end())
+        return s->second;
+
+    auto o = symbolObjects.find(type);
+    if (o == symbolObjects.end())
+        throw ExceptionData("Element symbol error");
+    QJsonObject object = o->second.parse();
+    symbolObjects.erase(o);
+    addSymbol(object);
+
+    return symbols[type];
+}
+
+QJsonObject Element::toJson() const
 {
     QString typeString(elementTypeString[type]);
     QString orientationString(elementOrientationString[orientation]);
@@ -295,6 +332,8 @@ QJsonObject Element::toJson()
 QJsonObject Element::writeSymbols()
 {
     QJsonArray elementSymbols;
+    while (!symbolObjects.empty())
+        symbol(symbolObjects.begin()->first);
     for (auto e : Element::symbols)
         elementSymbols.append(e.second.toJson());
 
@@ -5,6 +5,7 @@
 #define ELEMENT_H
 
 #include "elementimage.h"
+#include "library.h"
 #include "types.h"
 #include <QPainter>
 #include <QString>
@@ -40,19 +41,23 @@ public:
             int orientation, QString value = "1");
     Element(const QJsonObject &object);
     static void addSymbol(const QJsonValue &value);
+    static void addSymbol(const LibraryObject &object);
+    static const ElementSymbol &symbol(int type);
     static QJsonObject writeSymbols();
-    void draw(QPainter &painter, bool showText = true, bool showPinNumbers = false);
-    bool exist(int x, int y);
+    Border bounds() const;
+    void draw(QPainter &painter, bool showText = true, bool showPinNumbers = false) const;
+    bool exist(int x, int y) const;
     void init();
-    bool inside(int leftX, int topY, int rightX, int bottomY);
+    bool inside(int leftX, int topY, int rightX, int bottomY) const;
     void defaultPadsMap();
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     static std::map <int, ElementSymbol> symbols;  // element type, elementSymbol
+    static std::map <int, LibraryObject> symbolObjects; // symbols to be parsed
     static constexpr int orientations = 8;
     bool mirror;
     Border border;
-    int center;
+    qint64 center;
     int centerX;
     int centerY;
     int orientation;        // UP
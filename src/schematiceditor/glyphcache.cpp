@@ -0,0 +1,34 @@
+// glyphcache.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "glyphcache.h"
+
+// Picture is recorded with pen and brush of painter at origin of symbol
+void GlyphCache::draw(QPainter &painter, int kind, int type, int orientation, int variant,
+                      int refX, int refY, const Function &function)
+{
+    const QPen &pen = painter.pen();
+    const QBrush &brush = painter.brush();
+    uint brushColor = (brush.style() == Qt::NoBrush) ? 0 : brush.color().rgba();
+    Key key(kind, type, orientation, variant, pen.color().rgba(), pen.width(), brushColor);
+
+    auto i = pictures.find(key);
+    if (i == pictures.end()) {
+        if (pictures.size() >= maxPictures)
+            pictures.clear();
+        i = pictures.emplace(key, QPicture()).first;
+        QPainter picturePainter(&i->second);
+        picturePainter.setPen(pen);
+        picturePainter.setBrush(brush);
+        picturePainter.translate(-refX, -refY);
+        function(picturePainter);
+    }
+
+    painter.drawPicture(refX, refY, i->second);
+}
+
+GlyphCache &GlyphCache::global()
+{
+    static GlyphCache cache;
+    return cache;
+}
@@ -0,0 +1,44 @@
+// glyphcache.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <QColor>
+#include <QPainter>
+#include <QPicture>
+#include <functional>
+#include <map>
+#include <tuple>
+
+// Recorded lines and arcs of symbols. Symbols of same kind, type,
+// orientation and variant differ only by reference point, so picture
+// is recorded once and replayed at each reference point. Pictures are
+// vector data, they are drawn at any zoom. Used by GUI thread only.
+class GlyphCache
+{
+public:
+    static constexpr int maxPictures = 4096;
+
+    enum GlyphKind
+    {
+        ARRAY_GLYPH, CIRCUIT_SYMBOL_GLYPH, ELEMENT_GLYPH, UNIT_GLYPH
+    };
+
+    typedef std::function<void (QPainter &painter)> Function;
+
+    void clear() { pictures.clear(); }
+    // Function draws symbol at reference point, it is called
+    // when picture of symbol and pen is not recorded
+    void draw(QPainter &painter, int kind, int type, int orientation, int variant,
+              int refX, int refY, const Function &function);
+    static GlyphCache &global();
+
+private:
+    // Kind, type, orientation, variant, pen color, pen width, brush color
+    typedef std::tuple<int, int, int, int, uint, int, uint> Key;
+
+    std::map<Key, QPicture> pictures;
+};
+
+#endif  // GLYPHCACHE_H
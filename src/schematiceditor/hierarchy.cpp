@@ -0,0 +1,201 @@
+// hierarchy.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "exceptiondata.h"
+#include "hierarchy.h"
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+
+Hierarchy::Hierarchy(Schematic &openSheet):
+    openSheetChanged(true), openSheet(openSheet)
+{
+    openSheet.journal.addListener([this](const JournalChange &, bool) {
+        openSheetChanged = true;
+    });
+}
+
+// Nets of instance sheet follow nets of sheet file
+int Hierarchy::addInstance(const QString &filename, const QString &path,
+                           std::vector<QString> &stack, std::vector<Instance> &instances)
+{
+    if (std::find(stack.begin(), stack.end(), filename) != stack.end())
+        throw ExceptionData("Sheet is instance of itself: " + filename);
+
+    const Sheet &s = sheet(filename);
+    int number = instances.size();
+    instances.push_back(Instance{int(parents.size()), path, &s});
+    for (int i = 0; i < s.nets; i++)
+        parents.push_back(parents.size());
+
+    stack.push_back(filename);
+    QDir directory(QFileInfo(filename).absolutePath());
+    for (const auto &i : s.sheets) {
+        int child = addInstance(directory.absoluteFilePath(i.filename), path + i.name + "/",
+                                stack, instances);
+        const Sheet &c = *instances[child].sheet;
+        for (const auto &p : i.ports) {
+            if (std::find(c.ports.begin(), c.ports.end(), p.first) == c.ports.end())
+                throw ExceptionData(path + i.name + ": " + p.first + " is not port of " +
+                                    i.filename);
+            auto n = c.netNames.find(p.first);
+            auto n2 = s.netNames.find(p.second);
+            if (n == c.netNames.end() || n2 == s.netNames.end())
+                throw ExceptionData(path + i.name + ": port " + p.first + " or net " +
+                                    p.second + " has no wires");
+            unite(instances[child].firstNet + n->second, instances[number].firstNet + n2->second);
+        }
+    }
+    stack.pop_back();
+
+    return number;
+}
+
+int Hierarchy::find(int net)
+{
+    while (parents[net] != net) {
+        parents[net] = parents[parents[net]];
+        net = parents[net];
+    }
+
+    return net;
+}
+
+// Nets are numbered in order of instances, nets without pads are not numbered
+QJsonObject Hierarchy::netlist(const QString &topFilename)
+{
+    std::vector<Instance> instances;
+    std::vector<QString> stack;
+
+    if (topFilename.isEmpty())
+        throw ExceptionData("Sheet file is not saved");
+
+    checkedFiles.clear();
+    parents.clear();
+    addInstance(QFileInfo(topFilename).absoluteFilePath(), QString(), stack, instances);
+
+    int ground = -1;
+    int groundIec = -1;
+    for (const auto &i : instances) {
+        if (i.sheet->groundNet >= 0) {
+            int net = i.firstNet + i.sheet->groundNet;
+            if (ground < 0)
+                ground = net;
+            unite(ground, net);
+        }
+        if (i.sheet->groundIecNet >= 0) {
+            int net = i.firstNet + i.sheet->groundIecNet;
+            if (groundIec < 0)
+                groundIec = net;
+            unite(groundIec, net);
+        }
+    }
+
+    std::vector<int> numbers(parents.size(), -1);
+    for (const auto &i : instances)
+        for (const auto &e : i.sheet->elements)
+            for (const auto &p : e.toObject()["pads"].toArray()) {
+                int net = p.toObject()["net"].toInt();
+                if (net >= 0)
+                    numbers[find(i.firstNet + net)] = 0;
+            }
+    int nets = 0;
+    for (uint i = 0; i < parents.size(); i++)
+        if (parents[i] == int(i) && !numbers[i])
+            numbers[i] = nets++;
+
+    QJsonArray netlistElements;
+    for (const auto &i : instances)
+        for (const auto &e : i.sheet->elements) {
+            QJsonObject object(e.toObject());
+            QJsonArray pads;
+            for (const auto &p : object["pads"].toArray()) {
+                QJsonObject pad(p.toObject());
+                int net = pad["net"].toInt();
+                if (net >= 0)
+                    pad["net"] = numbers[find(i.firstNet + net)];
+                pads.append(pad);
+            }
+            object["pads"] = pads;
+            object["reference"] = i.path + object["reference"].toString();
+            netlistElements.append(object);
+        }
+
+    QJsonObject object
+    {
+        {"object", "netlist"},
+        {"elements", netlistElements}
+    };
+
+    return object;
+}
+
+void Hierarchy::setOpenFile(const QString &filename)
+{
+    openFile = filename.isEmpty() ? QString() : QFileInfo(filename).absoluteFilePath();
+    openSheetChanged = true;
+}
+
+// Sheet file is read and solved when it is changed
+const Hierarchy::Sheet &Hierarchy::sheet(const QString &filename)
+{
+    Sheet &s = sheets[filename];
+    if (!checkedFiles.insert(filename).second)
+        return s;
+
+    if (filename == openFile) {
+        if (openSheetChanged) {
+            solve(s, openSheet);
+            s.modified = QDateTime();
+            openSheetChanged = false;
+        }
+        return s;
+    }
+
+    QFileInfo info(filename);
+    if (!info.exists())
+        throw ExceptionData(filename + " is not found");
+    if (s.modified.isValid() && s.modified == info.lastModified())
+        return s;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        throw ExceptionData(filename + " open error");
+    Schematic schematic(false);
+    schematic.fromJson(file.readAll());
+    file.close();
+
+    solve(s, schematic);
+    s.modified = info.lastModified();
+
+    return s;
+}
+
+void Hierarchy::solve(Sheet &sheet, Schematic &schematic)
+{
+    sheet.elements = schematic.netlist()["elements"].toArray();
+    schematic.groundNets(sheet.groundNet, sheet.groundIecNet);
+    sheet.ports = schematic.ports;
+    sheet.sheets = schematic.sheets;
+
+    sheet.netNames.clear();
+    sheet.nets = 0;
+    for (const auto &w : schematic.wires) {
+        sheet.nets = std::max(sheet.nets, w.net + 1);
+        if (!w.name.isEmpty() && w.net >= 0)
+            sheet.netNames[w.name] = w.net;
+    }
+    for (const auto &p : schematic.pins)
+        sheet.nets = std::max(sheet.nets, p.net + 1);
+    sheet.nets = std::max({sheet.nets, sheet.groundNet + 1, sheet.groundIecNet + 1});
+}
+
+void Hierarchy::unite(int net, int net2)
+{
+    net = find(net);
+    net2 = find(net2);
+    if (net != net2)
+        parents[std::max(net, net2)] = std::min(net, net2);
+}
@@ -0,0 +1,67 @@
+// hierarchy.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include "schematic.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <map>
+#include <set>
+#include <vector>
+
+// Design of many sheet files. Sheet instances are joined to parent sheet
+// by ports, ground nets are common. Nets of each sheet file are kept,
+// only changed sheets are solved again, then instance nets are united.
+class Hierarchy
+{
+public:
+    explicit Hierarchy(Schematic &openSheet);
+    // Netlist of top sheet and its instances, references of instance
+    // symbols get path of instance names
+    QJsonObject netlist(const QString &topFilename);
+    // Sheet of editor is used instead of its file
+    void setOpenFile(const QString &filename);
+
+private:
+    // Nets of sheet file
+    class Sheet
+    {
+    public:
+        int groundIecNet;
+        int groundNet;
+        int nets;                           // nets are 0 .. nets-1
+        QDateTime modified;
+        QJsonArray elements;                // netlist elements, sheet nets
+        std::map<QString, int> netNames;    // net name, net
+        std::vector<QString> ports;
+        std::vector<SheetInstance> sheets;
+    };
+
+    class Instance
+    {
+    public:
+        int firstNet;                       // united net of sheet net 0
+        QString path;                       // prefix of references
+        const Sheet *sheet;
+    };
+
+    int addInstance(const QString &filename, const QString &path,
+                    std::vector<QString> &stack, std::vector<Instance> &instances);
+    int find(int net);
+    const Sheet &sheet(const QString &filename);
+    void solve(Sheet &sheet, Schematic &schematic);
+    void unite(int net, int net2);
+
+    bool openSheetChanged;
+    QString openFile;
+    Schematic &openSheet;
+    std::map<QString, Sheet> sheets;        // absolute filename, sheet
+    std::set<QString> checkedFiles;         // files checked in this netlist
+    std::vector<int> parents;               // union-find of instance nets
+};
+
+#endif  // HIERARCHY_H
@@ -0,0 +1,142 @@
+// objectstore.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef OBJECTSTORE_H
+#define OBJECTSTORE_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Symbols in contiguous storage. Identifier of symbol does not change
+// when symbol is moved or replaced, erased identifiers are not reused.
+// Position index: center, identifier. Symbol placed at center
+// of other symbol replaces it.
+template<typename Type>
+class ObjectStore
+{
+public:
+    typedef typename std::vector<Type>::iterator iterator;
+    typedef typename std::vector<Type>::const_iterator const_iterator;
+
+    ObjectStore(): nextID(0) {}
+    Type &operator[](int id) { return objects[indexes[id]]; }
+    const Type &operator[](int id) const { return objects[indexes[id]]; }
+    // Identifier of added or replaced symbol
+    int add(const Type &object);
+    iterator begin() { return objects.begin(); }
+    const_iterator begin() const { return objects.begin(); }
+    // Identifiers of symbols in order of centers, it does not depend on
+    // order of storage that is changed by erase
+    std::vector<int> centerOrder() const;
+    void clear();
+    bool empty() const { return objects.empty(); }
+    iterator end() { return objects.end(); }
+    const_iterator end() const { return objects.end(); }
+    void erase(int id);
+    // Identifier of symbol at center, -1: no symbol
+    int find(qint64 center) const;
+    // Identifier of symbol in store
+    int id(const Type &object) const { return ids[&object - objects.data()]; }
+    // Symbols are updated in place, index follows new centers
+    void replace(const std::vector<int> &ids, const std::vector<Type> &symbols);
+    void replace(int id, const Type &object) { replace(std::vector<int>{id}, {object}); }
+    int size() const { return objects.size(); }
+
+private:
+    int nextID;
+    std::unordered_map<qint64, int> centers;    // center, identifier
+    std::vector<int> ids;                   // identifier of object
+    std::vector<int> indexes;               // object index of identifier, -1: erased
+    std::vector<Type> objects;
+};
+
+template<typename Type>
+int ObjectStore<Type>::add(const Type &object)
+{
+    int id = find(object.center);
+    if (id >= 0) {
+        objects[indexes[id]] = object;
+        return id;
+    }
+
+    id = nextID++;
+    indexes.push_back(objects.size());
+    ids.push_back(id);
+    objects.push_back(object);
+    centers[object.center] = id;
+
+    return id;
+}
+
+template<typename Type>
+std::vector<int> ObjectStore<Type>::centerOrder() const
+{
+    std::vector<std::pair<qint64, int>> keys;
+    for (uint i = 0; i < objects.size(); i++)
+        keys.push_back(std::make_pair(objects[i].center, ids[i]));
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> order;
+    for (const auto &k : keys)
+        order.push_back(k.second);
+
+    return order;
+}
+
+template<typename Type>
+void ObjectStore<Type>::clear()
+{
+    nextID = 0;
+    centers.clear();
+    ids.clear();
+    indexes.clear();
+    objects.clear();
+}
+
+// Last object takes place of erased object
+template<typename Type>
+void ObjectStore<Type>::erase(int id)
+{
+    int index = indexes[id];
+    int last = objects.size() - 1;
+
+    centers.erase(objects[index].center);
+    if (index != last) {
+        objects[index] = std::move(objects[last]);
+        ids[index] = ids[last];
+        indexes[ids[index]] = index;
+    }
+    objects.pop_back();
+    ids.pop_back();
+    indexes[id] = -1;
+}
+
+template<typename Type>
+int ObjectStore<Type>::find(qint64 center) const
+{
+    auto i = centers.find(center);
+    if (i == centers.end())
+        return -1;
+    return i->second;
+}
+
+// Old centers of symbols are free before symbols take new centers
+template<typename Type>
+void ObjectStore<Type>::replace(const std::vector<int> &ids, const std::vector<Type> &symbols)
+{
+    for (int id : ids)
+        centers.erase(objects[indexes[id]].center);
+
+    for (int i = 0; i < int(ids.size()); i++) {
+        int other = find(symbols[i].center);
+        if (other >= 0)
+            erase(other);
+        objects[indexes[ids[i]]] = symbols[i];
+        centers[symbols[i].center] = ids[i];
+    }
+}
+
+#endif  // OBJECTSTORE_H
@@ -41,15 +41,15 @@ PackageSelector::PackageSelector(Schematic &schematic, QDialog *parent):
     addData(schematic.arrays);
     addData(schematic.devices);
 
-    firstElementRow = centers.size();
-    for (auto s : schematic.elements) {
-        centers.push_back(s.first);
-        names.push_back(s.second.reference + "  " + s.second.value);
-        packageNames.push_back(s.second.packageName);
-        padsMaps.push_back(s.second.padsMap);
-        pins.push_back(s.second.pins.size());
+    firstElementRow = ids.size();
+    for (const auto &s : schematic.elements) {
+        ids.push_back(schematic.elements.find(s.center));
+        names.push_back(s.reference + "  " + s.value);
+        packageNames.push_back(s.packageName);
+        padsMaps.push_back(s.padsMap);
+        pins.push_back(s.pins.size());
     }
-    pastLastElementRow = centers.size();
+    pastLastElementRow = ids.size();
 
     for (uint row = 0; row < names.size(); row++) {
         QString str = names[row] + "  " + packageNames[row];
@@ -60,23 +60,34 @@ PackageSelector::PackageSelector(Schematic &schematic, QDialog *parent):
     }
     elementListWidget->setCurrentRow(0);
 
-    for (uint row = 0; row < schematic.packages.size(); row++)
-        packageListWidget->insertItem(row, schematic.packages[row].name);
+    for (int row = 0; row < Library::packages().size(); row++)
+        packageListWidget->insertItem(row, Library::packages().name(row));
     packageListWidget->setCurrentRow(0);
 }
 
+// Rows are in order of symbols, changed symbols are recorded
 void PackageSelector::accept()
 {
     int row = 0;
 
-    for (auto &s : schematic.arrays)
-        s.second.packageName = packageNames[row++];
-    for (auto &s : schematic.devices)
-        s.second.packageName = packageNames[row++];
+    schematic.journal.begin("Select packages");
+    for (auto &s : schematic.arrays) {
+        QJsonObject before = s.toJson();
+        s.packageName = packageNames[row++];
+        schematic.journal.record(Schematic::ARRAY_OBJECT, s.center, before, s.toJson());
+    }
+    for (auto &s : schematic.devices) {
+        QJsonObject before = s.toJson();
+        s.packageName = packageNames[row++];
+        schematic.journal.record(Schematic::DEVICE_OBJECT, s.center, before, s.toJson());
+    }
     for (auto &s : schematic.elements) {
-        s.second.packageName = packageNames[row];
-        s.second.padsMap = padsMaps[row++];
+        QJsonObject before = s.toJson();
+        s.packageName = packageNames[row];
+        s.padsMap = padsMaps[row++];
+        schematic.journal.record(Schematic::ELEMENT_OBJECT, s.center, before, s.toJson());
     }
+    schematic.journal.end();
 
     done(1);
 }
@@ -84,12 +95,12 @@ void PackageSelector::accept()
 template<typename Type>
 void PackageSelector::addData(const Type &type)
 {
-    for (auto t : type) {
-        centers.push_back(t.first);
-        names.push_back(t.second.reference + "  " + t.second.name);
-        packageNames.push_back(t.second.packageName);
+    for (const auto &t : type) {
+        ids.push_back(type.find(t.center));
+        names.push_back(t.reference + "  " + t.name);
+        packageNames.push_back(t.packageName);
         padsMaps.push_back(0);
-        pins.push_back(t.second.pins.size());
+        pins.push_back(t.pins.size());
     }
 }
 
@@ -98,7 +109,7 @@ void PackageSelector::clearPackage()
     int row = elementListWidget->currentRow();
     packageNames[row].clear();
     if (row >= firstElementRow && row < pastLastElementRow) {
-        const Element &element = schematic.elements[centers[row]];
+        const Element &element = schematic.elements[ids[row]];
         bool isEqualPinsType = false;
         for (auto e : equalPinsTypes)
             if (element.type == e) {
@@ -117,9 +128,9 @@ void PackageSelector::connectPackage()
 {
     int row = elementListWidget->currentRow();
     int row2 = packageListWidget->currentRow();
-    if (pins[row] != schematic.packages[row2].pads.size())
+    if (pins[row] != Library::packages().padsNumber(row2))
         return;
-    packageNames[row] = schematic.packages[row2].name;
+    packageNames[row] = Library::packages().name(row2);
     updateItem(row);
 }
 
@@ -127,7 +138,7 @@ void PackageSelector::drawElement(QPainter &painter, int row)
 {
     painter.setPen(QColor(200, 100, 100));
 
-    const Element &e = schematic.elements[centers[row]];
+    const Element &e = schematic.elements[ids[row]];
     int orientation = e.orientation;
     QString packageName = e.packageName;
     int padsMap = e.padsMap;
@@ -150,23 +161,16 @@ void PackageSelector::drawPackage(QPainter &painter, int row)
     double scale;
     int d, h, inD, w;
     int dx, dy;
-    int index;
     int rx, ry;
     int x, y;
     QString packageName = packageNames[row];
     QString str;
 
-    if (schematic.packages.size() == 0)
-        return;
-
-    for (index = 0; index < schematic.packages.size(); index++)
-        if (!packageName.compare(schematic.packages[index].name))
-            break;
-
-    if (index == schematic.packages.size())
+    auto packagePointer = Library::packages().package(packageName);
+    if (!packagePointer)
         return;
 
-    const Package &package = schematic.packages[index];
+    const Package &package = *packagePointer;
 
     length = 0.6 * (packageWindowWidth < packageWindowHeight ?
              packageWindowWidth : packageWindowHeight);
@@ -230,7 +234,7 @@ void PackageSelector::itemSelectionChanged()
     if (row < firstElementRow || row >= pastLastElementRow)
         return;
 
-    const Element &element = schematic.elements[centers[row]];
+    const Element &element = schematic.elements[ids[row]];
 
     for (auto e : equalPinsTypes)
         if (element.type == e)
@@ -243,25 +247,14 @@ void PackageSelector::itemSelectionChanged()
         pinNumbersLabel->setText(str);
     }
 
-    if (schematic.packages.size() == 0)
+    auto package = Library::packages().package(packageNames[row]);
+    if (!package)
         return;
 
-    int index;
-    QString packageName = packageNames[row];
-
-    for (index = 0; index < schematic.packages.size(); index++)
-        if (!packageName.compare(schematic.packages[index].name))
-            break;
-
-    if (index == schematic.packages.size())
+    if (element.pins.size() != package->pads.size())
         return;
 
-    const Package &package = schematic.packages[index];
-
-    if (element.pins.size() != package.pads.size())
-        return;
-
-    switch (package.pads.size()) {
+    switch (package->pads.size()) {
     case 2:
         pad2NumbersComboBox->show();
         mapButton->setEnabled(true);
@@ -287,33 +280,22 @@ void PackageSelector::mapPads()
     if (row < firstElementRow || row >= pastLastElementRow)
         return;
 
-    const Element &element = schematic.elements[centers[row]];
+    const Element &element = schematic.elements[ids[row]];
 
     for (auto e : equalPinsTypes)
         if (element.type == e)
             return;
 
-    if (schematic.packages.size() == 0)
-        return;
-
-    int index;
-    QString packageName = packageNames[row];
-
-    for (index = 0; index < schematic.packages.size(); index++)
-        if (!packageName.compare(schematic.packages[index].name))
-            break;
-
-    if (index == schematic.packages.size())
+    auto package = Library::packages().package(packageNames[row]);
+    if (!package)
         return;
 
-    const Package &package = schematic.packages[index];
-
-    if (element.pins.size() != package.pads.size())
+    if (element.pins.size() != package->pads.size())
         return;
 
     QString text;
 
-    switch (package.pads.size()) {
+    switch (package->pads.size()) {
     case 2:
         text = pad2NumbersComboBox->currentText();
         padsMaps[row] = padsMapFromString(text, 2);
@@ -329,7 +311,7 @@ void PackageSelector::mapPads()
         break;
     }
 
-    if (package.pads.size() >= 2 || package.pads.size() <= 4)
+    if (package->pads.size() >= 2 || package->pads.size() <= 4)
         updateItem(row);
 }
 
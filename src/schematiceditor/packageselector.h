@@ -47,7 +47,7 @@ private:
     int pastLastElementRow;
     QLineEdit *pinPadNumbers[maxSelectorSize];
     Schematic &schematic;
-    std::vector<int> centers;
+    std::vector<int> ids;   // symbol identifiers of rows
     std::vector<int> padsMaps;
     std::vector<int> pins;
     std::vector<QString> names;
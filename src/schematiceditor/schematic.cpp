@@ -3,10 +3,14 @@
 
 #include "exceptiondata.h"
 #include "function.h"
+#include "library.h"
+#include "svgwriter.h"
 #include "schematic.h"
 #include "text.h"
+#include "threadpool.h"
 #include <algorithm>
 #include <cmath>
+#include <map>
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
@@ -15,17 +19,97 @@
 #include <QJsonDocument>
 #include <QMessageBox>
 #include <QTextStream>
+#include <tuple>
 
-Schematic::Schematic()
+namespace
 {
-    QDir::setCurrent(QCoreApplication::applicationDirPath());
+// Insert, erase or replace symbol at center
+template<typename Type>
+void applyStoreChange(ObjectStore<Type> &objects, qint64 key, const QJsonObject &to)
+{
+    int id = objects.find(key);
 
-    try {
-        readPackageLibrary(packagesDirectory + "/" + packagesFile);
-        readSymbolLibrary(symbolsDirectory + "/" + symbolsFile);
+    if (to.isEmpty()) {
+        if (id >= 0)
+            objects.erase(id);
     }
-    catch (ExceptionData &e) {
-        QMessageBox::warning(nullptr, QString("Error"), e.show());
+    else if (id >= 0)
+        objects.replace(id, Type(to));
+    else
+        objects.add(Type(to));
+}
+
+bool sameWire(const Wire &w, const Wire &w2)
+{
+    return w.x1 == w2.x1 && w.y1 == w2.y1 && w.x2 == w2.x2 && w.y2 == w2.y2 &&
+           w.net == w2.net && w.name == w2.name && w.nameSide == w2.nameSide;
+}
+
+// Wire with net name text above it
+Border wireBounds(const Wire &w, int fontSize)
+{
+    Border b(std::min(w.x1, w.x2), std::min(w.y1, w.y2),
+             std::max(w.x1, w.x2), std::max(w.y1, w.y2));
+
+    if (!w.name.isEmpty()) {
+        int width = 3 * fontSize * w.name.size() / 2;
+        if (!w.nameSide)
+            b.rightX = std::max(b.rightX, b.leftX + width);
+        else
+            b.leftX = std::min(b.leftX, b.rightX - width);
+        b.topY = std::min(b.topY, w.y1 - fontSize);
+    }
+
+    return b;
+}
+
+template<typename Type>
+QJsonObject storeJson(const ObjectStore<Type> &objects, qint64 key)
+{
+    int id = objects.find(key);
+    if (id < 0)
+        return QJsonObject();
+    return objects[id].toJson();
+}
+}
+
+void SheetInstance::draw(QPainter &painter, int fontSize) const
+{
+    int height = 2 * fontSize * (ports.size() + 1);
+    int width = 0;
+    for (const auto &p : ports)
+        width = std::max(width, int(p.first.size()));
+    width = std::max(10 * fontSize, fontSize * (width + 2));
+
+    painter.drawRect(x, y, width, height);
+    painter.drawText(x, y - 2 * fontSize, width, 2 * fontSize,
+                     Qt::AlignLeft | Qt::AlignVCenter, name + "  " + filename);
+
+    int portY = y + 2 * fontSize;
+    for (const auto &p : ports) {
+        painter.drawText(x + fontSize / 2, portY - fontSize, width - fontSize, 2 * fontSize,
+                         Qt::AlignLeft | Qt::AlignVCenter, p.first);
+        portY += 2 * fontSize;
+    }
+}
+
+Schematic::Schematic(bool hasLibraries):
+    jsonCache({"arrays", "circuitSymbols", "devices", "elements", "junctions", "wires"}),
+    index(WIRE_OBJECT + 1),
+    wireItemKey(0)
+{
+    jsonCache.attach(journal);
+    index.attach(journal);
+
+    if (hasLibraries) {
+        QDir::setCurrent(QCoreApplication::applicationDirPath());
+        try {
+            readPackageLibrary(packagesDirectory + "/" + packagesFile);
+            readSymbolLibrary(symbolsDirectory + "/" + symbolsFile);
+        }
+        catch (ExceptionData &e) {
+            QMessageBox::warning(nullptr, QString("Error"), e.show());
+        }
     }
 
     selectedArray = false;
@@ -39,19 +123,25 @@ Schematic::Schematic()
 void Schematic::addArray(int type, int number, int x, int y, int orientation)
 {
     Array array(type, number, x, y, orientation);
-    arrays[array.center] = array;
+    QJsonObject before = objectJson(ARRAY_OBJECT, array.center);
+    arrays.add(array);
+    recordObject(ARRAY_OBJECT, array.center, before);
 }
 
 void Schematic::addCircuitSymbol(int circuitSymbolType, int x, int y)
 {
     CircuitSymbol circuitSymbol(circuitSymbolType, x, y);
-    circuitSymbols[circuitSymbol.center] = circuitSymbol;
+    QJsonObject before = objectJson(CIRCUIT_SYMBOL_OBJECT, circuitSymbol.center);
+    circuitSymbols.add(circuitSymbol);
+    recordObject(CIRCUIT_SYMBOL_OBJECT, circuitSymbol.center, before);
 }
 
 void Schematic::addDevice(int symbolNameID, int x, int y)
 {
     Device device(symbolNameID, x, y);
-    devices[device.center] = device;
+    QJsonObject before = objectJson(DEVICE_OBJECT, device.center);
+    devices.add(device);
+    recordObject(DEVICE_OBJECT, device.center, before);
 }
 
 void Schematic::addElement(int elementType, int x, int y, int orientation)
@@ -61,20 +151,27 @@ void Schematic::addElement(int elementType, int x, int y, int orientation)
 
     Element element(elementType, x, y, orientation);
     element.defaultPadsMap();
-    elements[element.center] = element;
+    QJsonObject before = objectJson(ELEMENT_OBJECT, element.center);
+    elements.add(element);
+    recordObject(ELEMENT_OBJECT, element.center, before);
 }
 
 void Schematic::addJunction(int x, int y)
 {
-    int point = (x << 16) + y;
-    junctions.insert(point);
+    qint64 point = Point::key(x, y);
+    if (junctions.insert(point).second)
+        recordObject(JUNCTION_OBJECT, point, QJsonObject());
 }
 
 void Schematic::addNet()
 {    
     reduceWires(net);
-    for (auto n : net)
+    journal.begin("Add net");
+    for (const auto &n : net) {
         wires.push_back(n);
+        journal.record(WIRE_OBJECT, wires.size() - 1, QJsonObject(), n.toJson());
+    }
+    journal.end();
     net.clear();
     pointNumber = 0;
 }
@@ -83,24 +180,35 @@ void Schematic::addNet()
 // name side is nearest to point: x, y
 void Schematic::addNetName(int x, int y)
 {
+    static int wireNumber;
     static WireIt wireIt;
 
-    if (!selectedWire)
-        for (auto i = wires.begin(); i != wires.end(); ++i)
+    if (!selectedWire) {
+        wireNumber = 0;
+        // Junction of insideConnected is undone with net name
+        journal.begin("Add net name");
+        for (auto i = wires.begin(); i != wires.end(); ++i, wireNumber++)
             if (y == (*i).y1 && (*i).y1 == (*i).y2 &&
                 (insideConnected(x, y, *i) || (x == (*i).x1 || x == (*i).x2))) {
+                QJsonObject before = (*i).toJson();
                 deleteJunction(x, y);
                 (*i).nameSide = 0;
                 if (((*i).x2 > (*i).x1 && abs(x - (*i).x2) < abs(x - (*i).x1)) ||
                     ((*i).x1 > (*i).x2 && abs(x - (*i).x1) < abs(x - (*i).x2)))
                     (*i).nameSide = 1;
+                journal.record(WIRE_OBJECT, wireNumber, before, (*i).toJson());
+                journal.end();
                 wireIt = i;
                 value.clear();
                 selectedWire = true;
                 return;
             }
+        journal.end();
+    }
     if (selectedWire) {
+        QJsonObject before = (*wireIt).toJson();
         (*wireIt).name = value;
+        journal.record(WIRE_OBJECT, wireNumber, before, (*wireIt).toJson());
         selectedWire = false;
     }
 }
@@ -119,6 +227,44 @@ void Schematic::addPoint(int x, int y)
     pointNumber++;
 }
 
+// Change is applied to symbols, junctions or wires
+void Schematic::applyChange(const JournalChange &change, bool undo)
+{
+    const QJsonObject &from = undo ? change.after : change.before;
+    const QJsonObject &to = undo ? change.before : change.after;
+
+    switch (change.object) {
+    case ARRAY_OBJECT:
+        applyStoreChange(arrays, change.key, to);
+        break;
+    case CIRCUIT_SYMBOL_OBJECT:
+        applyStoreChange(circuitSymbols, change.key, to);
+        break;
+    case DEVICE_OBJECT:
+        applyStoreChange(devices, change.key, to);
+        break;
+    case ELEMENT_OBJECT:
+        applyStoreChange(elements, change.key, to);
+        break;
+    case JUNCTION_OBJECT:
+        if (to.isEmpty())
+            junctions.erase(change.key);
+        else
+            junctions.insert(change.key);
+        break;
+    case WIRE_OBJECT:
+        {
+            auto i = listPosition(wires, change.key);
+            if (from.isEmpty())
+                wires.insert(i, Wire(to));
+            else if (to.isEmpty())
+                wires.erase(i);
+            else
+                *i = Wire(to);
+        }
+    }
+}
+
 void Schematic::clear()
 {
     arrays.clear();
@@ -126,8 +272,12 @@ void Schematic::clear()
     elements.clear();
     circuitSymbols.clear();
     pins.clear();
+    pinNets.clear();
     wires.clear();
     junctions.clear();
+    ports.clear();
+    sheets.clear();
+    journal.clear();
 }
 
 bool Schematic::connected(const Pin &pin, const Wire &wire)
@@ -145,7 +295,6 @@ bool Schematic::connected(const Pin &pin, const Wire &wire)
 bool Schematic::connected(const Wire &wire1, const Wire &wire2)
 {
     int x, y;
-    int point;
 
     // Wire ends connected
     if ((wire1.x1 == wire2.x1 && wire1.y1 == wire2.y1) ||
@@ -172,8 +321,7 @@ bool Schematic::connected(const Wire &wire1, const Wire &wire2)
         (wire2.y1 > wire1.y2 && wire2.y1 < wire1.y1))) {
         x = wire1.x1;
         y = wire2.y1;
-        point = (x << 16) + y;
-        if (junctions.count(point))
+        if (junctions.count(Point::key(x, y)))
             return true;
     }
     if (wire1.y1 == wire1.y2 && wire2.x1 == wire2.x2 &&
@@ -183,8 +331,7 @@ bool Schematic::connected(const Wire &wire1, const Wire &wire2)
         (wire2.x1 > wire1.x2 && wire2.x1 < wire1.x1))) {
         x = wire2.x1;
         y = wire1.y1;
-        point = (x << 16) + y;
-        if (junctions.count(point))
+        if (junctions.count(Point::key(x, y)))
             return true;
     }
 
@@ -193,94 +340,142 @@ bool Schematic::connected(const Wire &wire1, const Wire &wire2)
 
 void Schematic::deleteElement(int x, int y)
 {
-    for (auto &a : arrays)
-        if (a.second.exist(x, y)) {
-            arrays.erase(a.first);
-            return;
-        }
+    qint64 center;
+    int id;
+
+    if ((id = findSymbol(ARRAY_OBJECT, x, y)) >= 0) {
+        center = arrays[id].center;
+        QJsonObject before = arrays[id].toJson();
+        arrays.erase(id);
+        recordObject(ARRAY_OBJECT, center, before);
+        return;
+    }
 
-    for (auto &c : circuitSymbols)
-        if (c.second.exist(x, y)) {
-            circuitSymbols.erase(c.first);
-            return;
-        }
+    if ((id = findSymbol(CIRCUIT_SYMBOL_OBJECT, x, y)) >= 0) {
+        center = circuitSymbols[id].center;
+        QJsonObject before = circuitSymbols[id].toJson();
+        circuitSymbols.erase(id);
+        recordObject(CIRCUIT_SYMBOL_OBJECT, center, before);
+        return;
+    }
 
-    for (auto &d : devices)
-        if (d.second.exist(x, y)) {
-            devices.erase(d.first);
-            return;
-        }
+    if ((id = findSymbol(DEVICE_OBJECT, x, y)) >= 0) {
+        center = devices[id].center;
+        QJsonObject before = devices[id].toJson();
+        devices.erase(id);
+        recordObject(DEVICE_OBJECT, center, before);
+        return;
+    }
 
-    for (auto &e : elements)
-        if (e.second.exist(x, y)) {
-            elements.erase(e.first);
-            return;
-        }
+    if ((id = findSymbol(ELEMENT_OBJECT, x, y)) >= 0) {
+        center = elements[id].center;
+        QJsonObject before = elements[id].toJson();
+        elements.erase(id);
+        recordObject(ELEMENT_OBJECT, center, before);
+    }
 }
 
 void Schematic::deleteJunction(int x, int y)
 {
-    int point = (x << 16) + y;
-    junctions.erase(point);
+    qint64 point = Point::key(x, y);
+    QJsonObject before = objectJson(JUNCTION_OBJECT, point);
+    if (junctions.erase(point))
+        recordObject(JUNCTION_OBJECT, point, before);
 }
 
 void Schematic::deleteNet(int x, int y)
 {
     int netNumber = -1;
+    int number = 0;
 
-    for (auto i = wires.begin(); i != wires.end(); ++i)
+    journal.begin("Delete net");
+    for (auto i = wires.begin(); i != wires.end(); ++i, number++)
         if (insideConnected(x, y, *i) ||
             (x == (*i).x1 && y == (*i).y1) ||
             (x == (*i).x2 && y == (*i).y2)) {
             netNumber = (*i).net;
+            QJsonObject before = (*i).toJson();
             wires.erase(i);
+            journal.record(WIRE_OBJECT, number, before, QJsonObject());
             deleteJunction(x, y);
             break;
         }
 
+    number = 0;
     if (netNumber != -1)
-        for (auto i = wires.end(); i != wires.begin();) {
-            --i;
-            if ((*i).net == netNumber)
-                wires.erase(i);
+        for (auto i = wires.begin(); i != wires.end();) {
+            if ((*i).net == netNumber) {
+                QJsonObject before = (*i).toJson();
+                i = wires.erase(i);
+                journal.record(WIRE_OBJECT, number, before, QJsonObject());
+            }
+            else {
+                ++i;
+                number++;
+            }
         }
+    journal.end();
 }
 
 void Schematic::deleteWire(int x, int y)
 {
-    for (auto i = wires.begin(); i != wires.end(); ++i)
+    int number = 0;
+
+    // Junction of insideConnected is undone with wire
+    journal.begin("Delete wire");
+    for (auto i = wires.begin(); i != wires.end(); ++i, number++)
         if (insideConnected(x, y, *i) ||
             (x == (*i).x1 && y == (*i).y1) ||
             (x == (*i).x2 && y == (*i).y2)) {
+            QJsonObject before = (*i).toJson();
             wires.erase(i);
+            journal.record(WIRE_OBJECT, number, before, QJsonObject());
             deleteJunction(x, y);
-            return;
+            break;
         }
+    journal.end();
 }
 
 void Schematic::draw(QPainter &painter)
 {
     constexpr int fontSize = 10;
+    constexpr int margin = 4 * fontSize;    // text beside symbol bounds
+    QRect window = painter.worldTransform().inverted().mapRect(painter.window());
+    Border area(window.left() - margin, window.top() - margin,
+                window.right() + margin, window.bottom() + margin);
+    std::vector<qint64> keys;
+
+    updateIndex();
+
     painter.setPen(QColor(200, 100, 100));
     QFont serifFont("Times", fontSize, QFont::Normal);
     painter.setFont(serifFont);
 
     // Draw arrays
-    for (auto a : arrays)
-        a.second.draw(painter);
+    index.find(ARRAY_OBJECT, area, keys);
+    for (qint64 center : keys)
+        arrays[arrays.find(center)].draw(painter);
 
     // Draw circuit symbols
     painter.setPen(QColor(200, 100, 100));
-    for (auto c : circuitSymbols)
-        c.second.draw(painter);
+    index.find(CIRCUIT_SYMBOL_OBJECT, area, keys);
+    for (qint64 center : keys)
+        circuitSymbols[circuitSymbols.find(center)].draw(painter);
 
     // Draw devices
-    for (auto d : devices)
-        d.second.draw(painter, fontSize);
+    index.find(DEVICE_OBJECT, area, keys);
+    for (qint64 center : keys)
+        devices[devices.find(center)].draw(painter, fontSize);
 
     // Draw elements
-    for (auto e : elements)
-        e.second.draw(painter);
+    index.find(ELEMENT_OBJECT, area, keys);
+    for (qint64 center : keys)
+        elements[elements.find(center)].draw(painter);
+
+    // Draw sheet instances
+    painter.setPen(QColor(100, 100, 200));
+    for (const auto &s : sheets)
+        s.draw(painter, fontSize);
 
     // Draw group
     if (groupBorder.isValid()) {
@@ -290,7 +485,9 @@ void Schematic::draw(QPainter &painter)
 
     // Draw wires
     painter.setPen(QColor(0, 200, 0));
-    for (auto w : wires) {
+    index.find(WIRE_OBJECT, area, keys);
+    for (qint64 key : keys) {
+        const Wire &w = wireItems.at(key);
         painter.drawLine(w.x1, w.y1, w.x2, w.y2);
         if (!w.name.isEmpty()) {
             int width = 3 * fontSize * w.name.size() / 2;
@@ -307,14 +504,15 @@ void Schematic::draw(QPainter &painter)
             }
         }
     }
-    for (auto n : net)
+    for (const auto &n : net)
         painter.drawLine(n.x1, n.y1, n.x2, n.y2);
 
     // Draw junctions
     int k, x, y;
-    for (auto j : junctions) {
-        x = (j >> 16) & 0xffff;
-        y = j & 0xffff;
+    index.find(JUNCTION_OBJECT, area, keys);
+    for (qint64 point : keys) {
+        x = Point::keyX(point);
+        y = Point::keyY(point);
         for (int i = 0; i < 5; i++) {
             k = 1;
             if (i > 0 && i < 4)
@@ -327,8 +525,10 @@ void Schematic::draw(QPainter &painter)
     if (showNetNumbers) {
         QString str;
         painter.setPen(QColor(0, 200, 0));
-        for (auto p : pins)
-            painter.drawText(p.x+2, p.y, str.setNum(p.net));
+        for (const auto &p : pins)
+            if (p.x >= area.leftX && p.x <= area.rightX &&
+                p.y >= area.topY && p.y <= area.bottomY)
+                painter.drawText(p.x+2, p.y, str.setNum(p.net));
     }
 }
 
@@ -340,58 +540,307 @@ void Schematic::enumerate()
     int number;
     QString str, str2;
 
-    for (auto &a : arrays) {
-        number = ++arrayCounter[a.second.referenceType];
-        a.second.reference = arrayReference[a.second.type] + str.setNum(number);
+    journal.begin("Enumerate");
+    for (int id : arrays.centerOrder()) {
+        Array &a = arrays[id];
+        QJsonObject before = a.toJson();
+        number = ++arrayCounter[a.referenceType];
+        a.reference = arrayReference[a.type] + str.setNum(number);
+        recordObject(ARRAY_OBJECT, a.center, before);
     }
 
-    for (auto &d : devices) {
-        number = ++deviceCounter[d.second.referenceType];
-        d.second.reference = deviceReference[d.second.type] + str.setNum(number);
-        if (d.second.units.size() == 1)
-            d.second.units[0].reference = d.second.reference;
-        if (d.second.units.size() > 1)
-            for (uint i = 0; i < d.second.units.size(); i++)
-                d.second.units[i].reference = d.second.reference + "." + str2.setNum(i+1);
+    for (int id : devices.centerOrder()) {
+        Device &d = devices[id];
+        QJsonObject before = d.toJson();
+        number = ++deviceCounter[d.referenceType];
+        d.reference = deviceReference[d.type] + str.setNum(number);
+        if (d.units.size() == 1)
+            d.units[0].reference = d.reference;
+        if (d.units.size() > 1)
+            for (uint i = 0; i < d.units.size(); i++)
+                d.units[i].reference = d.reference + "." + str2.setNum(i+1);
+        recordObject(DEVICE_OBJECT, d.center, before);
     }
 
-    for (auto &e : elements) {
-        number = ++elementCounter[e.second.referenceType];
-        e.second.reference = elementReference[e.second.type] + str.setNum(number);
+    for (int id : elements.centerOrder()) {
+        Element &e = elements[id];
+        QJsonObject before = e.toJson();
+        number = ++elementCounter[e.referenceType];
+        e.reference = elementReference[e.type] + str.setNum(number);
+        recordObject(ELEMENT_OBJECT, e.center, before);
     }
+    journal.end();
+}
+
+void Schematic::findNets(std::list<Wire> &netWires)
+{
+    int groundNet;
+    int groundIecNet;
+
+    groundNets(groundNet, groundIecNet);
+    int maxGroundNet = (groundIecNet == 1) ? 1 : 0;
+
+    pins.clear();
+
+    // Get all pins of arrays, symbols are in center order
+    for (int id : arrays.centerOrder()) {
+        const Array &a = arrays[id];
+        for (uint i = 0; i < a.pins.size(); ++i)
+            pins.push_back(Pin(a.reference, i + 1,
+                a.pins[i].x, a.pins[i].y, -1));
+    }
+
+    // Get all pins of devices
+    for (int id : devices.centerOrder()) {
+        const Device &d = devices[id];
+        for (uint i = 0; i < d.pins.size(); ++i)
+            pins.push_back(Pin(d.reference, i + 1,
+                d.pins[i].x, d.pins[i].y, -1));
+    }
+
+    // Get all pins of elements
+    for (int id : elements.centerOrder()) {
+        const Element &e = elements[id];
+        for (uint j = 0; j < e.pins.size(); ++j)
+            pins.push_back(Pin(e.reference, j + 1,
+                e.pins[j].x, e.pins[j].y, -1));
+    }
+
+    // Get all pins of ground
+    for (int id : circuitSymbols.centerOrder()) {
+        const CircuitSymbol &c = circuitSymbols[id];
+        int n = -1;
+        if (c.type == GROUND)
+            n = groundNet;
+        if (c.type == GROUND_IEC)
+            n = groundIecNet;
+        if (n == -1)
+            continue;
+        pins.push_back(Pin(circuitSymbolTypeString[c.type], 1,
+                           c.refX, c.refY, n));
+    }
+
+    for (auto &w : netWires)
+        w.net = -1;
+
+    // Add junctions
+    for (auto i = pins.begin(); i != pins.end(); ++i) {
+        int connect = 0;
+        for (auto j = i; j != pins.end();) {
+            ++j;
+            if ((*i).x == (*j).x && (*i).y == (*j).y)
+                connect++;
+        }
+        for (const auto &w : netWires) {
+            if (((*i).x == w.x1 && (*i).y == w.y1) ||
+                ((*i).x == w.x2 && (*i).y == w.y2))
+                connect++;
+        }
+        if (connect > 1)
+            addJunction((*i).x, (*i).y);
+    }
+
+    // Current state:
+    // ground pins: net = 0 and may be 1, other pins: net = -1
+    // netWires: net = -1
+
+    bool finished = false;
+    int netNumber = 0;
+    int tmpNumber = -2;
+    int unconnectedNumber = -3;
+
+    while (!finished) {
+        int connect = 1;
+        auto tmp = pins.begin();
+        for (auto i = pins.begin(); i != pins.end(); ++i) {
+            if (netNumber <= maxGroundNet)
+                if ((*i).net != netNumber)
+                    continue;
+            if (netNumber > maxGroundNet) {
+                if ((*i).net != -1)
+                    continue;
+                (*i).net = netNumber;
+                tmp = i;
+                connect = 0;
+            }
+
+            // Set tmpNumber for pin to pin connection
+            for (auto j = pins.begin(); j != pins.end(); ++j) {
+                if (i == j || (*j).net != -1)
+                    continue;
+                if ((*i).x == (*j).x && (*i).y == (*j).y) {
+                    (*j).net = tmpNumber;
+                    connect = 1;
+                }
+            }
+
+            // Set netNumber for pin to wire connection
+            for (auto &w : netWires)
+                if (connected(*i, w) && w.net == -1)
+                    w.net = netNumber;
+
+            if (netNumber > maxGroundNet)
+                break;
+        }
+
+        // Change pin net with tmpNumber to netNumber
+        for (auto i = pins.begin(); i != pins.end(); ++i)
+            if ((*i).net == tmpNumber)
+                (*i).net = netNumber;
+
+        // Set net number for wire to wire connection
+        bool wireUpdated = true;
+        while (wireUpdated) {
+            wireUpdated = false;
+            for (auto j = netWires.begin(); j != netWires.end(); ++j) {
+                if ((*j).net != netNumber)
+                    continue;
+                for (auto k = netWires.begin(); k != netWires.end(); ++k) {
+                    if (j == k || (*k).net != -1)
+                        continue;
+                    if (connected(*j, *k) ||
+                        (!(*j).name.isEmpty() && (*j).name == (*k).name)) {
+                        (*k).net = netNumber;
+                        wireUpdated = true;
+                    }
+                }
+            }
+        }
+
+        // Set net number for wire to pin connection
+        for (const auto &w : netWires) {
+            if (w.net != netNumber)
+                continue;
+            for (auto i = pins.begin(); i != pins.end(); ++i)
+                if (connected(*i, w) && (*i).net == -1) {
+                    (*i).net = netNumber;
+                    connect = 1;
+                }
+        }
+
+        if (netNumber <= maxGroundNet || connect)
+            netNumber++;
+
+        if (netNumber > maxGroundNet && !connect)
+            (*tmp).net = unconnectedNumber;
+
+        finished = true;
+        for (auto i = pins.begin(); i != pins.end(); ++i)
+            if ((*i).net == -1) {
+                finished = false;
+                break;
+            }
+    }
+
+    // Set net = -1 for unconnected pins, index nets by pin point,
+    // first pin of point gives net
+    pinNets.clear();
+    for (auto i = pins.begin(); i != pins.end(); ++i) {
+        if ((*i).net == unconnectedNumber)
+            (*i).net = -1;
+        pinNets.emplace(Point::key((*i).x, (*i).y), (*i).net);
+    }
+}
+
+int Schematic::findSymbol(int object, int x, int y)
+{
+    std::vector<qint64> centers;
+    int id;
+
+    updateIndex();
+    index.find(object, Border(x, y, x, y), centers);
+
+    for (qint64 center : centers)
+        switch (object) {
+        case ARRAY_OBJECT:
+            id = arrays.find(center);
+            if (arrays[id].exist(x, y))
+                return id;
+            break;
+        case CIRCUIT_SYMBOL_OBJECT:
+            id = circuitSymbols.find(center);
+            if (circuitSymbols[id].exist(x, y))
+                return id;
+            break;
+        case DEVICE_OBJECT:
+            id = devices.find(center);
+            if (devices[id].exist(x, y))
+                return id;
+            break;
+        case ELEMENT_OBJECT:
+            id = elements.find(center);
+            if (elements[id].exist(x, y))
+                return id;
+        }
+
+    return -1;
+}
+
+void Schematic::groundNets(int &groundNet, int &groundIecNet) const
+{
+    groundNet = -1;
+    groundIecNet = -1;
+
+    for (const auto &c : circuitSymbols) {
+        if (c.type == GROUND)
+            groundNet = 0;
+        if (c.type == GROUND_IEC)
+            groundIecNet = 0;
+    }
+
+    if (!groundNet && !groundIecNet)
+        groundIecNet = 1;
 }
 
 void Schematic::horizontalMirror(int x, int y)
 {
-    int center;
+    int id;
     int orientation;
     int refX;
     int refY;
     int type;
     QString value;
 
-    for (auto e : elements)
-        if (e.second.exist(x, y)) {
-            if (!e.second.mirror)
-                continue;
-            center = e.second.center;
-            orientation = e.second.orientation;
-            if (orientation < UP_MIRROR)
-                orientation += UP_MIRROR;
-            else
-                orientation -= UP_MIRROR;
-            refX = e.second.refX;
-            refY = e.second.refY;
-            type = e.second.type;
-            value = e.second.value;
-            elements.erase(center);
-            Element element(type, refX, refY, orientation, value);
-            elements[element.center] = element;
-            return;
-        }
+    id = findSymbol(ELEMENT_OBJECT, x, y);
+    if (id < 0 || !elements[id].mirror)
+        return;
+
+    const Element &e = elements[id];
+    orientation = e.orientation;
+    if (orientation < UP_MIRROR)
+        orientation += UP_MIRROR;
+    else
+        orientation -= UP_MIRROR;
+    refX = e.refX;
+    refY = e.refY;
+    type = e.type;
+    value = e.value;
+    Element element(type, refX, refY, orientation, value);
+    journal.begin("Mirror");
+    replaceObjects(elements, ELEMENT_OBJECT, {id}, {element});
+    journal.end();
 }
 
-// Junction insert if needed
+// Objects are indexed by centers
+template<typename Type>
+void Schematic::indexObjects(const ObjectStore<Type> &objects, int object)
+{
+    if (index.isDirty(object)) {
+        index.clear(object);
+        for (const auto &o : objects)
+            index.insert(object, o.center, o.bounds());
+    }
+
+    for (const auto &change : index.takeChanges(object)) {
+        int id = objects.find(change.key);
+        if (id >= 0)
+            index.insert(object, change.key, objects[id].bounds());
+        else
+            index.remove(object, change.key);
+    }
+}
+
+// Junction is added and recorded if needed
 bool Schematic::insideConnected(int x, int y, const Wire &wire)
 {
     if ((wire.x1 == wire.x2 && x == wire.x1 &&
@@ -400,15 +849,14 @@ bool Schematic::insideConnected(int x, int y, const Wire &wire)
         (wire.y1 == wire.y2 && y == wire.y1 &&
         ((x > wire.x1 && x < wire.x2) ||
          (x > wire.x2 && x < wire.x1)))) {
-        int point = (x << 16) + y;
-        junctions.insert(point);
+        addJunction(x, y);
         return true;
     }
 
     return 0;
 }
 
-// Junction insert if needed
+// Junction is added and recorded if needed
 bool Schematic::insideConnected(const Pin &pin, const Wire &wire)
 {
     if ((wire.x1 == wire.x2 && pin.x == wire.x1 &&
@@ -417,8 +865,7 @@ bool Schematic::insideConnected(const Pin &pin, const Wire &wire)
         (wire.y1 == wire.y2 && pin.y == wire.y1 &&
         ((pin.x > wire.x1 && pin.x < wire.x2) ||
          (pin.x > wire.x2 && pin.x < wire.x1)))) {
-        int point = (pin.x << 16) + pin.y;
-        junctions.insert(point);
+        addJunction(pin.x, pin.y);
         return true;
     }
 
@@ -459,7 +906,7 @@ bool Schematic::joinWires(Wire &wire1, Wire &wire2)
 
 void Schematic::move(int x, int y)
 {
-    static int center;
+    static int id;
     static int number;
     static int orientation;
     static int padsMap;
@@ -474,100 +921,95 @@ void Schematic::move(int x, int y)
 
     if (!selectedArray && !selectedCircuitSymbol &&
         !selectedDevice && !selectedElement) {
-        for (auto a : arrays)
-            if (a.second.exist(x, y)) {
-                center = a.second.center;
-                type = a.second.type;
-                orientation = a.second.orientation;
-                pinNames = a.second.pinNames;
-                number = a.second.number;
-                selectedArray = true;
-                return;
-            }
-        for (auto c : circuitSymbols)
-            if (c.second.exist(x, y)) {
-                center = c.second.center;
-                type = c.second.type;
-                selectedCircuitSymbol = true;
-                return;
-            }
-        for (auto d : devices) {
-            unitNumber = d.second.exist(x, y);
-            if (unitNumber > 0) {
-                unitNumber--;
-                center = d.second.center;
-                symbolNameID = d.second.symbolNameID;
-                name = d.second.name;
-                selectedDevice = true;
-                return;
-            }
+        if ((id = findSymbol(ARRAY_OBJECT, x, y)) >= 0) {
+            const Array &a = arrays[id];
+            type = a.type;
+            orientation = a.orientation;
+            pinNames = a.pinNames;
+            number = a.number;
+            selectedArray = true;
+            return;
+        }
+        if ((id = findSymbol(CIRCUIT_SYMBOL_OBJECT, x, y)) >= 0) {
+            type = circuitSymbols[id].type;
+            selectedCircuitSymbol = true;
+            return;
+        }
+        if ((id = findSymbol(DEVICE_OBJECT, x, y)) >= 0) {
+            const Device &d = devices[id];
+            unitNumber = d.exist(x, y) - 1;
+            symbolNameID = d.symbolNameID;
+            name = d.name;
+            selectedDevice = true;
+            return;
+        }
+        if ((id = findSymbol(ELEMENT_OBJECT, x, y)) >= 0) {
+            const Element &e = elements[id];
+            orientation = e.orientation;
+            packageName = e.packageName;
+            padsMap = e.padsMap;
+            type = e.type;
+            value = e.value;
+            selectedElement = true;
+            return;
         }
-        for (auto e : elements)
-            if (e.second.exist(x, y)) {
-                center = e.second.center;
-                orientation = e.second.orientation;
-                packageName = e.second.packageName;
-                padsMap = e.second.padsMap;
-                type = e.second.type;
-                value = e.second.value;
-                selectedElement = true;
-                return;
-            }
     }
 
+    journal.begin("Move");
+
     if (selectedArray) {
-        arrays.erase(center);
         Array array(type, number, x, y, orientation);
         array.pinNames = pinNames;
-        arrays[array.center] = array;
+        replaceObjects(arrays, ARRAY_OBJECT, {id}, {array});
         selectedArray = false;
+        journal.end();
         return;
     }
 
     if (selectedCircuitSymbol) {
-        circuitSymbols.erase(center);
         CircuitSymbol circuitSymbol(type, x, y);
-        circuitSymbols[circuitSymbol.center] = circuitSymbol;
+        replaceObjects(circuitSymbols, CIRCUIT_SYMBOL_OBJECT, {id}, {circuitSymbol});
         selectedCircuitSymbol = false;
     }
 
     if (selectedDevice) {
+        Device device = devices[id];
         if (!unitNumber) {
-            Device device(name, symbolNameID, x, y);
-            device.units.resize(1);
-            for (uint i = 1; i < devices[center].units.size(); i++)
-                device.units.push_back(devices[center].units[i]);
-            devices.erase(center);
-            center = device.center;
-            devices[center] = device;
+            Device device2(name, symbolNameID, x, y);
+            device2.units.resize(1);
+            for (uint i = 1; i < device.units.size(); i++)
+                device2.units.push_back(device.units[i]);
+            device = device2;
         }
         else {
             Unit unit(symbolNameID, unitNumber, x, y);
-            unit.reference = Device::symbols[symbolNameID].reference +
+            unit.reference = Device::symbol(symbolNameID).reference +
                              "." + str.setNum(unitNumber+1);
-            devices[center].units[unitNumber] = unit;
+            device.units[unitNumber] = unit;
         }
         int n;
-        for (uint i = 0; i < devices[center].pins.size(); i++) {
-            n = devices[center].pins[i].unit - 1;
-            devices[center].pins[i].x = devices[center].units[n].refX +
-                                        Device::symbols[symbolNameID].pins[i].x;
-            devices[center].pins[i].y = devices[center].units[n].refY +
-                                        Device::symbols[symbolNameID].pins[i].y;
+        for (uint i = 0; i < device.pins.size(); i++) {
+            n = device.pins[i].unit - 1;
+            device.pins[i].x = device.units[n].refX +
+                               Device::symbol(symbolNameID).pins[i].x;
+            device.pins[i].y = device.units[n].refY +
+                               Device::symbol(symbolNameID).pins[i].y;
         }
+        replaceObjects(devices, DEVICE_OBJECT, {id}, {device});
         selectedDevice = false;
+        journal.end();
         return;
     }
 
     if (selectedElement) {
-        elements.erase(center);
         Element element(type, x, y, orientation, value);
         element.packageName = packageName;
         element.padsMap = padsMap;
-        elements[element.center] = element;
+        replaceObjects(elements, ELEMENT_OBJECT, {id}, {element});
         selectedElement = false;
-        return;
     }
+
+    journal.end();
 }
 
 void Schematic::moveGroup()
@@ -585,65 +1027,58 @@ void Schematic::moveGroup()
     QString packageName;
     QString str;
     QString value;
-    std::map<int, Array> arrays2;
-    std::map<int, CircuitSymbol> circuitSymbols2;
-    std::map<int, Device> devices2;
-    std::map<int, Element> elements2;
-    std::vector<int> centers;
-    std::vector<int> junctions2;
+    std::vector<Array> arrays2;
+    std::vector<CircuitSymbol> circuitSymbols2;
+    std::vector<Device> devices2;
+    std::vector<Element> elements2;
+    std::vector<int> ids;
+    std::vector<qint64> junctions2;
     std::vector<int> unitNumbers;
     std::vector<QString> pinNames;
     std::vector<Wire> wires2;
 
+    journal.begin("Move group");
+
     // Move arrays
-    for (auto a : arrays)
-        if (a.second.inside(points[0].x, points[0].y,
-                            points[1].x, points[1].y)) {
-            centers.push_back(a.second.center);
-            type = a.second.type;
-            x = a.second.refX + dx;
-            y = a.second.refY + dy;
-            orientation = a.second.orientation;
-            pinNames = a.second.pinNames;
-            number = a.second.number;
+    for (const auto &a : arrays)
+        if (a.inside(points[0].x, points[0].y,
+                     points[1].x, points[1].y)) {
+            ids.push_back(arrays.find(a.center));
+            type = a.type;
+            x = a.refX + dx;
+            y = a.refY + dy;
+            orientation = a.orientation;
+            pinNames = a.pinNames;
+            number = a.number;
             Array array(type, number, x, y, orientation);
             array.pinNames = pinNames;
-            arrays2[array.center] = array;
+            arrays2.push_back(array);
         }
-    for (uint i = 0; i < centers.size(); i++)
-        arrays.erase(centers[i]);
-    centers.clear();
-    for (auto c : arrays2)
-        arrays[c.second.center] = c.second;
-    arrays2.clear();
+    replaceObjects(arrays, ARRAY_OBJECT, ids, arrays2);
+    ids.clear();
 
     // Move circuit symbols
-    for (auto c : circuitSymbols)
-        if (c.second.inside(points[0].x, points[0].y,
-                            points[1].x, points[1].y)) {
-            centers.push_back(c.second.center);
-            type = c.second.type;
-            x = c.second.refX + dx;
-            y = c.second.refY + dy;
-            CircuitSymbol circuitSymbol(type, x, y);
-            circuitSymbols2[circuitSymbol.center] = circuitSymbol;
+    for (const auto &c : circuitSymbols)
+        if (c.inside(points[0].x, points[0].y,
+                     points[1].x, points[1].y)) {
+            ids.push_back(circuitSymbols.find(c.center));
+            type = c.type;
+            x = c.refX + dx;
+            y = c.refY + dy;
+            circuitSymbols2.push_back(CircuitSymbol(type, x, y));
         }
-    for (uint i = 0; i < centers.size(); i++)
-        circuitSymbols.erase(centers[i]);
-    centers.clear();
-    for (auto c : circuitSymbols2)
-        circuitSymbols[c.second.center] = c.second;
-    circuitSymbols2.clear();
+    replaceObjects(circuitSymbols, CIRCUIT_SYMBOL_OBJECT, ids, circuitSymbols2);
+    ids.clear();
 
     // Move device units
-    for (auto d : devices)
-        if (d.second.inside(points[0].x, points[0].y,
-                            points[1].x, points[1].y, unitNumbers)) {
-            centers.push_back(d.second.center);
-            symbolNameID = d.second.symbolNameID;
-            name = d.second.name;
-            x = d.second.refX;
-            y = d.second.refY;
+    for (const auto &d : devices)
+        if (d.inside(points[0].x, points[0].y,
+                     points[1].x, points[1].y, unitNumbers)) {
+            ids.push_back(devices.find(d.center));
+            symbolNameID = d.symbolNameID;
+            name = d.name;
+            x = d.refX;
+            y = d.refY;
             if (!unitNumbers[0]) {
                 x += dx;
                 y += dy;
@@ -653,14 +1088,14 @@ void Schematic::moveGroup()
                 unitNumber = unitNumbers[j];
                 if (!unitNumber) {
                     device.units.resize(1);
-                    for (uint k = 1; k < d.second.units.size(); k++)
-                        device.units.push_back(d.second.units[k]);
+                    for (uint k = 1; k < d.units.size(); k++)
+                        device.units.push_back(d.units[k]);
                 }
                 if (unitNumber) {
-                    x = d.second.units[unitNumber].refX + dx;
-                    y = d.second.units[unitNumber].refY + dy;
+                    x = d.units[unitNumber].refX + dx;
+                    y = d.units[unitNumber].refY + dy;
                     Unit unit(symbolNameID, unitNumber, x, y);
-                    unit.reference = Device::symbols[symbolNameID].reference +
+                    unit.reference = Device::symbol(symbolNameID).reference +
                                      "." + str.setNum(unitNumber+1);
                     device.units[unitNumber] = unit;
                 }
@@ -669,65 +1104,61 @@ void Schematic::moveGroup()
             for (uint i = 0; i < device.pins.size(); i++) {
                 n = device.pins[i].unit - 1;
                 device.pins[i].x = device.units[n].refX +
-                                   Device::symbols[symbolNameID].pins[i].x;
+                                   Device::symbol(symbolNameID).pins[i].x;
                 device.pins[i].y = device.units[n].refY +
-                                   Device::symbols[symbolNameID].pins[i].y;
+                                   Device::symbol(symbolNameID).pins[i].y;
             }
-            devices2[device.center] = device;
+            devices2.push_back(device);
         }
-    for (uint i = 0; i < centers.size(); i++)
-        devices.erase(centers[i]);
-    centers.clear();
-    for (auto d : devices2)
-        devices[d.second.center] = d.second;
-    devices2.clear();
+    replaceObjects(devices, DEVICE_OBJECT, ids, devices2);
+    ids.clear();
 
     // Move elements
-    for (auto e : elements)
-        if (e.second.inside(points[0].x, points[0].y,
-                            points[1].x, points[1].y)) {
-            centers.push_back(e.second.center);
-            orientation = e.second.orientation;
-            packageName = e.second.packageName;
-            padsMap = e.second.padsMap;
-            type = e.second.type;
-            value = e.second.value;
-            x = e.second.refX + dx;
-            y = e.second.refY + dy;
+    for (const auto &e : elements)
+        if (e.inside(points[0].x, points[0].y,
+                     points[1].x, points[1].y)) {
+            ids.push_back(elements.find(e.center));
+            orientation = e.orientation;
+            packageName = e.packageName;
+            padsMap = e.padsMap;
+            type = e.type;
+            value = e.value;
+            x = e.refX + dx;
+            y = e.refY + dy;
             Element element(type, x, y, orientation, value);
             element.packageName = packageName;
             element.padsMap = padsMap;
-            elements2[element.center] = element;
+            elements2.push_back(element);
         }
-    for (uint i = 0; i < centers.size(); i++)
-        elements.erase(centers[i]);
-    centers.clear();
-    for (auto e : elements2)
-        elements[e.second.center] = e.second;
-    elements2.clear();
+    replaceObjects(elements, ELEMENT_OBJECT, ids, elements2);
 
     // Move junctions
     for (auto i = junctions.begin(); i != junctions.end();) {
-        x = *i >> 16;
-        y = *i & 0xffff;
+        x = Point::keyX(*i);
+        y = Point::keyY(*i);
         if (x >= points[0].x && x <= points[1].x &&
             y >= points[0].y && y <= points[1].y) {
-            int point = ((x + dx) << 16) + y + dy;
-            junctions2.push_back(point);
+            junctions2.push_back(Point::key(x + dx, y + dy));
+            QJsonObject before = objectJson(JUNCTION_OBJECT, *i);
+            qint64 point = *i;
             i = junctions.erase(i);
+            recordObject(JUNCTION_OBJECT, point, before);
         }
         else
             ++i;
     }
     for (auto j : junctions2)
-        junctions.insert(j);
+        if (junctions.insert(j).second)
+            recordObject(JUNCTION_OBJECT, j, QJsonObject());
 
-    // Move wires
+    // Move wires, moved wires are erased and appended
+    number = 0;
     for (auto i = wires.begin(); i != wires.end();) {
         if ((*i).x1 >= points[0].x && (*i).x1 <= points[1].x &&
             (*i).y1 >= points[0].y && (*i).y1 <= points[1].y &&
             (*i).x2 >= points[0].x && (*i).x2 <= points[1].x &&
             (*i).y2 >= points[0].y && (*i).y2 <= points[1].y) {
+            journal.record(WIRE_OBJECT, number, (*i).toJson(), QJsonObject());
             (*i).x1 += dx;
             (*i).y1 += dy;
             (*i).x2 += dx;
@@ -735,11 +1166,17 @@ void Schematic::moveGroup()
             wires2.push_back(*i);
             i = wires.erase(i);
         }
-        else
+        else {
             ++i;
+            number++;
+        }
     }
-    for (auto w : wires2)
+    for (const auto &w : wires2) {
         wires.push_back(w);
+        journal.record(WIRE_OBJECT, wires.size() - 1, QJsonObject(), w.toJson());
+    }
+
+    journal.end();
 }
 
 void Schematic::moveGroup(int x, int y)
@@ -784,6 +1221,30 @@ void Schematic::moveUp()
     //centerY -= 0.1 * windowSizeY / scale;  // equal step for x and y
 }
 
+QJsonObject Schematic::objectJson(int object, qint64 key)
+{
+    switch (object) {
+    case ARRAY_OBJECT:
+        return storeJson(arrays, key);
+    case CIRCUIT_SYMBOL_OBJECT:
+        return storeJson(circuitSymbols, key);
+    case DEVICE_OBJECT:
+        return storeJson(devices, key);
+    case ELEMENT_OBJECT:
+        return storeJson(elements, key);
+    case JUNCTION_OBJECT:
+        if (!junctions.count(key))
+            return QJsonObject();
+        return QJsonObject{{"x", Point::keyX(key)}, {"y", Point::keyY(key)}};
+    case WIRE_OBJECT:
+        if (key < 0 || key >= int(wires.size()))
+            return QJsonObject();
+        return std::next(wires.begin(), key)->toJson();
+    }
+
+    return QJsonObject();
+}
+
 void Schematic::readFile(const QString &filename, QString &text)
 {
     QFile file(filename);
@@ -794,75 +1255,103 @@ void Schematic::readFile(const QString &filename, QString &text)
     file.close();
 }
 
-void Schematic::readJsonFile(const QString &filename, QByteArray &byteArray)
+void Schematic::readPackageLibrary(const QString &libraryname)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly))
-        throw ExceptionData(filename + " open error");
-    byteArray = file.readAll();
-    file.close();
+    Library::packages().read(libraryname, packagesDirectory);
 }
 
-void Schematic::readPackageLibrary(const QString &libraryname)
+// Symbol files are scanned in parallel, symbols are added in library order.
+// Device and element symbols are parsed when they are used.
+void Schematic::readSymbolLibrary(const QString &libraryname)
 {
-    QByteArray byteArray;
-    readJsonFile(libraryname, byteArray);
-
-    QJsonDocument document(QJsonDocument::fromJson(byteArray));
-    if (document.isNull())
-        throw ExceptionData("Package library file read error");
-
-    QJsonObject object = document.object();
-
-    if (object["object"].toString() != "packageLibrary")
-        throw ExceptionData("File is not a package library file");
-
-    QJsonArray filenames(object["filenames"].toArray());
-
-    for (auto f : filenames) {
-        readJsonFile(packagesDirectory + "/" + f.toString(), byteArray);
-        readPackages(byteArray);
+    QStringList filenames = Library::filenames(libraryname, "symbolLibrary");
+    std::vector<LibraryFile> files = Library::readFiles(symbolsDirectory, filenames);
+    std::vector<std::vector<LibraryObject>> devices(files.size());
+    std::vector<std::vector<LibraryObject>> elements(files.size());
+    std::vector<QString> objectTypes(files.size());
+
+    ThreadPool::global().parallelFor(0, files.size(), [&](int first, int last) {
+        for (int i = first; i < last; i++)
+            if (!Library::scan(files[i], "devices", "name", "pins",
+                               objectTypes[i], devices[i]))
+                Library::scan(files[i], "elements", "type", "pins",
+                              objectTypes[i], elements[i]);
+    }, 1);
+
+    for (uint i = 0; i < files.size(); i++) {
+        if (objectTypes[i] != "symbols")
+            throw ExceptionData("File is not a symbol file: " + filenames[i]);
+        for (auto &d : devices[i])
+            Device::addSymbol(d);
+        for (auto &e : elements[i])
+            Element::addSymbol(e);
+        if (devices[i].empty() && elements[i].empty())
+            readSymbols(QJsonDocument::fromJson(files[i].data));
     }
 }
 
-void Schematic::readSymbolLibrary(const QString &libraryname)
+void Schematic::recordObject(int object, qint64 key, const QJsonObject &before)
 {
-    QByteArray byteArray;
-    readJsonFile(libraryname, byteArray);
-
-    QJsonDocument document(QJsonDocument::fromJson(byteArray));
-    if (document.isNull())
-        throw ExceptionData("Shema file read error");
-
-    QJsonObject object = document.object();
-
-    if (object["object"].toString() != "symbolLibrary")
-        throw ExceptionData("File is not a symbol library file");
-
-    QJsonArray filenames(object["filenames"].toArray());
+    journal.record(object, key, before, objectJson(object, key));
+}
 
-    for (auto f : filenames) {
-        readJsonFile(symbolsDirectory + "/" + f.toString(), byteArray);
-        readSymbols(byteArray);
-    }
+bool Schematic::redo()
+{
+    return journal.redo([this](const JournalChange &change, bool undo) {
+        applyChange(change, undo);
+    });
 }
 
 // Reduce number of wires
-void Schematic::reduceWires(std::list <Wire> &wires)
+void Schematic::reduceWires(std::list <Wire> &wires, bool record)
 {
+    int number = 0;                     // key of i
+
     for (auto i = wires.begin(); i != wires.end();) {
         bool wiresJoined = false;
-        for (auto j = wires.begin(); j != wires.end(); ++j) {
-            if (i != j)
+        int number2 = 0;                // key of j
+        for (auto j = wires.begin(); j != wires.end(); ++j, number2++) {
+            if (i != j) {
+                Wire before(*j);
                 if (joinWires(*j, *i)) {
+                    if (record) {
+                        journal.record(WIRE_OBJECT, number2, before.toJson(), (*j).toJson());
+                        journal.record(WIRE_OBJECT, number, (*i).toJson(), QJsonObject());
+                    }
                     i = wires.erase(i);
                     wiresJoined = true;
                     break;
                 }
+            }
         }
-        if (!wiresJoined)
+        if (!wiresJoined) {
             ++i;
+            number++;
+        }
+    }
+}
+
+// Symbols keep identifiers. Changes are recorded at old and new centers,
+// symbols are moved together, so they can take centers of each other.
+template<typename Type>
+void Schematic::replaceObjects(ObjectStore<Type> &objects, int object,
+                               const std::vector<int> &ids,
+                               const std::vector<Type> &symbols)
+{
+    std::set<qint64> centers;
+    for (uint i = 0; i < ids.size(); i++) {
+        centers.insert(objects[ids[i]].center);
+        centers.insert(symbols[i].center);
     }
+
+    std::map<qint64, QJsonObject> before;
+    for (qint64 c : centers)
+        before[c] = objectJson(object, c);
+
+    objects.replace(ids, symbols);
+
+    for (qint64 c : centers)
+        recordObject(object, c, before[c]);
 }
 
 void Schematic::setNetNumber(int &net1, int &net2)
@@ -883,229 +1372,293 @@ void Schematic::setNetNumber(int &net1, int &net2)
 
 void Schematic::setValue(int x, int y)
 {
-    static int center;
+    static int id;
     static int number;
 
     if (!selectedArray) {
-        for (auto a : arrays)
-            if (a.second.exist(x, y)) {
-                center = a.second.center;
-                number = (y - a.second.refY + 0.5 * a.second.deltaY) / a.second.deltaY;
-                limit(number, 0, a.second.number);
-                value.clear();
-                selectedArray = true;
-                return;
-            }
+        if ((id = findSymbol(ARRAY_OBJECT, x, y)) >= 0) {
+            const Array &a = arrays[id];
+            number = (y - a.refY + 0.5 * a.deltaY) / a.deltaY;
+            limit(number, 0, a.number);
+            value.clear();
+            selectedArray = true;
+            return;
+        }
     }
     if (selectedArray) {
-        if (number == arrays[center].number)
-            arrays[center].name = value;
+        Array &array = arrays[id];
+        QJsonObject before = array.toJson();
+        if (number == array.number)
+            array.name = value;
         else
-            arrays[center].pinNames[number] = value;
+            array.pinNames[number] = value;
+        recordObject(ARRAY_OBJECT, array.center, before);
         selectedArray = false;
         return;
     }
 
     if (!selectedDevice) {
-        for (auto d : devices)
-            if (d.second.exist(x, y)) {
-                center = d.second.center;
-                value.clear();
-                selectedDevice = true;
-                return;
-            }
+        if ((id = findSymbol(DEVICE_OBJECT, x, y)) >= 0) {
+            value.clear();
+            selectedDevice = true;
+            return;
+        }
     }
     if (selectedDevice) {
-        devices[center].name = value;
+        Device &device = devices[id];
+        QJsonObject before = device.toJson();
+        device.name = value;
+        recordObject(DEVICE_OBJECT, device.center, before);
         selectedDevice = false;
         return;
     }
 
     if (!selectedElement) {
-        for (auto e : elements)
-            if (e.second.exist(x, y)) {
-                center = e.second.center;
-                value.clear();
-                selectedElement = true;
-                return;
-            }
+        if ((id = findSymbol(ELEMENT_OBJECT, x, y)) >= 0) {
+            value.clear();
+            selectedElement = true;
+            return;
+        }
     }
     if (selectedElement) {
-        elements[center].value = value;
+        Element &element = elements[id];
+        QJsonObject before = element.toJson();
+        element.value = value;
+        recordObject(ELEMENT_OBJECT, element.center, before);
         selectedElement = false;
         return;
     }
 }
 
+bool Schematic::undo()
+{
+    return journal.undo([this](const JournalChange &change, bool undo) {
+        applyChange(change, undo);
+    });
+}
+
 // Update nets and insert junctions if needed
-void Schematic::updateNets()
+// Objects of keys changed since last update are indexed again.
+// Wire keys are list positions, which are shifted by inserts and
+// erases, so copies of wires are indexed and found by content.
+void Schematic::updateIndex()
 {
-    int groundNet = -1;
-    int groundIecNet = -1;
-    int maxGroundNet = 0;
+    constexpr int fontSize = 10;
+    constexpr int junctionSize = 2;
+
+    auto junctionBounds = [](qint64 point) {
+        int x = Point::keyX(point);
+        int y = Point::keyY(point);
+        return Border(x - junctionSize, y - junctionSize, x + junctionSize, y + junctionSize);
+    };
+
+    auto insertWire = [&](const Wire &w) {
+        index.insert(WIRE_OBJECT, wireItemKey, wireBounds(w, fontSize));
+        wireItems.emplace(wireItemKey, w);
+        wireItemKey++;
+    };
+
+    auto removeWire = [&](const Wire &w) {
+        std::vector<qint64> keys;
+        index.find(WIRE_OBJECT, wireBounds(w, fontSize), keys);
+        for (qint64 key : keys)
+            if (sameWire(wireItems.at(key), w)) {
+                index.remove(WIRE_OBJECT, key);
+                wireItems.erase(key);
+                return;
+            }
+    };
 
-    // Set groundIecNet
-    for (auto c : circuitSymbols) {
-        if (c.second.type == GROUND)
-            groundNet = 0;
-        if (c.second.type == GROUND_IEC)
-            groundIecNet = 0;
-    }
+    indexObjects(arrays, ARRAY_OBJECT);
+    indexObjects(circuitSymbols, CIRCUIT_SYMBOL_OBJECT);
+    indexObjects(devices, DEVICE_OBJECT);
+    indexObjects(elements, ELEMENT_OBJECT);
 
-    if (!groundNet && !groundIecNet) {
-        groundIecNet = 1;
-        maxGroundNet = 1;
+    if (index.isDirty(JUNCTION_OBJECT)) {
+        index.clear(JUNCTION_OBJECT);
+        for (qint64 point : junctions)
+            index.insert(JUNCTION_OBJECT, point, junctionBounds(point));
     }
 
-    pins.clear();
-
-    // Get all pins of arrays
-    for (auto a : arrays)
-        for (uint i = 0; i < a.second.pins.size(); ++i)
-            pins.push_back(Pin(a.second.reference, i + 1,
-                a.second.pins[i].x, a.second.pins[i].y, -1));
-
-    // Get all pins of devices
-    for (auto d : devices)
-        for (uint i = 0; i < d.second.pins.size(); ++i)
-            pins.push_back(Pin(d.second.reference, i + 1,
-                d.second.pins[i].x, d.second.pins[i].y, -1));
-
-    // Get all pins of elements
-    for (auto e : elements)
-        for (uint j = 0; j < e.second.pins.size(); ++j)
-            pins.push_back(Pin(e.second.reference, j + 1,
-                e.second.pins[j].x, e.second.pins[j].y, -1));
-
-    // Get all pins of ground
-    for (auto c : circuitSymbols) {
-        int n = -1;
-        if (c.second.type == GROUND)
-            n = groundNet;
-        if (c.second.type == GROUND_IEC)
-            n = groundIecNet;
-        if (n == -1)
-            continue;
-        pins.push_back(Pin(circuitSymbolTypeString[c.second.type], 1,
-                           c.second.refX, c.second.refY, n));
+    for (const auto &change : index.takeChanges(JUNCTION_OBJECT)) {
+        if (junctions.count(change.key))
+            index.insert(JUNCTION_OBJECT, change.key, junctionBounds(change.key));
+        else
+            index.remove(JUNCTION_OBJECT, change.key);
     }
 
-    reduceWires(wires);
+    if (index.isDirty(WIRE_OBJECT)) {
+        index.clear(WIRE_OBJECT);
+        wireItems.clear();
+        wireItemKey = 0;
+        for (const auto &w : wires)
+            insertWire(w);
+    }
 
-    for (auto &w : wires)
-        w.net = -1;
+    for (const auto &change : index.takeChanges(WIRE_OBJECT)) {
+        if (!change.before.isEmpty())
+            removeWire(Wire(change.before));
+        if (!change.after.isEmpty())
+            insertWire(Wire(change.after));
+    }
+}
 
-    // Add junctions
-    for (auto i = pins.begin(); i != pins.end(); ++i) {
-        int connect = 0;
-        for (auto j = i; j != pins.end();) {
-            ++j;
-            if ((*i).x == (*j).x && (*i).y == (*j).y)
-                connect++;
-        }
-        for (auto w : wires) {
-            if (((*i).x == w.x1 && (*i).y == w.y1) ||
-                ((*i).x == w.x2 && (*i).y == w.y2))
-                connect++;
+// Joined wires and wires with changed nets are recorded
+void Schematic::updateNets()
+{
+    int number = 0;
+    std::vector<int> oldNets;
+
+    journal.begin("Update nets");
+    reduceWires(wires, true);
+    for (const auto &w : wires)
+        oldNets.push_back(w.net);
+    findNets(wires);
+    for (const auto &w : wires) {
+        if (w.net != oldNets[number]) {
+            Wire before(w);
+            before.net = oldNets[number];
+            journal.record(WIRE_OBJECT, number, before.toJson(), w.toJson());
         }
-        if (connect > 1)
-            addJunction((*i).x, (*i).y);
+        number++;
     }
+    journal.end();
+}
 
-    // Current state:
-    // ground pins: net = 0 and may be 1, other pins: net = -1
-    // wires: net = -1
-
-    bool finished = false;
-    int netNumber = 0;
-    int tmpNumber = -2;
-    int unconnectedNumber = -3;
-
-    while (!finished) {
-        int connect = 1;
-        auto tmp = pins.begin();
-        for (auto i = pins.begin(); i != pins.end(); ++i) {
-            if (netNumber <= maxGroundNet)
-                if ((*i).net != netNumber)
-                    continue;
-            if (netNumber > maxGroundNet) {
-                if ((*i).net != -1)
-                    continue;
-                (*i).net = netNumber;
-                tmp = i;
-                connect = 0;
-            }
-
-            // Set tmpNumber for pin to pin connection
-            for (auto j = pins.begin(); j != pins.end(); ++j) {
-                if (i == j || (*j).net != -1)
-                    continue;
-                if ((*i).x == (*j).x && (*i).y == (*j).y) {
-                    (*j).net = tmpNumber;
-                    connect = 1;
-                }
-            }
+// Junctions and nets are not edits, wire keys of edit log are kept
+void Schematic::updatePinNets()
+{
+    std::list<Wire> netWires(wires);
 
-            // Set netNumber for pin to wire connection
-            for (auto &w : wires)
-                if (connected(*i, w) && w.net == -1)
-                    w.net = netNumber;
+    journal.begin("Update pin nets");
+    reduceWires(netWires);
+    findNets(netWires);
+    journal.clear();
+}
 
-            if (netNumber > maxGroundNet)
-                break;
-        }
+// Element symbols of same type and orientation are defined once,
+// symbol lines and wires are one path each
+void Schematic::writeSVG(const QString &filename)
+{
+    constexpr int fontSize = 10;
+    constexpr int junctionRadius = 2;
+    constexpr int margin = 20;
+    bool hasViewBox = false;
+    Border viewBox(0, 0, 0, 0);
+    SvgPath junctionPath;
+    SvgPath symbolPath;
+    SvgPath wirePath;
+    std::map<std::tuple<int, int, bool>, int> symbolIDs;  // type, orientation, mirror
+    std::vector<SvgPath> symbolPaths;
+    std::vector<const Element*> symbolElements;
 
-        // Change pin net with tmpNumber to netNumber
-        for (auto i = pins.begin(); i != pins.end(); ++i)
-            if ((*i).net == tmpNumber)
-                (*i).net = netNumber;
+    for (auto &a : arrays)
+        for (auto &l : a.lines)
+            symbolPath.line(l.x1, l.y1, l.x2, l.y2);
 
-        // Set net number for wire to wire connection
-        bool wireUpdated = true;
-        while (wireUpdated) {
-            wireUpdated = false;
-            for (auto j = wires.begin(); j != wires.end(); ++j) {
-                if ((*j).net != netNumber)
-                    continue;
-                for (auto k = wires.begin(); k != wires.end(); ++k) {
-                    if (j == k || (*k).net != -1)
-                        continue;
-                    if (connected(*j, *k) ||
-                        (!(*j).name.isEmpty() && (*j).name == (*k).name)) {
-                        (*k).net = netNumber;
-                        wireUpdated = true;
-                    }
-                }
-            }
+    for (auto &c : circuitSymbols)
+        for (int i = 0; i < c.linesNumber; i++) {
+            const int *l = c.lines[i];
+            symbolPath.line(l[0], l[1], l[2], l[3]);
         }
 
-        // Set net number for wire to pin connection
-        for (auto w : wires) {
-            if (w.net != netNumber)
-                continue;
-            for (auto i = pins.begin(); i != pins.end(); ++i)
-                if (connected(*i, w) && (*i).net == -1) {
-                    (*i).net = netNumber;
-                    connect = 1;
-                }
+    for (auto &d : devices)
+        for (auto &u : d.units) {
+            for (auto &l : u.lines)
+                symbolPath.line(l.x1, l.y1, l.x2, l.y2);
+            for (auto &e : u.ellipses)
+                symbolPath.ellipse(e.x + e.w / 2., e.y + e.h / 2., e.w / 2., e.h / 2.);
         }
 
-        if (netNumber <= maxGroundNet || connect)
-            netNumber++;
-
-        if (netNumber > maxGroundNet && !connect)
-            (*tmp).net = unconnectedNumber;
+    // Symbol is relative to reference point of first element
+    for (const auto &element : elements) {
+        auto key = std::make_tuple(element.type, element.orientation, element.mirror);
+        if (symbolIDs.count(key))
+            continue;
+        symbolIDs[key] = symbolPaths.size();
+        symbolPaths.push_back(SvgPath());
+        SvgPath &path = symbolPaths.back();
+        for (auto &a : element.arcs)
+            path.arc(a.x + a.w / 2. - element.refX, a.y + a.h / 2. - element.refY,
+                     a.w / 2., a.h / 2., a.startAngle, a.spanAngle);
+        for (auto &l : element.lines)
+            path.line(l.x1 - element.refX, l.y1 - element.refY,
+                      l.x2 - element.refX, l.y2 - element.refY);
+    }
 
-        finished = true;
-        for (auto i = pins.begin(); i != pins.end(); ++i)
-            if ((*i).net == -1) {
-                finished = false;
-                break;
-            }
+    for (auto &w : wires)
+        wirePath.line(w.x1, w.y1, w.x2, w.y2);
+    for (auto &n : net)
+        wirePath.line(n.x1, n.y1, n.x2, n.y2);
+
+    for (auto j : junctions)
+        junctionPath.ellipse(Point::keyX(j), Point::keyY(j), junctionRadius, junctionRadius);
+
+    symbolPath.unite(viewBox, hasViewBox);
+    wirePath.unite(viewBox, hasViewBox);
+    junctionPath.unite(viewBox, hasViewBox);
+    for (const auto &element : elements) {
+        SvgPath bounds;
+        bounds.line(element.border.leftX, element.border.topY,
+                    element.border.rightX, element.border.bottomY);
+        bounds.unite(viewBox, hasViewBox);
+    }
+    viewBox = Border(viewBox.leftX - margin, viewBox.topY - margin,
+                     viewBox.rightX + margin, viewBox.bottomY + margin);
+
+    SvgWriter svg(filename);
+    svg.begin(viewBox, 0.254);
+
+    svg.beginDefs();
+    for (uint i = 0; i < symbolPaths.size(); i++)
+        svg.path(symbolPaths[i], "id=\"s" + QString::number(i) + "\"");
+    svg.endDefs();
+
+    svg.beginGroup("fill=\"none\" stroke=\"#c86464\"");
+    svg.path(symbolPath, "");
+    for (const auto &element : elements) {
+        auto key = std::make_tuple(element.type, element.orientation, element.mirror);
+        svg.use("s" + QString::number(symbolIDs[key]), element.refX, element.refY);
+    }
+    svg.endGroup();
+
+    svg.beginGroup("fill=\"#00c800\" stroke=\"#00c800\"");
+    svg.path(wirePath, "fill=\"none\"");
+    svg.path(junctionPath, "stroke=\"none\"");
+    svg.endGroup();
+
+    svg.beginGroup("fill=\"#c86464\" font-family=\"Times\" font-size=\"" +
+                   QString::number(fontSize) + "\"");
+    for (const auto &array : arrays) {
+        if (array.name.size())
+            svg.text(array.nameTextX, array.nameTextY + array.deltaY * array.number,
+                     array.name, "");
+        svg.text(array.referenceTextX, array.referenceTextY, array.reference, "");
+    }
+    for (const auto &device : devices) {
+        for (auto &u : device.units)
+            svg.text(u.centerX, u.border.topY - 2, u.reference,
+                     "text-anchor=\"middle\"");
+        if (!device.units.empty())
+            svg.text(device.units[0].centerX, device.units[0].border.bottomY + 1 + fontSize,
+                     device.name, "text-anchor=\"middle\"");
+    }
+    for (const auto &element : elements) {
+        svg.text(element.referenceTextX, element.referenceTextY, element.reference, "");
+        svg.text(element.valueTextX, element.valueTextY, element.value, "");
     }
+    svg.endGroup();
 
-    // Set net = -1 for unconnected pins
-    for (auto i = pins.begin(); i != pins.end(); ++i)
-        if ((*i).net == unconnectedNumber)
-            (*i).net = -1;
+    svg.beginGroup("fill=\"#00c800\" font-family=\"Times\" font-size=\"" +
+                   QString::number(fontSize) + "\"");
+    for (auto &w : wires)
+        if (!w.name.isEmpty()) {
+            if (!w.nameSide)
+                svg.text(std::min(w.x1, w.x2), w.y1, w.name, "");
+            else
+                svg.text(std::max(w.x1, w.x2), w.y1, w.name, "text-anchor=\"end\"");
+        }
+    svg.endGroup();
+
+    svg.end();
 }
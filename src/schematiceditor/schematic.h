@@ -8,12 +8,18 @@
 #include "circuitsymbol.h"
 #include "device.h"
 #include "element.h"
-#include "package.h"
+#include "journal.h"
+#include "jsoncache.h"
+#include "library.h"
+#include "objectstore.h"
+#include "schematicindex.h"
 #include "types.h"
 #include <iterator>
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <QByteArray>
 
 constexpr int windowSizeX = 1200;
@@ -39,12 +45,31 @@ public:
     int net;        // net number
 };
 
+// Instance of other sheet file. Ports of instance sheet are joined
+// to named nets of this sheet.
+class SheetInstance
+{
+public:
+    SheetInstance() {}
+    SheetInstance(const QJsonObject &object);
+    void draw(QPainter &painter, int fontSize) const;
+    QJsonObject toJson() const;
+
+    int x;                              // top left corner
+    int y;
+    QString filename;                   // relative to directory of this sheet
+    QString name;                       // prefix of instance references
+    std::map<QString, QString> ports;   // port name, net name of this sheet
+};
+
 class Wire
 {
 public:
     Wire() {}
     Wire(int x1, int y1, int x2, int y2, int net, QString name = "", int nameSide = 0):
          x1(x1), y1(y1), x2(x2), y2(y2), net(net), name(name), nameSide(nameSide) {}
+    Wire(const QJsonObject &object);
+    QJsonObject toJson() const;
 
     int x1;
     int y1;
@@ -61,7 +86,15 @@ class Schematic
     typedef std::list<Wire>::iterator WireIt;
 
 public:
-    Schematic();
+    // Journal objects, key: center of symbol, junction point or wire index
+    enum JournalObject
+    {
+        ARRAY_OBJECT, CIRCUIT_SYMBOL_OBJECT, DEVICE_OBJECT, ELEMENT_OBJECT,
+        JUNCTION_OBJECT, WIRE_OBJECT
+    };
+
+    // Libraries are not read for sheets loaded only for netlist
+    explicit Schematic(bool hasLibraries = true);
     void addArray(int type, int pins, int x, int y, int orientation);
     void addCircuitSymbol(int circuitSymbolType, int x, int y);
     void addDevice(int symbolNameID, int x, int y);
@@ -70,6 +103,7 @@ public:
     void addNet();
     void addNetName(int x, int y);
     void addPoint(int x, int y);
+    void applyChange(const JournalChange &change, bool undo);
     void clear();
     void componentList(QString &text);
     bool connected(const Pin &pin, const Wire &wire);
@@ -78,12 +112,16 @@ public:
     void deleteJunction(int x, int y);
     void deleteNet(int x, int y);
     void deleteWire(int x, int y);
+    // Objects crossing painter window are drawn
     void draw(QPainter &painter);
     void enumerate();
     void errorCheck(QString &text);
     template<typename Type>
-    void errorCheck(std::map<QString, QString> &components, Type t);
-    void fromJson(const QByteArray &array);
+    void errorCheck(std::map<QString, QString> &components, const Type &t);
+    // hasNets: wires and nets are used as read, without update
+    void fromJson(const QByteArray &array, bool hasNets = false);
+    // Net numbers of ground symbols, -1: no ground
+    void groundNets(int &groundNet, int &groundIecNet) const;
     void horizontalMirror(int x, int y);
     bool insideConnected(int x, int y, const Wire &wire);
     bool insideConnected(const Pin &pin, const Wire &wire);
@@ -101,24 +139,30 @@ public:
     void moveUp();
     QJsonObject netlist();
     template<typename Type>
-    void netlist(QJsonArray &netlistElements, Type t, QString str);
+    void netlist(QJsonArray &netlistElements, const Type &t, const QString &name);
     template<typename Type>
     int padNumber(const Type &t, int pinNumber);
     int padNumber(const Element &e, int pinNumber);
+    bool redo();
     void readFile(const QString &filename, QString &text);
-    void readJsonFile(const QString &filename, QByteArray &byteArray);
     void readPackageLibrary(const QString &libraryname);
-    void readPackages(const QByteArray &byteArray);
     void readSymbolLibrary(const QString &libraryname);
-    void readSymbols(const QByteArray &byteArray);
-    void reduceWires(std::list<Wire> &wires);
+    void readSymbols(const QJsonDocument &document);
+    // record: wires of schematic are recorded
+    void reduceWires(std::list<Wire> &wires, bool record = false);
     void setNetNumber(int &net1, int &net2);
     void setValue(int x, int y);
-    QJsonObject toJson();
+    QJsonObject toJson() const;
+    // File data, sections not changed since last call are not serialized again
+    QByteArray toJsonData();
+    bool undo();
     void updateNets();
+    // Pins and pin nets of recovered schematic, wires are not changed
+    void updatePinNets();
     template<typename Type>
     void writeComponentList(const Type &t, QString &text);
     QJsonObject writePackageLibrary();
+    void writeSVG(const QString &filename);
     QJsonObject writeSymbolLibrary();
 
     bool selectedArray;
@@ -135,6 +179,8 @@ public:
     Array array;
     Device device;
     Element element;
+    Journal journal;
+    JsonCache jsonCache;
     Net net;
     Point point;
     QRect groupBorder;
@@ -143,13 +189,35 @@ public:
     Wire wire;
     std::list<Pin> pins;
     std::list<Wire> wires;
-    std::map<int, Array> arrays;                  // array.center, array
-    std::map<int, CircuitSymbol> circuitSymbols;  // circuitSymbol.center, circuitSymbol
-    std::map<int, Device> devices;                // device.center, device
-    std::map<int, Element> elements;              // element.center, element
-    std::set<int> junctions;    // x > 0 (16 high bits), y > 0 (16 low bits)
-    std::vector<Package> packages;
+    ObjectStore<Array> arrays;
+    ObjectStore<CircuitSymbol> circuitSymbols;
+    ObjectStore<Device> devices;
+    ObjectStore<Element> elements;
+    std::unordered_map<qint64, int> pinNets;    // pin point key, net
+    std::unordered_set<qint64> junctions;       // point keys
     std::vector<Point> points;
+    std::vector<QString> ports;         // net names joined by instances of sheet
+    std::vector<SheetInstance> sheets;
+
+private:
+    // Pins, pin nets and nets of reduced wires, junctions of connected pins are added
+    void findNets(std::list<Wire> &netWires);
+    // Identifier of symbol kind at point, -1: no symbol
+    int findSymbol(int object, int x, int y);
+    template<typename Type>
+    void indexObjects(const ObjectStore<Type> &objects, int object);
+    QJsonObject objectJson(int object, qint64 key);
+    void recordObject(int object, qint64 key, const QJsonObject &before);
+    template<typename Type>
+    void replaceObjects(ObjectStore<Type> &objects, int object,
+                        const std::vector<int> &ids, const std::vector<Type> &symbols);
+    QJsonValue sectionJson(int object) const;
+    void sheetJson(QJsonObject &object) const;
+    void updateIndex();
+
+    SchematicIndex index;
+    qint64 wireItemKey;                         // key of next indexed wire
+    std::unordered_map<qint64, Wire> wireItems; // key in index, copy of wire
 };
 
 #endif  // SCHEMATIC_H
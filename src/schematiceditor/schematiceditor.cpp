@@ -9,6 +9,7 @@
 #include "packageselector.h"
 #include "schematiceditor.h"
 #include <algorithm>
+#include <QCoreApplication>
 #include <QFile>
 #include <QFileDialog>
 #include <QIODevice>
@@ -19,11 +20,12 @@
 #include <QListWidget>
 #include <QMessageBox>
 #include <QPushButton>
-#include <QSvgGenerator>
 #include <QTextStream>
 #include <QVBoxLayout>
 
-SchematicEditor::SchematicEditor(QWidget *parent) : QMainWindow(parent)
+SchematicEditor::SchematicEditor(QWidget *parent) : QMainWindow(parent),
+    editLog("schematiceditor-autosave"),
+    hierarchy(schematic)
 {
     setupUi(this);
 
@@ -31,6 +33,8 @@ SchematicEditor::SchematicEditor(QWidget *parent) : QMainWindow(parent)
     connect(actionSaveFile, SIGNAL(triggered()), this, SLOT(saveFile()));
     connect(actionCloseFile, SIGNAL(triggered()), this, SLOT(closeFile()));
     connect(actionQuit, SIGNAL(triggered()), this, SLOT(close()));
+    connect(actionUndo, SIGNAL(triggered()), this, SLOT(undo()));
+    connect(actionRedo, SIGNAL(triggered()), this, SLOT(redo()));
     connect(actionSaveComponentList, SIGNAL(triggered()), this, SLOT(saveComponentList()));
     connect(actionSaveErrorCheck, SIGNAL(triggered()), this, SLOT(saveErrorCheck()));
     connect(actionSaveNetlist, SIGNAL(triggered()), this, SLOT(saveNetlist()));
@@ -77,6 +81,29 @@ SchematicEditor::SchematicEditor(QWidget *parent) : QMainWindow(parent)
     dxLineEdit->setText(str.setNum(dx/grid));
     dyLineEdit->setText(str.setNum(-dy/grid));
     stepLineEdit->setText(str.setNum(step/grid));
+
+    // Schematic of interrupted session
+    if (editLog.canRecover() &&
+        QMessageBox::question(this, tr("Recovery"), tr("Recover unsaved schematic?")) ==
+        QMessageBox::Yes) {
+        try {
+            editLog.recover([this](const QByteArray &snapshot) {
+                                schematic.fromJson(snapshot, true);
+                            },
+                            [this](const JournalChange &change, bool undo) {
+                                schematic.applyChange(change, undo);
+                            });
+            schematic.updatePinNets();
+            actionOpenFile->setEnabled(false);
+            actionCloseFile->setEnabled(true);
+        }
+        catch (ExceptionData &e) {
+            QMessageBox::warning(this, tr("Error"), e.show());
+        }
+    }
+
+    editLog.attach(schematic.journal, [this]() { return schematic.toJsonData(); });
+    editLog.snapshot();
 }
 
 void SchematicEditor::about()
@@ -100,6 +127,8 @@ void SchematicEditor::buttonsSetEnabled(const char *params)
 void SchematicEditor::closeFile()
 {
     schematic.clear();
+    sheetFilename.clear();
+    hierarchy.setOpenFile(sheetFilename);
 
     actionOpenFile->setEnabled(true);
     actionCloseFile->setEnabled(false);
@@ -264,6 +293,8 @@ void SchematicEditor::openFile()
         QMessageBox::warning(this, tr("Error"), e.show());
         return;
     }
+    sheetFilename = fileName;
+    hierarchy.setOpenFile(sheetFilename);
 
     actionOpenFile->setEnabled(false);
     actionCloseFile->setEnabled(true);
@@ -297,6 +328,25 @@ void SchematicEditor::paintEvent(QPaintEvent *)
     schematic.draw(painter);
 }
 
+void SchematicEditor::redo()
+{
+    schematic.selectedArray = false;
+    schematic.selectedCircuitSymbol = false;
+    schematic.selectedDevice = false;
+    schematic.selectedElement = false;
+    schematic.selectedWire = false;
+    schematic.pointNumber = 0;
+
+    try {
+        schematic.redo();
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+
+    update();
+}
+
 void SchematicEditor::saveComponentList()
 {
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save lst file"),
@@ -342,11 +392,10 @@ void SchematicEditor::saveFile()
     if (!file.open(QIODevice::WriteOnly))
         return;
 
-    QJsonDocument document(schematic.toJson());
-    QByteArray array(document.toJson());
-
-    file.write(array);
+    file.write(schematic.toJsonData());
     file.close();
+    sheetFilename = fileName;
+    hierarchy.setOpenFile(sheetFilename);
 }
 
 /*
@@ -369,10 +418,11 @@ void SchematicEditor::saveNetlist()
     if (!file.open(QIODevice::WriteOnly))
         return;
 
+    // Sheet with instances gives netlist of whole hierarchy
     try {
-        QJsonDocument document(schematic.netlist());
-        QByteArray array(document.toJson());
-        file.write(array);
+        QJsonDocument document(schematic.sheets.empty() ? schematic.netlist() :
+                                                          hierarchy.netlist(sheetFilename));
+        file.write(document.toJson());
     }
     catch (ExceptionData &e) {
         QMessageBox::warning(this, tr("Error"), e.show());
@@ -384,26 +434,17 @@ void SchematicEditor::saveNetlist()
 
 void SchematicEditor::saveSVG()
 {
-    constexpr int x = 0;
-    constexpr int y = 0;
-    constexpr int width = 1500;
-    constexpr int height = 1000;
-
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save svg file"),
                        schematicDirectory, tr("svg files (*.svg)"));
+    if (fileName.isNull())
+        return;
 
-    QSvgGenerator generator;
-    generator.setFileName(fileName);
-    generator.setSize(QSize(width, height));
-    generator.setViewBox(QRect(x, y, width, height));
-    generator.setTitle(tr("Schematic"));
-    generator.setDescription(tr("Schematic"));
-
-    QPainter painter;
-    painter.begin(&generator);
-    painter.fillRect(x, y, width, height, Qt::white);
-    schematic.draw(painter);
-    painter.end();
+    try {
+        schematic.writeSVG(fileName);
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
 }
 
 void SchematicEditor::selectArray(int type, int &pins, int &orientation)
@@ -549,10 +590,7 @@ void SchematicEditor::selectCommand(int number)
 
 void SchematicEditor::selectDevice(int &deviceSymbolNameID)
 {
-    QStringList deviceSymbolNames;
-    for (auto ds : Device::symbols)
-        deviceSymbolNames += ds.second.name;
-    DeviceSelector deviceSelector(deviceSymbolNames);
+    DeviceSelector deviceSelector(Device::symbolNames);
     deviceSymbolNameID = deviceSelector.exec() - 1;
 }
 
@@ -569,6 +607,25 @@ void SchematicEditor::selectPackages()
 }
 
 /*
+void SchematicEditor::undo()
+{
+    schematic.selectedArray = false;
+    schematic.selectedCircuitSymbol = false;
+    schematic.selectedDevice = false;
+    schematic.selectedElement = false;
+    schematic.selectedWire = false;
+    schematic.pointNumber = 0;
+
+    try {
+        schematic.undo();
+    }
+    catch (ExceptionData &e) {
+        QMessageBox::warning(this, tr("Error"), e.show());
+    }
+
+    update();
+}
+
 void SchematicEditor::writeLibraryFile(QString filename, QJsonObject object)
 {
     QFile file("library/json/" + filename);
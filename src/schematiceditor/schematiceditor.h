@@ -4,6 +4,8 @@
 #ifndef SCHEMATICEDITOR_H
 #define SCHEMATICEDITOR_H
 
+#include "editlog.h"
+#include "hierarchy.h"
 #include "schematic.h"
 #include "ui_schematiceditor.h"
 #include <QJsonObject>
@@ -65,6 +67,7 @@ private slots:
     void about();
     void closeFile();
     void openFile();
+    void redo();
     void saveComponentList();
     void saveErrorCheck();
     void saveFile();
@@ -72,6 +75,7 @@ private slots:
     void saveNetlist();
     void saveSVG();
     void selectCommand(int);
+    void undo();
 
 private:
     int command;
@@ -82,9 +86,12 @@ private:
     int previousCommand;
     int step;
     QPoint mousePoint;
+    QString sheetFilename;  // file of schematic, top sheet of netlist
     QSignalMapper *signalMapper;
     QToolButton *toolButton[maxButton];
     Schematic schematic;
+    EditLog editLog;
+    Hierarchy hierarchy;
     std::vector<Line> lines;
 };
 
@@ -21,10 +21,13 @@ SOURCES += array.cpp \
     diodeselector.cpp \
     element.cpp \
     function.cpp \
+    glyphcache.cpp \
+    hierarchy.cpp \
     main.cpp \
     packageselector.cpp \
     schematic.cpp \
     schematiceditor.cpp \
+    schematicindex.cpp \
     symboleditor.cpp \
     text.cpp \
     unit.cpp
@@ -39,11 +42,14 @@ HEADERS += array.h \
     diodeselector.h \
     element.h \
     elementimage.h \
-    exceptiondata.h \
     function.h \
+    glyphcache.h \
+    hierarchy.h \
+    objectstore.h \
     packageselector.h \
     schematic.h \
     schematiceditor.h \
+    schematicindex.h \
     symboleditor.h \
     text.h \
     unit.h \
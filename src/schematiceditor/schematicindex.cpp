@@ -0,0 +1,170 @@
+// schematicindex.cpp
+// Copyright (C) 2026 Alexander Karpeko
+
+#include "schematicindex.h"
+#include <algorithm>
+
+namespace
+{
+bool crossed(const Border &b, const Border &b2)
+{
+    return b.leftX <= b2.rightX && b2.leftX <= b.rightX &&
+           b.topY <= b2.bottomY && b2.topY <= b.bottomY;
+}
+}
+
+void SchematicIndex::attach(Journal &journal)
+{
+    journal.addListener([this](const JournalChange &change, bool undo) {
+        if (change.object == Journal::allObjects) {
+            setAllDirty();
+            return;
+        }
+        Kind &k = kinds[change.object];
+        if (k.dirty)
+            return;
+        if (k.changes.size() > k.keys.size()) {
+            setDirty(change.object);
+            return;
+        }
+        if (undo)
+            k.changes.push_back({change.key, change.object, change.before, change.after});
+        else
+            k.changes.push_back(change);
+    });
+}
+
+unsigned long long SchematicIndex::cell(int cellX, int cellY)
+{
+    return (unsigned long long) (unsigned int) cellX << 32 | (unsigned int) cellY;
+}
+
+int SchematicIndex::cellNumber(int x)
+{
+    return x >= 0 ? x / cellSize : (x + 1) / cellSize - 1;
+}
+
+void SchematicIndex::clear(int kind)
+{
+    Kind &k = kinds[kind];
+    k.dirty = false;
+    k.grid.clear();
+    k.bounds.clear();
+    k.changes.clear();
+    k.entries.clear();
+    k.keys.clear();
+}
+
+// Area of more cells than entries is checked entry by entry
+void SchematicIndex::find(int kind, const Border &area, std::vector<qint64> &keys) const
+{
+    const Kind &k = kinds[kind];
+    int firstX = cellNumber(area.leftX);
+    int firstY = cellNumber(area.topY);
+    int lastX = cellNumber(area.rightX);
+    int lastY = cellNumber(area.bottomY);
+    double cells = double(lastX - firstX + 1) * (lastY - firstY + 1);
+
+    keys.clear();
+    if (cells > k.keys.size()) {
+        for (uint i = 0; i < k.keys.size(); i++)
+            if (crossed(k.bounds[i], area))
+                keys.push_back(k.keys[i]);
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+
+    std::vector<int> entries;
+    for (int x = firstX; x <= lastX; x++)
+        for (int y = firstY; y <= lastY; y++) {
+            auto i = k.grid.find(cell(x, y));
+            if (i != k.grid.end())
+                entries.insert(entries.end(), i->second.begin(), i->second.end());
+        }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    for (int e : entries)
+        if (crossed(k.bounds[e], area))
+            keys.push_back(k.keys[e]);
+    std::sort(keys.begin(), keys.end());
+}
+
+void SchematicIndex::insert(int kind, qint64 key, const Border &bounds)
+{
+    Kind &k = kinds[kind];
+    remove(kind, key);
+    int entry = k.keys.size();
+
+    k.bounds.push_back(bounds);
+    k.entries[key] = entry;
+    k.keys.push_back(key);
+    for (int x = cellNumber(bounds.leftX); x <= cellNumber(bounds.rightX); x++)
+        for (int y = cellNumber(bounds.topY); y <= cellNumber(bounds.bottomY); y++)
+            k.grid[cell(x, y)].push_back(entry);
+}
+
+// Last entry takes place of removed entry
+void SchematicIndex::remove(int kind, qint64 key)
+{
+    Kind &k = kinds[kind];
+    auto i = k.entries.find(key);
+    if (i == k.entries.end())
+        return;
+
+    int entry = i->second;
+    int last = k.keys.size() - 1;
+    k.entries.erase(i);
+    replaceEntry(k, entry, -1);
+    if (entry != last) {
+        replaceEntry(k, last, entry);
+        k.bounds[entry] = k.bounds[last];
+        k.keys[entry] = k.keys[last];
+        k.entries[k.keys[entry]] = entry;
+    }
+    k.bounds.pop_back();
+    k.keys.pop_back();
+}
+
+// Entry is replaced by other entry in its cells, other < 0: entry is removed
+void SchematicIndex::replaceEntry(Kind &k, int entry, int other)
+{
+    const Border &b = k.bounds[entry];
+    for (int x = cellNumber(b.leftX); x <= cellNumber(b.rightX); x++)
+        for (int y = cellNumber(b.topY); y <= cellNumber(b.bottomY); y++) {
+            auto i = k.grid.find(cell(x, y));
+            if (i == k.grid.end())
+                continue;
+            std::vector<int> &entries = i->second;
+            auto e = std::find(entries.begin(), entries.end(), entry);
+            if (e == entries.end())
+                continue;
+            if (other >= 0) {
+                *e = other;
+                continue;
+            }
+            *e = entries.back();
+            entries.pop_back();
+            if (entries.empty())
+                k.grid.erase(i);
+        }
+}
+
+void SchematicIndex::setAllDirty()
+{
+    for (uint i = 0; i < kinds.size(); i++)
+        setDirty(i);
+}
+
+void SchematicIndex::setDirty(int kind)
+{
+    kinds[kind].dirty = true;
+    kinds[kind].changes.clear();
+}
+
+std::vector<JournalChange> SchematicIndex::takeChanges(int kind)
+{
+    std::vector<JournalChange> changes;
+    changes.swap(kinds[kind].changes);
+    return changes;
+}
@@ -0,0 +1,57 @@
+// schematicindex.h
+// Copyright (C) 2026 Alexander Karpeko
+
+#ifndef SCHEMATICINDEX_H
+#define SCHEMATICINDEX_H
+
+#include "journal.h"
+#include "types.h"
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid of object bounds for drawing of visible objects and
+// for hit testing. Kind of objects is journal object, changes of kind
+// are kept, so only objects of changed keys are updated. Kind with
+// more changes than objects is dirty and its objects are inserted again.
+class SchematicIndex
+{
+public:
+    static constexpr int cellSize = 200;
+
+    explicit SchematicIndex(int kinds): kinds(kinds) { setAllDirty(); }
+    void attach(Journal &journal);
+    // Objects are removed, kind is not dirty
+    void clear(int kind);
+    // Keys of objects with bounds crossing area, in increasing order
+    void find(int kind, const Border &area, std::vector<qint64> &keys) const;
+    // Object of same key is replaced
+    void insert(int kind, qint64 key, const Border &bounds);
+    bool isDirty(int kind) const { return kinds[kind].dirty; }
+    void remove(int kind, qint64 key);
+    void setAllDirty();
+    void setDirty(int kind);
+    // Changes of kind since last call, before and after as applied
+    std::vector<JournalChange> takeChanges(int kind);
+
+private:
+    typedef std::unordered_map<unsigned long long, std::vector<int>> Grid;
+
+    class Kind
+    {
+    public:
+        bool dirty;
+        Grid grid;                              // cell, entries
+        std::vector<Border> bounds;             // bounds of entry
+        std::vector<JournalChange> changes;     // changes not in index
+        std::unordered_map<qint64, int> entries;    // key, entry
+        std::vector<qint64> keys;               // object key of entry
+    };
+
+    static unsigned long long cell(int cellX, int cellY);
+    static int cellNumber(int x);
+    static void replaceEntry(Kind &k, int entry, int other);
+
+    std::vector<Kind> kinds;
+};
+
+#endif  // SCHEMATICINDEX_H
@@ -3,6 +3,7 @@
 
 #include "exceptiondata.h"
 #include "function.h"
+#include "library.h"
 #include "symboleditor.h"
 //#include "symbolselector.h"
 #include <algorithm>
@@ -242,9 +243,7 @@ void SymbolEditor::openFile()
     }
 
     try {
-        QByteArray byteArray;
-        readJsonFile(fileName, byteArray);
-        readSymbols(byteArray);
+        readSymbols(Library::readFile(fileName));
     }
     catch (ExceptionData &e) {
         QMessageBox::warning(this, tr("Error"), e.show());
@@ -291,15 +290,6 @@ void SymbolEditor::paintEvent(QPaintEvent *)
     //schematic.draw(painter);
 }
 
-void SymbolEditor::readJsonFile(const QString &filename, QByteArray &byteArray)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly))
-        throw ExceptionData(filename + " open error");
-    byteArray = file.readAll();
-    file.close();
-}
-
 void SymbolEditor::readSymbols(const QByteArray &byteArray)
 { /*
     QJsonDocument document(QJsonDocument::fromJson(byteArray));
@@ -508,10 +498,7 @@ void SymbolEditor::selectCommand(int number)
 
 void SymbolEditor::selectDevice(int &deviceNameID)
 {
-    QStringList deviceNames;
-    for (auto ds : Device::symbols)
-        deviceNames += ds.second.name;
-    DeviceSelector deviceSelector(deviceNames);
+    DeviceSelector deviceSelector(Device::symbolNames);
     deviceNameID = deviceSelector.exec() - 1;
 }
 
@@ -60,7 +60,6 @@ protected:
 
 private:
     void paintEvent(QPaintEvent *);
-    void readJsonFile(const QString &filename, QByteArray &byteArray);
     void readSymbols(const QByteArray &byteArray);
     void selectSymbol(int &symbolNameID);
 
@@ -5,6 +5,7 @@
 #include "function.h"
 #include "schematic.h"
 #include "text.h"
+#include <algorithm>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -17,6 +18,63 @@ void compareString(const QString &str, const QString &str2)
         throw ExceptionData(str2 + " error");
 }
 
+SheetInstance::SheetInstance(const QJsonObject &object)
+{
+    x = object["x"].toInt();
+    y = object["y"].toInt();
+    filename = object["filename"].toString();
+    name = object["name"].toString();
+
+    QJsonObject sheetPorts(object["ports"].toObject());
+    for (auto i = sheetPorts.begin(); i != sheetPorts.end(); ++i)
+        ports[i.key()] = i.value().toString();
+}
+
+QJsonObject SheetInstance::toJson() const
+{
+    QJsonObject sheetPorts;
+    for (const auto &p : ports)
+        sheetPorts[p.first] = p.second;
+
+    QJsonObject object
+    {
+        {"x", x},
+        {"y", y},
+        {"filename", filename},
+        {"name", name},
+        {"ports", sheetPorts}
+    };
+
+    return object;
+}
+
+Wire::Wire(const QJsonObject &object)
+{
+    x1 = object["x1"].toInt();
+    y1 = object["y1"].toInt();
+    x2 = object["x2"].toInt();
+    y2 = object["y2"].toInt();
+    net = object["net"].toInt();
+    name = object["name"].toString();
+    nameSide = object["nameSide"].toInt();
+}
+
+QJsonObject Wire::toJson() const
+{
+    QJsonObject object
+    {
+        {"x1", x1},
+        {"y1", y1},
+        {"x2", x2},
+        {"y2", y2},
+        {"net", net},
+        {"name", name},
+        {"nameSide", nameSide}
+    };
+
+    return object;
+}
+
 void Schematic::componentList(QString &text)
 {
     // Reference; value, package
@@ -24,29 +82,26 @@ void Schematic::componentList(QString &text)
     // Value; package, reference
     std::multimap<QString, std::vector<QString>> components2;
 
-    for (auto a : arrays) {
-        auto &c = a.second;
+    for (const auto &c : arrays) {
         if (c.name.isEmpty())
             continue;
         makeComponentList(components, c.reference, c.name, c.packageName);
         makeComponentList(components2, c.name, c.packageName, c.reference);
     }
 
-    for (auto d : devices) {
-        auto &c = d.second;
+    for (const auto &c : devices) {
         makeComponentList(components, c.reference, c.name, c.packageName);
         makeComponentList(components2, c.name, c.packageName, c.reference);
     }
 
-    for (auto e : elements) {
-        auto &c = e.second;
+    for (const auto &c : elements) {
         makeComponentList(components, c.reference, c.value, c.packageName);
         makeComponentList(components2, c.value, c.packageName, c.reference);
     }
 
     int maxSize = 0;
     int maxSize2 = 0;
-    for (auto c : components) {
+    for (const auto &c : components) {
         if (c.first.size() > maxSize)
             maxSize = c.first.size();
         if (c.second[0].size() > maxSize2)
@@ -64,48 +119,41 @@ void Schematic::errorCheck(QString &text)
 {
     std::map<QString, QString> components;  // reference pin, error
 
-    for (auto i = arrays.begin(); i != arrays.end(); ++i)
-        errorCheck(components, i);
+    for (const auto &a : arrays)
+        errorCheck(components, a);
 
-    for (auto i = devices.begin(); i != devices.end(); ++i)
-        errorCheck(components, i);
+    for (const auto &d : devices)
+        errorCheck(components, d);
 
-    for (auto i = elements.begin(); i != elements.end(); ++i)
-        errorCheck(components, i);
+    for (const auto &e : elements)
+        errorCheck(components, e);
 
     text = "Error check.\n";
     if (components.empty())
         text += "No errors.\n";
     else
-        for (auto c : components)
+        for (const auto &c : components)
             text += c.first + "\t" + c.second + "\n";
 }
 
 template<typename Type>
-void Schematic::errorCheck(std::map<QString, QString> &components, Type t)
+void Schematic::errorCheck(std::map<QString, QString> &components, const Type &t)
 {
     int netNumber;
-    int x, y;
     QString str, str2, str3;
 
-    for (uint i = 0; i < (*t).second.pins.size(); i++) {
-        x = (*t).second.pins[i].x;
-        y = (*t).second.pins[i].y;
-        netNumber = -1;
-        for (auto p : pins)
-            if (x == p.x && y == p.y) {
-                netNumber = p.net;
-                break;
-            }
+    for (uint i = 0; i < t.pins.size(); i++) {
+        auto p = pinNets.find(Point::key(t.pins[i].x, t.pins[i].y));
+        netNumber = p != pinNets.end() ? p->second : -1;
         if (netNumber == -1) {
-            str = (*t).second.reference + " pin: " + str2.setNum(i + 1);
+            str = t.reference + " pin: " + str2.setNum(i + 1);
             str3 = "error: not connected";
             components.insert(std::make_pair(str, str3));
         }
     }
 }
 
-void Schematic::fromJson(const QByteArray &array)
+void Schematic::fromJson(const QByteArray &array, bool hasNets)
 {
     QJsonDocument document(QJsonDocument::fromJson(array));
     if (document.isNull())
@@ -124,47 +172,47 @@ void Schematic::fromJson(const QByteArray &array)
     QJsonArray schematicCircuitSymbols(object["circuitSymbols"].toArray());
     QJsonArray schematicWires(object["wires"].toArray());
     QJsonArray schematicJunctions(object["junctions"].toArray());
+    QJsonArray schematicPorts(object["ports"].toArray());
+    QJsonArray schematicSheets(object["sheets"].toArray());
+
+    for (auto p : schematicPorts)
+        ports.push_back(p.toString());
+
+    for (auto s : schematicSheets)
+        sheets.push_back(SheetInstance(s.toObject()));
 
     for (auto s : schematicArrays) {
-        Array array(s.toObject());
-        arrays[array.center] = array;
+        arrays.add(Array(s.toObject()));
     }
 
     for (auto c : schematicCircuitSymbols) {
-        CircuitSymbol circuitSymbol(c.toObject());
-        circuitSymbols[circuitSymbol.center] = circuitSymbol;
+        circuitSymbols.add(CircuitSymbol(c.toObject()));
     }
 
     for (auto s : schematicDevices) {
-        Device device(s.toObject());
-        devices[device.center] = device;
+        devices.add(Device(s.toObject()));
     }
 
     for (auto s : schematicElements) {
-        Element element(s.toObject());
-        elements[element.center] = element;
+        elements.add(Element(s.toObject()));
     }
 
     for (auto s : schematicWires) {
-        QJsonObject obj(s.toObject());
-        Wire wire;
-        wire.x1 = obj["x1"].toInt();
-        wire.y1 = obj["y1"].toInt();
-        wire.x2 = obj["x2"].toInt();
-        wire.y2 = obj["y2"].toInt();
-        wire.net = obj["net"].toInt();
-        wire.name = obj["name"].toString();
-        wire.nameSide = obj["nameSide"].toInt();
+        Wire wire(s.toObject());
         wires.push_back(wire);
     }
 
+    // Junctions and nets are not edits
+    journal.begin("Open");
     for (auto s : schematicJunctions) {
         int x = s.toObject()["x"].toInt();
         int y = s.toObject()["y"].toInt();
         addJunction(x, y);
     }
 
-    updateNets();
+    if (!hasNets)
+        updateNets();
+    journal.clear();
 }
 
 template<typename Type>
@@ -181,14 +229,15 @@ QJsonObject Schematic::netlist()
 {
     QJsonArray netlistElements;
 
-    for (auto a : arrays)
-        netlist(netlistElements, a.second, a.second.name);
+    // Center order does not depend on edit history
+    for (int id : arrays.centerOrder())
+        netlist(netlistElements, arrays[id], arrays[id].name);
 
-    for (auto d : devices)
-        netlist(netlistElements, d.second, d.second.name);
+    for (int id : devices.centerOrder())
+        netlist(netlistElements, devices[id], devices[id].name);
 
-    for (auto e : elements)
-        netlist(netlistElements, e.second, e.second.value);
+    for (int id : elements.centerOrder())
+        netlist(netlistElements, elements[id], elements[id].value);
 
     QJsonObject object
     {
@@ -199,20 +248,15 @@ QJsonObject Schematic::netlist()
     return object;
 }
 
+// Net of pin is found by pin point
 template<typename Type>
-void Schematic::netlist(QJsonArray &netlistElements, Type t, QString str)
+void Schematic::netlist(QJsonArray &netlistElements, const Type &t, const QString &name)
 {
     QJsonArray elementPads;
 
     for (uint i = 0; i < t.pins.size(); i++) {
-        int x = t.pins[i].x;
-        int y = t.pins[i].y;
-        int netNumber = -1;
-        for (auto p : pins)
-            if (x == p.x && y == p.y) {
-                netNumber = p.net;
-                break;
-            }
+        auto p = pinNets.find(Point::key(t.pins[i].x, t.pins[i].y));
+        int netNumber = p != pinNets.end() ? p->second : -1;
 
         int pad = padNumber(t, i + 1);
 
@@ -228,7 +272,7 @@ void Schematic::netlist(QJsonArray &netlistElements, Type t, QString str)
     QJsonObject object
     {
         {"reference", t.reference},
-        {"name", str},
+        {"name", name},
         {"package", t.packageName},
         {"pads", elementPads}
     };
@@ -281,34 +325,8 @@ int Schematic::padNumber(const Element &e, int pinNumber)
     return n;
 }
 
-void Schematic::readPackages(const QByteArray &byteArray)
-{
-    QJsonParseError error;
-    QString str;
-
-    QJsonDocument document(QJsonDocument::fromJson(byteArray, &error));
-    if (document.isNull())
-        throw ExceptionData("Packages file read error: " + error.errorString() +
-                            ", offset: " + str.setNum(error.offset));
-
-    QJsonObject object = document.object();
-
-    if (object["object"].toString() != "packages")
-        throw ExceptionData("File is not a packages file");
-
-    QJsonArray packageArray(object["packages"].toArray());
-    for (auto p : packageArray) {
-        Package package(p);
-        packages.push_back(package);
-    }
-}
-
-void Schematic::readSymbols(const QByteArray &byteArray)
+void Schematic::readSymbols(const QJsonDocument &document)
 {
-    QJsonDocument document(QJsonDocument::fromJson(byteArray));
-    if (document.isNull())
-        throw ExceptionData("Symbol file read error");
-
     QJsonObject object = document.object();
 
     if (object["object"].toString() != "symbols")
@@ -336,77 +354,115 @@ void Schematic::readSymbols(const QByteArray &byteArray)
     }
 }
 
-QJsonObject Schematic::toJson()
+// Section of file, object: journal object kind
+// Symbols are written in center order, file does not depend on edit history
+QJsonValue Schematic::sectionJson(int object) const
 {
-    QJsonArray schematicArrays;
-    for (auto a : arrays)
-        schematicArrays.append(a.second.toJson());
-
-    QJsonArray schematicCircuitSymbols;
-    for (auto c : circuitSymbols)
-        schematicCircuitSymbols.append(c.second.toJson());
-
-    QJsonArray schematicDevices;
-    for (auto d : devices)
-        schematicDevices.append(d.second.toJson());
+    QJsonArray array;
+
+    switch (object) {
+    case ARRAY_OBJECT:
+        for (int id : arrays.centerOrder())
+            array.append(arrays[id].toJson());
+        break;
+    case CIRCUIT_SYMBOL_OBJECT:
+        for (int id : circuitSymbols.centerOrder())
+            array.append(circuitSymbols[id].toJson());
+        break;
+    case DEVICE_OBJECT:
+        for (int id : devices.centerOrder())
+            array.append(devices[id].toJson());
+        break;
+    case ELEMENT_OBJECT:
+        for (int id : elements.centerOrder())
+            array.append(elements[id].toJson());
+        break;
+    case JUNCTION_OBJECT:
+        {
+            // Hash order is not kept in file
+            std::vector<qint64> points(junctions.begin(), junctions.end());
+            std::sort(points.begin(), points.end());
+            for (auto j : points) {
+                QJsonObject junction
+                {
+                    {"x", Point::keyX(j)},
+                    {"y", Point::keyY(j)}
+                };
+                array.append(junction);
+            }
+        }
+        break;
+    case WIRE_OBJECT:
+        for (auto &w : wires)
+            array.append(w.toJson());
+        break;
+    }
 
-    QJsonArray schematicElements;
-    for (auto e : elements)
-        schematicElements.append(e.second.toJson());
+    return array;
+}
 
-    QJsonArray schematicWires;
-    for (auto w : wires) {
-        QJsonObject schematicWire
-        {
-            {"x1", w.x1},
-            {"y1", w.y1},
-            {"x2", w.x2},
-            {"y2", w.y2},
-            {"net", w.net},
-            {"name", w.name},
-            {"nameSide", w.nameSide}
-        };
-        schematicWires.append(schematicWire);
+// Sheet without ports and instances is written as before hierarchy
+void Schematic::sheetJson(QJsonObject &object) const
+{
+    if (!ports.empty()) {
+        QJsonArray sheetPorts;
+        for (const auto &p : ports)
+            sheetPorts.append(p);
+        object["ports"] = sheetPorts;
     }
 
-    QJsonArray schematicJunctions;
-    for (auto j : junctions) {
-        QJsonObject schematicJunction
-        {
-            {"x", (j >> 16) & 0xffff},
-            {"y", j & 0xffff}
-        };
-        schematicJunctions.append(schematicJunction);
+    if (!sheets.empty()) {
+        QJsonArray sheetInstances;
+        for (const auto &s : sheets)
+            sheetInstances.append(s.toJson());
+        object["sheets"] = sheetInstances;
     }
+}
 
+QJsonObject Schematic::toJson() const
+{
     QJsonObject object
     {
         {"object", "schematic"},
-        {"arrays", schematicArrays},
-        {"circuitSymbols", schematicCircuitSymbols},
-        {"devices", schematicDevices},
-        {"elements", schematicElements},
-        {"wires", schematicWires},
-        {"junctions", schematicJunctions}
+        {"arrays", sectionJson(ARRAY_OBJECT)},
+        {"circuitSymbols", sectionJson(CIRCUIT_SYMBOL_OBJECT)},
+        {"devices", sectionJson(DEVICE_OBJECT)},
+        {"elements", sectionJson(ELEMENT_OBJECT)},
+        {"wires", sectionJson(WIRE_OBJECT)},
+        {"junctions", sectionJson(JUNCTION_OBJECT)}
     };
+    sheetJson(object);
 
     return object;
 }
 
+QByteArray Schematic::toJsonData()
+{
+    QJsonObject header
+    {
+        {"object", "schematic"}
+    };
+    sheetJson(header);
+
+    return jsonCache.document(header, [this](int object) {
+        return sectionJson(object);
+    });
+}
+
 template<typename Type>
 void Schematic::writeComponentList(const Type &t, QString &text)
 {
     int maxSize = 0;
     int maxSize2 = 0;
 
-    for (auto c : t) {
+    for (const auto &c : t) {
         if (c.first.size() > maxSize)
             maxSize = c.first.size();
         if (c.second[0].size() > maxSize2)
             maxSize2 = c.second[0].size();
     }
 
-    for (auto c : t)
+    for (const auto &c : t)
         text += c.first.leftJustified(maxSize + 2, ' ') +
                 c.second[0].leftJustified(maxSize2 + 2, ' ') + c.second[1] + "\n";
 }
@@ -2,20 +2,21 @@
 // Copyright (C) 2018 Alexander Karpeko
 
 #include "exceptiondata.h"
+#include "glyphcache.h"
 #include "text.h"
 #include "unit.h"
 #include <QJsonArray>
 
 std::map<int, UnitSymbol> Unit::symbols;
 
-QJsonObject UnitSymbol::toJson()
+QJsonObject UnitSymbol::toJson() const
 {
     QJsonArray unitEllipses;
-    for (auto e : ellipses)
+    for (const auto &e : ellipses)
         unitEllipses.append(e.toJson());
 
     QJsonArray unitLines;
-    for (auto l : lines)
+    for (const auto &l : lines)
         unitLines.append(l.toJson());
 
     QJsonObject object
@@ -76,16 +77,19 @@ void Unit::addSymbol(const QJsonValue &value, int deviceID)
     Unit::symbols[symbol.nameID] = symbol;
 }
 
-void Unit::draw(QPainter &painter, int fontSize)
+void Unit::draw(QPainter &painter, int fontSize) const
 {
     int h, w;
     int x, y;
 
-    for (auto l : lines)
-        painter.drawLine(l.x1, l.y1, l.x2, l.y2);
+    GlyphCache::global().draw(painter, GlyphCache::UNIT_GLYPH, symbolNameID, 0, 0,
+                              refX, refY, [this](QPainter &painter) {
+        for (const auto &l : lines)
+            painter.drawLine(l.x1, l.y1, l.x2, l.y2);
 
-    for (auto e : ellipses)
-        painter.drawEllipse(e.x, e.y, e.w, e.h);
+        for (const auto &e : ellipses)
+            painter.drawEllipse(e.x, e.y, e.w, e.h);
+    });
 
     w = fontSize * reference.size();
     h = fontSize;
@@ -94,13 +98,19 @@ void Unit::draw(QPainter &painter, int fontSize)
     painter.drawText(x, y, w, h, Qt::AlignCenter, reference);
 }
 
-bool Unit::exist(int x, int y)
+Border Unit::bounds() const
 {
     int dx = (symbols[symbolNameID].border.rightX - symbols[symbolNameID].border.leftX) / 2;
     int dy = (symbols[symbolNameID].border.bottomY - symbols[symbolNameID].border.topY) / 2;
 
-    if (x >= (centerX - dx) && x <= (centerX + dx) &&
-        y >= (centerY - dy) && y <= (centerY + dy))
+    return Border(centerX - dx, centerY - dy, centerX + dx, centerY + dy);
+}
+
+bool Unit::exist(int x, int y) const
+{
+    Border b = bounds();
+
+    if (x >= b.leftX && x <= b.rightX && y >= b.topY && y <= b.bottomY)
         return true;
 
     return false;
@@ -119,10 +129,10 @@ void Unit::init()
 
     centerX = (border.leftX + border.rightX) / 2;
     centerY = (border.topY + border.bottomY) / 2;
-    center = (centerX << 16) + centerY;
+    center = Point::key(centerX, centerY);
 
     Ellipse ellipse;
-    for (auto se : symbol.ellipses) {
+    for (const auto &se : symbol.ellipses) {
         ellipse.x = refX + se.x;
         ellipse.y = refY + se.y;
         ellipse.w = se.w;
@@ -131,7 +141,7 @@ void Unit::init()
     }
 
     Line line;
-    for (auto sl : symbol.lines) {
+    for (const auto &sl : symbol.lines) {
         line.x1 = refX + sl.x1;
         line.y1 = refY + sl.y1;
         line.x2 = refX + sl.x2;
@@ -140,7 +150,7 @@ void Unit::init()
     }
 }
 
-bool Unit::inside(int leftX, int topY, int rightX, int bottomY)
+bool Unit::inside(int leftX, int topY, int rightX, int bottomY) const
 {
     if (centerX >= leftX && centerX <= rightX &&
         centerY >= topY && centerY <= bottomY)
@@ -149,7 +159,7 @@ bool Unit::inside(int leftX, int topY, int rightX, int bottomY)
     return false;
 }
 
-QJsonObject Unit::toJson()
+QJsonObject Unit::toJson() const
 {
     QJsonObject object
     {
@@ -14,7 +14,7 @@
 class UnitSymbol
 {
 public:
-    QJsonObject toJson();
+    QJsonObject toJson() const;
 
     Border border;
     int nameID;
@@ -32,15 +32,16 @@ public:
     Unit(int deviceID, int number, int refX, int refY);
     Unit(int deviceID, const QJsonObject &object);
     static void addSymbol(const QJsonValue &value, int deviceID);
-    void draw(QPainter &painter, int fontSize);
-    bool exist(int x, int y);
+    Border bounds() const;
+    void draw(QPainter &painter, int fontSize) const;
+    bool exist(int x, int y) const;
     void init();
-    bool inside(int leftX, int topY, int rightX, int bottomY);
-    QJsonObject toJson();
+    bool inside(int leftX, int topY, int rightX, int bottomY) const;
+    QJsonObject toJson() const;
 
     static std::map<int, UnitSymbol> symbols;  // unit nameID, unitSymbol
     Border border;
-    int center;
+    qint64 center;
     int centerX;
     int centerY;
     int deviceID;           // device nameID